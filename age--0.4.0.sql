@@ -98,6 +98,21 @@ RETURNS void
 LANGUAGE c
 AS 'MODULE_PATHNAME';
 
+CREATE FUNCTION ag_catalog.load_labels_from_file(graph_name name,
+                                      label_name name,
+                                      file_path text,
+                                      id_field_exists bool = true)
+RETURNS void
+LANGUAGE c
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.load_edges_from_file(graph_name name,
+                                     label_name name,
+                                     file_path text)
+RETURNS void
+LANGUAGE c
+AS 'MODULE_PATHNAME';
+
 --
 -- graphid type
 --
@@ -137,7 +152,7 @@ CREATE TYPE graphid (
 CREATE FUNCTION ag_catalog.graphid_eq(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -149,13 +164,15 @@ CREATE OPERATOR = (
   COMMUTATOR = =,
   NEGATOR = <>,
   RESTRICT = eqsel,
-  JOIN = eqjoinsel
+  JOIN = eqjoinsel,
+  HASHES,
+  MERGES
 );
 
 CREATE FUNCTION ag_catalog.graphid_ne(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -173,7 +190,7 @@ CREATE OPERATOR <> (
 CREATE FUNCTION ag_catalog.graphid_lt(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -191,7 +208,7 @@ CREATE OPERATOR < (
 CREATE FUNCTION ag_catalog.graphid_gt(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -209,7 +226,7 @@ CREATE OPERATOR > (
 CREATE FUNCTION ag_catalog.graphid_le(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -227,7 +244,7 @@ CREATE OPERATOR <= (
 CREATE FUNCTION ag_catalog.graphid_ge(graphid, graphid)
 RETURNS boolean
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -250,7 +267,7 @@ CREATE OPERATOR >= (
 CREATE FUNCTION ag_catalog.graphid_btree_cmp(graphid, graphid)
 RETURNS int
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -291,6 +308,37 @@ CREATE OPERATOR CLASS graphid_ops DEFAULT FOR TYPE graphid USING btree AS
   FUNCTION 1 ag_catalog.graphid_btree_cmp (graphid, graphid),
   FUNCTION 2 ag_catalog.graphid_btree_sort (internal);
 
+--
+-- graphid - hash support functions
+--
+
+CREATE FUNCTION ag_catalog.graphid_hash(graphid)
+RETURNS int
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.graphid_hash_extended(graphid, bigint)
+RETURNS bigint
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+-- Hash strategies
+--   1: equal
+--
+-- Hash support functions
+--   1: compute the 32-bit hash value for a key
+--   2: compute the 64-bit hash value for a key given a 64-bit salt (optional)
+CREATE OPERATOR CLASS graphid_ops DEFAULT FOR TYPE graphid USING hash AS
+  OPERATOR 1 =,
+  FUNCTION 1 ag_catalog.graphid_hash (graphid),
+  FUNCTION 2 ag_catalog.graphid_hash_extended (graphid, bigint);
+
 --
 -- graphid functions
 --
@@ -1331,7 +1379,8 @@ CREATE OPERATOR = (
   COMMUTATOR = =,
   NEGATOR = <>,
   RESTRICT = eqsel,
-  JOIN = eqjoinsel
+  JOIN = eqjoinsel,
+  HASHES
 );
 
 CREATE FUNCTION ag_catalog.agtype_any_eq(agtype, smallint)
@@ -2734,8 +2783,8 @@ CREATE OPERATOR CLASS agtype_ops_btree
   OPERATOR 1 <,
   OPERATOR 2 <=,
   OPERATOR 3 =,
-  OPERATOR 4 >,
-  OPERATOR 5 >=,
+  OPERATOR 4 >=,
+  OPERATOR 5 >,
   FUNCTION 1 ag_catalog.agtype_btree_cmp(agtype, agtype);
 
 CREATE FUNCTION ag_catalog.agtype_hash_cmp(agtype)
@@ -2745,12 +2794,178 @@ STABLE
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+CREATE FUNCTION ag_catalog.agtype_hash_extended(agtype, bigint)
+RETURNS bigint
+LANGUAGE c
+STABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
 CREATE OPERATOR CLASS agtype_ops_hash
   DEFAULT
   FOR TYPE agtype
   USING hash AS
   OPERATOR 1 =,
-  FUNCTION 1 ag_catalog.agtype_hash_cmp(agtype);
+  FUNCTION 1 ag_catalog.agtype_hash_cmp(agtype),
+  FUNCTION 2 ag_catalog.agtype_hash_extended(agtype, bigint);
+
+--
+-- containment operators and GIN operator classes
+--
+CREATE FUNCTION ag_catalog.agtype_contains(agtype, agtype)
+RETURNS boolean
+LANGUAGE c
+STABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE OPERATOR @> (
+  LEFTARG = agtype,
+  RIGHTARG = agtype,
+  FUNCTION = ag_catalog.agtype_contains,
+  COMMUTATOR = '<@',
+  RESTRICT = contsel,
+  JOIN = contjoinsel
+);
+
+CREATE FUNCTION ag_catalog.agtype_contained_by(agtype, agtype)
+RETURNS boolean
+LANGUAGE c
+STABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE OPERATOR <@ (
+  LEFTARG = agtype,
+  RIGHTARG = agtype,
+  FUNCTION = ag_catalog.agtype_contained_by,
+  COMMUTATOR = '@>',
+  RESTRICT = contsel,
+  JOIN = contjoinsel
+);
+
+CREATE FUNCTION ag_catalog.gin_compare_agtype(text, text)
+RETURNS int
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_extract_agtype(agtype, internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_extract_agtype_query(agtype, internal, int2,
+                                                    internal, internal,
+                                                    internal, internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_consistent_agtype(internal, int2, agtype, int4,
+                                                 internal, internal, internal,
+                                                 internal)
+RETURNS bool
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_triconsistent_agtype(internal, int2, agtype,
+                                                    int4, internal, internal,
+                                                    internal)
+RETURNS "char"
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE OPERATOR CLASS agtype_ops_gin
+  DEFAULT
+  FOR TYPE agtype
+  USING gin AS
+  OPERATOR 7 @>,
+  FUNCTION 1 ag_catalog.gin_compare_agtype(text, text),
+  FUNCTION 2 ag_catalog.gin_extract_agtype(agtype, internal),
+  FUNCTION 3 ag_catalog.gin_extract_agtype_query(agtype, internal, int2,
+                                                 internal, internal, internal,
+                                                 internal),
+  FUNCTION 4 ag_catalog.gin_consistent_agtype(internal, int2, agtype, int4,
+                                              internal, internal, internal,
+                                              internal),
+  FUNCTION 6 ag_catalog.gin_triconsistent_agtype(internal, int2, agtype, int4,
+                                                 internal, internal, internal),
+  STORAGE text;
+
+CREATE FUNCTION ag_catalog.gin_extract_agtype_path(agtype, internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_extract_agtype_query_path(agtype, internal,
+                                                         int2, internal,
+                                                         internal, internal,
+                                                         internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_consistent_agtype_path(internal, int2, agtype,
+                                                      int4, internal, internal,
+                                                      internal, internal)
+RETURNS bool
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.gin_triconsistent_agtype_path(internal, int2,
+                                                         agtype, int4,
+                                                         internal, internal,
+                                                         internal)
+RETURNS "char"
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+CREATE OPERATOR CLASS agtype_path_ops_gin
+  FOR TYPE agtype
+  USING gin AS
+  OPERATOR 7 @>,
+  FUNCTION 1 btint4cmp(int4, int4),
+  FUNCTION 2 ag_catalog.gin_extract_agtype_path(agtype, internal),
+  FUNCTION 3 ag_catalog.gin_extract_agtype_query_path(agtype, internal, int2,
+                                                      internal, internal,
+                                                      internal, internal),
+  FUNCTION 4 ag_catalog.gin_consistent_agtype_path(internal, int2, agtype,
+                                                   int4, internal, internal,
+                                                   internal, internal),
+  FUNCTION 6 ag_catalog.gin_triconsistent_agtype_path(internal, int2, agtype,
+                                                      int4, internal,
+                                                      internal, internal),
+  STORAGE int4;
 
 --
 -- graph id conversion function
@@ -2758,7 +2973,7 @@ CREATE OPERATOR CLASS agtype_ops_hash
 CREATE FUNCTION ag_catalog.graphid_to_agtype(graphid)
 RETURNS agtype
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -2769,7 +2984,7 @@ WITH FUNCTION ag_catalog.graphid_to_agtype(graphid);
 CREATE FUNCTION ag_catalog.agtype_to_graphid(agtype)
 RETURNS graphid
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -2778,6 +2993,14 @@ CREATE CAST (agtype AS graphid)
 WITH FUNCTION ag_catalog.agtype_to_graphid(agtype)
 AS IMPLICIT;
 
+CREATE FUNCTION ag_catalog._agtype_to_graphid_or_null(agtype)
+RETURNS graphid
+LANGUAGE c
+IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
 
 --
 -- agtype - path
@@ -2992,10 +3215,11 @@ WITH FUNCTION ag_catalog.agtype_to_int2(variadic "any");
 --
 
 -- for series of `map.key` and `container[expr]`
+-- IMMUTABLE so that property indexes can be built on it, see CREATE INDEX
 CREATE FUNCTION ag_catalog.agtype_access_operator(VARIADIC agtype[])
 RETURNS agtype
 LANGUAGE c
-STABLE
+IMMUTABLE
 RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
@@ -3048,19 +3272,50 @@ AS 'MODULE_PATHNAME';
 
 -- This function is defined as a VOLATILE function to prevent the optimizer
 -- from pulling up Query's for CREATE clauses.
+--
+-- The functions of the updating clauses write to the label tables, which is
+-- not allowed in parallel mode. They are PARALLEL UNSAFE so that a query with
+-- one of these clauses is planned without parallelism.
 CREATE FUNCTION ag_catalog._cypher_create_clause(internal)
 RETURNS void
 LANGUAGE c
+PARALLEL UNSAFE
 AS 'MODULE_PATHNAME';
 
 CREATE FUNCTION ag_catalog._cypher_set_clause(internal)
 RETURNS void
 LANGUAGE c
+PARALLEL UNSAFE
 AS 'MODULE_PATHNAME';
 
 CREATE FUNCTION ag_catalog._cypher_delete_clause(internal)
 RETURNS void
 LANGUAGE c
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog._cypher_merge_clause(internal)
+RETURNS void
+LANGUAGE c
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+-- The variable length relationships of MATCH are functions in the FROM
+-- clause. The planner replaces them with the Cypher VLE node, which finds the
+-- paths from the vertex given as the first argument. shortestPath() and
+-- allShortestPaths() give the vertex the paths end at as well.
+CREATE FUNCTION ag_catalog._cypher_vle(vertex_id graphid,
+                                       end_vertex_id graphid, graph_oid oid,
+                                       label_name text, direction int,
+                                       min_hops int, max_hops int,
+                                       properties agtype, path_kind int,
+                                       OUT start_id graphid,
+                                       OUT end_id graphid,
+                                       OUT edges agtype)
+RETURNS SETOF record
+LANGUAGE c
+STABLE
+PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
 --
@@ -3221,6 +3476,15 @@ RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+-- execution function of the CREATE INDEX clause
+CREATE FUNCTION ag_catalog._create_property_index(graph_name name,
+                                                  label_name name,
+                                                  property_name text,
+                                                  index_name name = NULL)
+RETURNS SETOF agtype
+LANGUAGE c
+AS 'MODULE_PATHNAME';
+
 CREATE FUNCTION ag_catalog._property_constraint_check(agtype, agtype)
 RETURNS boolean
 LANGUAGE c
@@ -3655,12 +3919,41 @@ IMMUTABLE
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+-- collect combine function
+CREATE FUNCTION ag_catalog.age_collect_aggcombinefn(internal, internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+-- collect serialize function
+CREATE FUNCTION ag_catalog.age_collect_aggserialfn(internal)
+RETURNS bytea
+LANGUAGE c
+IMMUTABLE
+STRICT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+-- collect deserialize function
+CREATE FUNCTION ag_catalog.age_collect_aggdeserialfn(bytea, internal)
+RETURNS internal
+LANGUAGE c
+IMMUTABLE
+STRICT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
 -- aggregate definition for age_collect(variadic "any")
 CREATE AGGREGATE ag_catalog.age_collect(variadic "any")
 (
     stype = internal,
     sfunc = ag_catalog.age_collect_aggtransfn,
     finalfunc = ag_catalog.age_collect_aggfinalfn,
+    combinefunc = ag_catalog.age_collect_aggcombinefn,
+    serialfunc = ag_catalog.age_collect_aggserialfn,
+    deserialfunc = ag_catalog.age_collect_aggdeserialfn,
     parallel = safe
 );
 
@@ -3709,6 +4002,17 @@ STABLE
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+--
+-- function for the UNWIND clause
+--
+CREATE FUNCTION ag_catalog.age_unnest(agtype)
+RETURNS SETOF agtype
+LANGUAGE c
+IMMUTABLE
+STRICT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
 --
 -- End
 --
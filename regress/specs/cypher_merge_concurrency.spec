@@ -0,0 +1,52 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Two sessions MERGE the same pattern at the same time. The second one waits
+# for the transaction of the first one, then matches the vertex it created,
+# or creates the vertex itself if the first one rolled back.
+
+setup
+{
+  LOAD 'age';
+  SET search_path TO ag_catalog;
+  SET client_min_messages TO warning;
+  SELECT create_graph('merge_concurrency');
+  SELECT * FROM cypher('merge_concurrency', $$CREATE (:person {name: 'Bob'})$$) AS (a agtype);
+  RESET client_min_messages;
+}
+
+teardown
+{
+  SET client_min_messages TO warning;
+  SELECT drop_graph('merge_concurrency', true);
+  RESET client_min_messages;
+}
+
+session "s1"
+setup { LOAD 'age'; SET search_path TO ag_catalog; }
+step "s1b" { BEGIN; }
+step "s1m" { SELECT * FROM cypher('merge_concurrency', $$MERGE (n:person {name: 'Alice'}) RETURN n.name$$) AS (name agtype); }
+step "s1c" { COMMIT; }
+step "s1r" { ROLLBACK; }
+
+session "s2"
+setup { LOAD 'age'; SET search_path TO ag_catalog; }
+step "s2m" { SELECT * FROM cypher('merge_concurrency', $$MERGE (n:person {name: 'Alice'}) RETURN n.name$$) AS (name agtype); }
+step "s2n" { SELECT * FROM cypher('merge_concurrency', $$MATCH (n:person) RETURN n.name ORDER BY n.name$$) AS (name agtype); }
+
+permutation "s1b" "s1m" "s2m" "s1c" "s2n"
+permutation "s1b" "s1m" "s2m" "s1r" "s2n"
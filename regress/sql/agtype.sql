@@ -785,6 +785,38 @@ SELECT agtype_hash_cmp('
 	 {"id":2, "start_id":1, "end_id": 3, "label":"elabel", "properties":{}}::edge,
 	 {"id":5, "label":"vlabel", "properties":{}}::vertex]::path'::agtype);
 
+SELECT agtype_hash_cmp('1'::agtype) = agtype_hash_cmp('1.0'::agtype);
+SELECT agtype_hash_extended('1'::agtype, 0), agtype_hash_extended('1.0'::agtype, 0);
+SELECT agtype_hash_extended('1'::agtype, 1);
+SELECT agtype_hash_extended('[1, "abcde", 2.0]'::agtype, 42);
+-- integers are hashed exactly, so large graphids do not collide
+SELECT count(DISTINCT agtype_hash_cmp(((l::bigint << 48) + i)::agtype))
+FROM generate_series(4, 7) l, generate_series(1, 1000) i;
+-- integral floats and numerics hash like the equal integers
+SELECT agtype_hash_cmp('1125899906842625'::agtype) =
+       agtype_hash_cmp('1125899906842625::numeric'::agtype),
+       agtype_hash_cmp('3'::agtype) = agtype_hash_cmp('3.0'::agtype);
+
+-- equal integers, floats and numerics are matched by a hash join
+CREATE TABLE agtype_hash_l (id int, a agtype);
+INSERT INTO agtype_hash_l VALUES (1, '1'), (2, '1.0'), (3, '1::numeric'),
+                                 (4, '0.30000000000000004'), (5, '2');
+CREATE TABLE agtype_hash_r (id int, a agtype);
+INSERT INTO agtype_hash_r VALUES (1, '1'), (2, '0.3::numeric');
+ANALYZE agtype_hash_l;
+ANALYZE agtype_hash_r;
+SET enable_mergejoin = OFF;
+SET enable_nestloop = OFF;
+EXPLAIN (COSTS OFF)
+SELECT l.id, r.id FROM agtype_hash_l l JOIN agtype_hash_r r ON l.a = r.a
+ORDER BY l.id;
+SELECT l.id, r.id FROM agtype_hash_l l JOIN agtype_hash_r r ON l.a = r.a
+ORDER BY l.id;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+DROP TABLE agtype_hash_l;
+DROP TABLE agtype_hash_r;
+
 --Agtype BTree Comparison Function
 SELECT agtype_btree_cmp('1'::agtype, '1'::agtype);
 SELECT agtype_btree_cmp('1'::agtype, '1.0'::agtype);
@@ -838,6 +870,60 @@ SELECT agtype_btree_cmp(
 	'[{"id":1, "label":"test", "properties":{"id":100}}::vertex,
 	  {"id":2, "start_id":1, "end_id": 3, "label":"elabel", "properties":{}}::edge,
 	  {"id":4, "label":"vlabel", "properties":{}}::vertex]::path'::agtype);
+--
+-- Agtype containment operators and GIN indexes
+--
+SELECT '{"a": 1, "b": {"c": "d"}}'::agtype @> '{"b": {"c": "d"}}'::agtype;
+SELECT '{"a": 1, "b": {"c": "d"}}'::agtype @> '{"a": 2}'::agtype;
+SELECT '{"a": 1}'::agtype <@ '{"a": 1, "b": 2}'::agtype;
+SELECT '[1, 2, 3]'::agtype @> '[3, 1]'::agtype;
+SELECT '[1, 2, 3]'::agtype @> '{"a": 1}'::agtype;
+
+CREATE TABLE agtype_gin_table (props agtype);
+INSERT INTO agtype_gin_table VALUES ('{"name": "a", "age": 1}'),
+                                    ('{"name": "b", "age": 2}'),
+                                    ('{"name": "c", "tags": ["x", "y"]}');
+-- default GIN operator class
+CREATE INDEX agtype_gin_idx ON agtype_gin_table USING gin (props);
+SET enable_seqscan = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM agtype_gin_table WHERE props @> '{"name": "b"}';
+SELECT * FROM agtype_gin_table WHERE props @> '{"name": "b"}';
+SELECT * FROM agtype_gin_table WHERE props @> '{"tags": ["y"]}';
+SELECT * FROM agtype_gin_table WHERE props @> '{}';
+SET enable_seqscan = ON;
+DROP INDEX agtype_gin_idx;
+
+-- GIN operator class on paths
+CREATE INDEX agtype_gin_idx ON agtype_gin_table
+USING gin (props agtype_path_ops_gin);
+SET enable_seqscan = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM agtype_gin_table WHERE props @> '{"name": "b"}';
+SELECT * FROM agtype_gin_table WHERE props @> '{"name": "b"}';
+SELECT * FROM agtype_gin_table WHERE props @> '{"tags": ["y"]}';
+SELECT * FROM agtype_gin_table WHERE props @> '{}';
+SET enable_seqscan = ON;
+DROP TABLE agtype_gin_table;
+
+--
+-- Agtype btree operator class
+--
+CREATE TABLE agtype_btree_table (a agtype, b int);
+INSERT INTO agtype_btree_table VALUES ('1', 1), ('2', 2), ('3', 3);
+CREATE INDEX agtype_btree_idx ON agtype_btree_table (a);
+SET enable_seqscan = OFF;
+SET enable_bitmapscan = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM agtype_btree_table WHERE a > '2';
+SELECT * FROM agtype_btree_table WHERE a > '2';
+SELECT * FROM agtype_btree_table WHERE a >= '2';
+SELECT * FROM agtype_btree_table WHERE a < '2';
+SELECT * FROM agtype_btree_table WHERE a <= '2';
+SET enable_seqscan = ON;
+SET enable_bitmapscan = ON;
+DROP TABLE agtype_btree_table;
+
 --
 -- Cleanup
 --
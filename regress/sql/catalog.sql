@@ -129,3 +129,39 @@ SELECT * FROM cypher('g', $$CREATE (:v2)$$) as r(a agtype);
 SELECT name, id, kind, relation FROM ag_label;
 
 SELECT drop_graph('g', true);
+
+--
+-- edge label index test
+--
+
+SELECT create_graph('g');
+
+-- edge labels have a primary key on id and are indexed on start_id and end_id
+SELECT * FROM cypher('g', $$CREATE (:v)-[:e]->(:v)$$) AS r(a agtype);
+SELECT indexname FROM pg_indexes
+WHERE schemaname = 'g' AND tablename = 'e'
+ORDER BY indexname;
+
+-- the start_id and end_id indexes are not created when
+-- age.create_edge_indexes is off
+SET age.create_edge_indexes = off;
+SELECT * FROM cypher('g', $$CREATE (:v)-[:e2]->(:v)$$) AS r(a agtype);
+SELECT indexname FROM pg_indexes
+WHERE schemaname = 'g' AND tablename = 'e2'
+ORDER BY indexname;
+RESET age.create_edge_indexes;
+
+-- label sequences hand out entry ids in blocks of age.entry_id_cache_size
+SELECT sequencename, cache_size FROM pg_sequences
+WHERE schemaname = 'g' AND sequencename IN ('v_id_seq', 'e_id_seq')
+ORDER BY sequencename;
+
+-- the id defaults of label tables hold the label id as a constant
+SELECT c.relname, pg_get_expr(d.adbin, d.adrelid) AS id_default
+FROM pg_attrdef d
+JOIN pg_class c ON c.oid = d.adrelid
+JOIN pg_namespace n ON n.oid = c.relnamespace
+WHERE n.nspname = 'g' AND c.relname IN ('v', 'e') AND d.adnum = 1
+ORDER BY c.relname;
+
+SELECT drop_graph('g', true);
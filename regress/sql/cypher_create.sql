@@ -248,6 +248,53 @@ cypher('cypher_create', $$
 	RETURN b
 $$) as t(b agtype);
 
+-- terminal CREATE clauses insert in batches
+SELECT * FROM cypher('cypher_create', $$
+	CREATE (:batch_src {i: 0}), (:batch_src {i: 1}), (:batch_src {i: 2}),
+	       (:batch_src {i: 3}), (:batch_src {i: 4}), (:batch_src {i: 5}),
+	       (:batch_src {i: 6}), (:batch_src {i: 7}), (:batch_src {i: 8}),
+	       (:batch_src {i: 9}), (:batch_src {i: 10})
+$$) AS (a agtype);
+-- 1331 rows of two entities each, more than one batch
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:batch_src), (b:batch_src), (c:batch_src)
+	CREATE (a)-[:batch_e]->(:batch {i: a.i * 121 + b.i * 11 + c.i, a: a.i})
+$$) AS (a agtype);
+SELECT count(*), count(DISTINCT i) FROM cypher('cypher_create', $$
+	MATCH (v:batch) RETURN v.i
+$$) AS (i agtype);
+SELECT count(*), count(DISTINCT e) FROM cypher('cypher_create', $$
+	MATCH (:batch_src)-[e:batch_e]->(:batch) RETURN e
+$$) AS (e agtype);
+-- every edge starts at the vertex of its row
+SELECT count(*) FROM cypher('cypher_create', $$
+	MATCH (a:batch_src)-[:batch_e]->(v:batch) WHERE a.i <> v.a RETURN v
+$$) AS (v agtype);
+
+-- the bound vertices of CREATE are checked through their primary key
+SELECT * FROM cypher('cypher_create', $$
+	CREATE (:bound {name: 'a'}), (:bound {name: 'b'})
+$$) AS (a agtype);
+-- a bound vertex
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:bound {name: 'a'}) CREATE (a)-[:bound_e]->(:bound {name: 'c'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:bound)-[:bound_e]->(b:bound) RETURN a.name, b.name
+$$) AS (a agtype, b agtype);
+-- a bound vertex deleted earlier in the query through another variable
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:bound {name: 'b'}), (b:bound {name: 'b'})
+	DELETE b CREATE (a)-[:bound_e]->(:bound)
+$$) AS (a agtype);
+-- a bound vertex deleted earlier in the query through the same variable
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:bound {name: 'b'}) DELETE a CREATE (a)-[:bound_e]->(:bound)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_create', $$
+	MATCH (a:bound) RETURN a.name ORDER BY a.name
+$$) AS (name agtype);
+
 -- column definition list for CREATE clause must contain a single agtype
 -- attribute
 SELECT * FROM cypher('cypher_create', $$CREATE ()$$) AS (a int);
@@ -196,6 +196,27 @@ SELECT delete_test();
 
 SELECT * FROM cypher('cypher_delete', $$CREATE (v:v)$$) AS (a agtype);
 SELECT delete_test();
+--Test 23 Terminal DETACH DELETE of many vertices
+SELECT * FROM cypher('cypher_delete', $$CREATE (:v)-[:e]->(:v)-[:e]->(:v)$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$CREATE (:v)-[:e]->(:v)$$) AS (a agtype);
+
+--Should Fail
+SELECT * FROM cypher('cypher_delete', $$MATCH (n:v) DELETE n$$) AS (a agtype);
+
+SELECT * FROM cypher('cypher_delete', $$MATCH (n:v) DETACH DELETE n$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$MATCH ()-[e]->() RETURN e$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$MATCH (n) RETURN n$$) AS (a agtype);
+
+--Test 24 Terminal DETACH DELETE of a few vertices of a large edge label
+SELECT * FROM cypher('cypher_delete', $$CREATE (:hub {i: 0}), (:hub {i: 1}), (:hub {i: 2}), (:hub {i: 3}), (:hub {i: 4}), (:hub {i: 5}), (:hub {i: 6}), (:hub {i: 7}), (:hub {i: 8}), (:hub {i: 9}), (:hub {i: 10}), (:hub {i: 11}), (:hub {i: 12})$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$
+	MATCH (a:hub), (b:hub), (c:hub) CREATE (a)-[:link]->(b)
+$$) AS (a agtype);
+-- the edges of the vertex are found through the start_id and end_id indexes
+SELECT * FROM cypher('cypher_delete', $$MATCH (n:hub {i: 0}) DETACH DELETE n$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$MATCH ()-[e:link]->() RETURN count(e)$$) AS (a agtype);
+SELECT * FROM cypher('cypher_delete', $$MATCH (n:hub) RETURN count(n)$$) AS (a agtype);
+
 --
 -- Clean up
 --
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+SELECT create_graph('cypher_expand');
+
+SELECT * FROM cypher('cypher_expand', $$
+CREATE (:person {name: 'Alice'})-[:knows]->(:person {name: 'Bob'})-[:knows]->(:person {name: 'Carol'})-[:knows]->(:person {name: 'Dave'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person {name: 'Alice'}), (c:person {name: 'Carol'})
+CREATE (a)-[:knows]->(c)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (d:person {name: 'Dave'}), (a:person {name: 'Alice'})
+CREATE (d)-[:likes]->(a)
+$$) AS (a agtype);
+
+-- the joins of the planner are disabled so that Expand is used
+SET enable_hashjoin = OFF;
+SET enable_mergejoin = OFF;
+SET enable_nestloop = OFF;
+
+--
+-- One hop
+--
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[e:knows]->() RETURN e
+$$) AS (e agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[:knows]->(b) RETURN a.name, b.name ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype);
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_expand', $$
+MATCH ()-[e:knows]->(b:person) RETURN e
+$$) AS (e agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a)-[:knows]->(b:person {name: 'Carol'}) RETURN a.name ORDER BY a.name
+$$) AS (a agtype);
+-- every table of the edge label is looked up
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person {name: 'Dave'})-[]->(b) RETURN b.name
+$$) AS (b agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a)<-[]-(b:person {name: 'Carol'}) RETURN a.name
+$$) AS (a agtype);
+
+--
+-- Longer patterns
+--
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[:knows]->(b)-[:knows]->(c)
+RETURN a.name, b.name, c.name ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype, c agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[:knows]->(b)-[:knows]->(c)-[:knows]->(d)
+RETURN a.name, b.name, c.name, d.name
+$$) AS (a agtype, b agtype, c agtype, d agtype);
+-- both ends of the last edge are bound
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[:knows]->(b)-[:knows]->(c), (a)-[:knows]->(c)
+RETURN a.name, b.name, c.name
+$$) AS (a agtype, b agtype, c agtype);
+
+--
+-- Updating the edges of an Expand
+--
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person {name: 'Alice'})-[e:knows]->() SET e.since = 2020
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_expand', $$
+MATCH (a:person)-[e:knows]->(b) RETURN a.name, e.since, b.name ORDER BY a.name, b.name
+$$) AS (a agtype, since agtype, b agtype);
+
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+
+--
+-- Clean up
+--
+SELECT drop_graph('cypher_expand', true);
+
+--
+-- End
+--
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+SELECT create_graph('cypher_index');
+
+SELECT * FROM cypher('cypher_index', $$CREATE (:person {name: 'Alice', age: 30})$$) AS (a agtype);
+SELECT * FROM cypher('cypher_index', $$CREATE (:person {name: 'Bob', age: 25})$$) AS (a agtype);
+SELECT * FROM cypher('cypher_index', $$CREATE (:person {name: 'Carol', age: 35})$$) AS (a agtype);
+
+--
+-- CREATE INDEX
+--
+SELECT * FROM cypher('cypher_index', $$CREATE INDEX ON :person(name)$$) AS (a agtype);
+SELECT * FROM cypher('cypher_index', $$CREATE INDEX person_age ON :person(age)$$) AS (a agtype);
+SELECT indexname FROM pg_indexes
+WHERE schemaname = 'cypher_index' AND tablename = 'person'
+ORDER BY indexname;
+
+-- property accesses are matched to the indexes
+SET enable_seqscan = OFF;
+SET enable_bitmapscan = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE n.name = 'Bob' RETURN n
+$$) AS (n agtype);
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE n.name = 'Bob' RETURN n
+$$) AS (n agtype);
+-- the columns exposed for the property access are not passed on
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE n.name = 'Bob' RETURN *
+$$) AS (n agtype);
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE n.age > 26 RETURN n.name
+$$) AS (name agtype);
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE n.age > 26 RETURN n.name ORDER BY n.name
+$$) AS (name agtype);
+-- id() comparisons use the primary keys and exclude the other label tables
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n) WHERE id(n) = 844424930131970 RETURN n
+$$) AS (n agtype);
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n) WHERE id(n) = 844424930131970 RETURN n
+$$) AS (n agtype);
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n:person) WHERE 844424930131970 < id(n) RETURN n.name
+$$) AS (name agtype);
+PREPARE id_param(agtype) AS
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n) WHERE id(n) = $id RETURN n.name
+$$, $1) AS (name agtype);
+EXECUTE id_param('{"id": 844424930131969}');
+EXECUTE id_param('{"id": null}');
+-- parameters that are not integers match nothing or the equal integer
+EXECUTE id_param('{"id": "844424930131969"}');
+EXECUTE id_param('{"id": 844424930131969.0}');
+EXECUTE id_param('{"id": 844424930131969.5}');
+EXECUTE id_param('{"id": [844424930131969]}');
+DEALLOCATE id_param;
+SET enable_seqscan = ON;
+SET enable_bitmapscan = ON;
+
+-- errors
+SELECT * FROM cypher('cypher_index', $$
+CREATE INDEX ON :nonexistent(name)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+MATCH (n) CREATE INDEX ON :person(name)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_index', $$CREATE INDEX person_age ON :person(age)$$) AS (a agtype);
+
+--
+-- Clean up
+--
+SELECT drop_graph('cypher_index', true);
+
+--
+-- End
+--
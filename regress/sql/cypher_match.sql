@@ -456,6 +456,76 @@ SELECT * FROM cypher('cypher_match', $$
 	RETURN u SKIP 7 LIMIT 3
 $$) AS (i agtype);
 
+--
+-- The patterns are joined on the graphid columns of the label tables
+--
+SET age.enable_expand = OFF;
+SET enable_mergejoin = OFF;
+SET enable_nestloop = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (a:v1)-[e:e1]->() RETURN e
+$$) AS (e agtype);
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_match', $$
+	MATCH ()-[e:e1]->(b:v1) RETURN e
+$$) AS (e agtype);
+RESET age.enable_expand;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+
+--
+-- Property constraints served by a GIN index
+--
+SELECT * FROM cypher('cypher_match', $$
+	CREATE (:item {score: 0.1}), (:item {score: 1.5}), (:item {score: 2}),
+	       (:item {score: -0.0}), (:item {score: 0}),
+	       (:item {score: 0.1::numeric})
+$$) AS (a agtype);
+-- the keys of the index do not depend on extra_float_digits
+SET extra_float_digits = 3;
+CREATE INDEX item_gin_idx ON cypher_match.item USING gin (properties);
+RESET extra_float_digits;
+SET enable_seqscan = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.1}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.1}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 2}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.0}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.1::numeric}) RETURN n.score
+$$) AS (score agtype);
+RESET enable_seqscan;
+-- the same rows are returned by a sequential scan
+SET enable_bitmapscan = OFF;
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.1}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 2}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.0}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0}) RETURN n.score
+$$) AS (score agtype);
+SELECT * FROM cypher('cypher_match', $$
+	MATCH (n:item {score: 0.1::numeric}) RETURN n.score
+$$) AS (score agtype);
+RESET enable_bitmapscan;
+
 --
 -- Clean up
 --
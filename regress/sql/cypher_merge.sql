@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+SELECT create_graph('cypher_merge');
+
+-- the path is created when there is no match
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (:person {name: 'Alice'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (n:person {name: 'Alice'})
+RETURN n.name
+$$) AS (name agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (n:person)
+RETURN count(n)
+$$) AS (count agtype);
+
+-- ON CREATE SET and ON MATCH SET
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (n:person {name: 'Bob'})
+ON CREATE SET n.created = true
+ON MATCH SET n.matched = true
+RETURN n.name, n.created, n.matched
+$$) AS (name agtype, created agtype, matched agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (n:person {name: 'Bob'})
+ON CREATE SET n.created = true
+ON MATCH SET n.matched = true
+RETURN n.name, n.created, n.matched
+$$) AS (name agtype, created agtype, matched agtype);
+
+-- edges between bound vertices
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (a:person {name: 'Alice'}), (b:person {name: 'Bob'})
+MERGE (a)-[r:knows {since: 2020}]->(b)
+RETURN r.since
+$$) AS (since agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (a:person {name: 'Alice'}), (b:person {name: 'Bob'})
+MERGE (a)-[r:knows {since: 2020}]->(b)
+RETURN r.since
+$$) AS (since agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH ()-[r:knows]->()
+RETURN count(r)
+$$) AS (count agtype);
+
+-- the whole path is created for every row it is not matched for
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (p:person)
+MERGE (p)-[:likes]->(:food {name: 'pizza'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (p:person)
+MERGE (p)-[:likes]->(:food {name: 'pizza'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (f:food)
+RETURN count(f)
+$$) AS (count agtype);
+
+-- the path is matched from its last vertex when only that one is bound
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (b:person {name: 'Bob'})
+MERGE (c:city {name: 'Paris'})<-[:lives_in]-(b)
+RETURN c.name
+$$) AS (name agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (b:person {name: 'Bob'})
+MERGE (c:city {name: 'Paris'})<-[:lives_in]-(b)
+RETURN c.name
+$$) AS (name agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (c:city)
+RETURN count(c)
+$$) AS (count agtype);
+
+-- the first vertex is looked up with a property index
+SELECT * FROM cypher('cypher_merge', $$
+CREATE INDEX ON :person(name)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (n:person {name: 'Alice'})
+RETURN n.name
+$$) AS (name agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (n:person)
+RETURN count(n)
+$$) AS (count agtype);
+
+-- errors
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (:person)-[:knows]-(:person)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (:person)-[]->(:person)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MATCH (a:person)
+MERGE (a:person)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_merge', $$
+MERGE (:person {name: null})
+$$) AS (a agtype);
+
+SELECT drop_graph('cypher_merge', true);
@@ -123,6 +123,15 @@ SELECT remove_test();
 
 SELECT * FROM cypher('cypher_remove', $$CREATE ( {i : 1 })$$) AS (a agtype);
 SELECT remove_test();
+
+--Remove several properties at once
+SELECT * FROM cypher('cypher_remove', $$
+        MATCH (n:test_1 {j: 5})
+        REMOVE n.a, n.j
+        RETURN n
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_remove', $$MATCH (n:test_1) RETURN n$$) AS (a agtype);
+
 --Errors
 SELECT * FROM cypher('cypher_remove', $$REMOVE n.i$$) AS (a agtype);
 
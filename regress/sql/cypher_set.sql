@@ -121,13 +121,52 @@ SELECT set_test();
 
 SELECT set_test();
 
+--Update several properties at once
+SELECT * FROM cypher('cypher_set', $$
+        MATCH (n {j: 5})
+        SET n.i = 3, n.a = NULL, n.b = 'b', n.i = 4
+        RETURN n
+$$) AS (a agtype);
+
+SELECT * FROM cypher('cypher_set', $$MATCH (n {j: 5}) RETURN n$$) AS (a agtype);
+
+--Update an entity of a path through another variable
+SELECT * FROM cypher('cypher_set', $$CREATE (:path_v {i: 1})-[:path_e]->(:path_v {i: 2})$$) AS (a agtype);
+
+SELECT * FROM cypher('cypher_set', $$
+        MATCH p=(:path_v)-[]->(:path_v)
+        MATCH (n:path_v {i: 2})
+        SET n.i = 20
+        RETURN p
+$$) AS (a agtype);
+
+--Update a property map large enough to store offsets
+SELECT * FROM cypher('cypher_set', $$CREATE (:wide {p0: 0, p1: 1, p2: 2, p3: 3, p4: 4, p5: 5, p6: 6, p7: 7, p8: 8, p9: 9, p10: 10, p11: 11, p12: 12, p13: 13, p14: 14, p15: 15, p16: 16, p17: 17, p18: 18, p19: 19, p20: 20, p21: 21, p22: 22, p23: 23, p24: 24, p25: 25, p26: 26, p27: 27, p28: 28, p29: 29, p30: 30, p31: 31, p32: 32, p33: 33, p34: 34, p35: 35, p36: 36, p37: 37, p38: 38, p39: 39})$$) AS (a agtype);
+
+SELECT * FROM cypher('cypher_set', $$
+        MATCH (n:wide)
+        SET n.p1 = 'one', n.p12 = 1.5, n.p20 = NULL, n.p0 = [0, 1], n.q = 'q'
+        RETURN properties(n)
+$$) AS (a agtype);
+
+SELECT * FROM cypher('cypher_set', $$MATCH (n:wide) RETURN properties(n)$$) AS (a agtype);
+
+--Several items on one entity write one tuple version
+BEGIN;
+SELECT * FROM cypher('cypher_set', $$
+        MATCH (n:wide)
+        SET n.p2 = 'two', n.p3 = 'three', n.p4 = 'four'
+$$) AS (a agtype);
+
+SELECT n_tup_upd FROM pg_stat_xact_user_tables
+WHERE schemaname = 'cypher_set' AND relname = 'wide';
+COMMIT;
+
 --Errors
 SELECT * FROM cypher('cypher_set', $$SET n.i = NULL$$) AS (a agtype);
 
 SELECT * FROM cypher('cypher_set', $$MATCH (n) SET wrong_var.i = 3$$) AS (a agtype);
 
-SELECT * FROM cypher('cypher_set', $$MATCH (n) SET n.i = 3, n.j = 5 $$) AS (a agtype);
-
 --
 -- Clean up
 --
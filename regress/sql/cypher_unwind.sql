@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+SELECT create_graph('cypher_unwind');
+
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND [1, 2, 3] AS x
+RETURN x
+$$) AS (x agtype);
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND [] AS x
+RETURN x
+$$) AS (x agtype);
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND null AS x
+RETURN x
+$$) AS (x agtype);
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND [[1, 2], [3]] AS x
+RETURN x
+$$) AS (x agtype);
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND [1, 2] AS x
+UNWIND ['a', 'b'] AS y
+RETURN x, y
+$$) AS (x agtype, y agtype);
+
+-- a batch of rows created by one statement
+PREPARE unwind_create(agtype) AS
+SELECT * FROM cypher('cypher_unwind', $$
+UNWIND $rows AS row
+CREATE (:event {ts: row.ts, kind: row.kind})
+$$, $1) AS (a agtype);
+EXECUTE unwind_create('{"rows": [{"ts": 1, "kind": "a"}, {"ts": 2, "kind": "b"}, {"ts": 3, "kind": "a"}]}');
+DEALLOCATE unwind_create;
+SELECT * FROM cypher('cypher_unwind', $$
+MATCH (e:event)
+RETURN e.ts, e.kind
+ORDER BY e.ts
+$$) AS (ts agtype, kind agtype);
+
+-- the variables of the previous clauses are kept
+SELECT * FROM cypher('cypher_unwind', $$
+MATCH (e:event)
+WHERE e.kind = 'a'
+UNWIND ['x', 'y'] AS t_name
+CREATE (e)-[:tagged]->(:tag {name: t_name})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_unwind', $$
+MATCH (e:event)-[:tagged]->(t:tag)
+RETURN e.ts, t.name
+ORDER BY e.ts, t.name
+$$) AS (ts agtype, name agtype);
+
+-- errors
+SELECT * FROM cypher('cypher_unwind', $$
+MATCH (e:event) UNWIND [1] AS e RETURN e
+$$) AS (e agtype);
+
+SELECT drop_graph('cypher_unwind', true);
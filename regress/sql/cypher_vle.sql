@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+SELECT create_graph('cypher_vle');
+
+SELECT * FROM cypher('cypher_vle', $$
+CREATE (:person {name: 'Alice'})-[:knows {w: 1}]->(:person {name: 'Bob'})-[:knows {w: 2}]->(:person {name: 'Carol'})-[:knows {w: 1}]->(:person {name: 'Dave'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (c:person {name: 'Carol'}), (a:person {name: 'Alice'})
+CREATE (c)-[:knows {w: 3}]->(a)
+$$) AS (a agtype);
+
+--
+-- Ranges
+--
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[e:knows*1..2]->(b)
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[e:knows*2]->(b)
+RETURN b.name, size(e)
+$$) AS (b agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[e:knows*0..1]->(b)
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+-- the edges of a path are unique, so the cycle is followed once
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[e:knows*]->(b)
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[*3..]->(b:person)
+RETURN b.name ORDER BY b.name
+$$) AS (b agtype);
+
+--
+-- Directions
+--
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Dave'})<-[e:knows*]-(b)
+RETURN b.name, size(e) ORDER BY b.name, size(e)
+$$) AS (b agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Dave'})-[e:knows*1..2]-(b)
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+
+--
+-- Property constraints hold for every edge of the paths
+--
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Carol'})-[e:knows*1..3 {w: 1}]->(b)
+RETURN b.name, size(e)
+$$) AS (b agtype, hops agtype);
+
+--
+-- Both ends bound and longer patterns
+--
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[:knows*1..3]->(b:person {name: 'Dave'})
+RETURN a.name, b.name
+$$) AS (a agtype, b agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Bob'})-[:knows]->(b)-[:knows*1..2]->(c)
+RETURN b.name, c.name ORDER BY c.name
+$$) AS (b agtype, c agtype);
+-- the paths do not reuse the edges of the other relationships
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'})-[:knows]->(b)-[e:knows*1..3]->(c)
+RETURN c.name, size(e) ORDER BY c.name
+$$) AS (c agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Bob'})
+MATCH (a)-[:knows*2]->(c)
+RETURN c.name ORDER BY c.name
+$$) AS (c agtype);
+
+--
+-- Shortest paths
+--
+SELECT * FROM cypher('cypher_vle', $$
+CREATE (:city {name: 'P'})-[:road {w: 1}]->(:city {name: 'Q'})-[:road {w: 1}]->(:city {name: 'S'})-[:road {w: 1}]->(:city {name: 'T'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (p:city {name: 'P'}), (s:city {name: 'S'})
+CREATE (p)-[:road {w: 1}]->(:city {name: 'R'})-[:road {w: 2}]->(s)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city {name: 'P'})-[e:road*]->(b:city {name: 'T'}))
+RETURN size(e)
+$$) AS (hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH allShortestPaths((a:city {name: 'P'})-[e:road*]->(b:city {name: 'T'}))
+RETURN size(e)
+$$) AS (hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH allShortestPaths((a:city {name: 'T'})<-[e:road*]-(b:city {name: 'P'}))
+RETURN size(e)
+$$) AS (hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH allShortestPaths((a:city {name: 'T'})-[e:road*]-(b:city {name: 'P'}))
+RETURN size(e)
+$$) AS (hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH allShortestPaths((a:city {name: 'P'})-[e:road*1..3 {w: 1}]->(b:city {name: 'T'}))
+RETURN size(e)
+$$) AS (hops agtype);
+-- a single hop
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city {name: 'P'})-[e:road]->(b:city {name: 'Q'}))
+RETURN size(e)
+$$) AS (hops agtype);
+-- no paths
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city {name: 'T'})-[e:road*]->(b:city {name: 'P'}))
+RETURN size(e)
+$$) AS (hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city {name: 'P'})-[e:road*..2]->(b:city {name: 'T'}))
+RETURN size(e)
+$$) AS (hops agtype);
+-- from a vertex to every vertex
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:city {name: 'P'}), (b:city), shortestPath((a)-[e:road*]->(b))
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:city {name: 'P'}), (b:city), shortestPath((a)-[e:road*0..]->(b))
+RETURN b.name, size(e) ORDER BY b.name
+$$) AS (b agtype, hops agtype);
+
+--
+-- Errors
+--
+SELECT * FROM cypher('cypher_vle', $$
+MATCH p = (a:person)-[:knows*1..2]->(b) RETURN p
+$$) AS (p agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH (a:person {name: 'Alice'}) CREATE (a)-[:knows*1..2]->(:person)
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city)-[*]->(b)-[*]->(c)) RETURN c
+$$) AS (c agtype);
+SELECT * FROM cypher('cypher_vle', $$
+MATCH shortestPath((a:city)-[*2..3]->(b)) RETURN b
+$$) AS (b agtype);
+
+--
+-- Clean up
+--
+SELECT drop_graph('cypher_vle', true);
+
+--
+-- End
+--
@@ -802,6 +802,19 @@ $$) AS (endNode agtype);
 SELECT * FROM cypher('expr', $$
     RETURN endNode()
 $$) AS (endNode agtype);
+-- startNode() and endNode() find vertices in label tables that have children
+SELECT create_graph('start_end_node');
+SELECT * FROM cypher('start_end_node', $$
+    CREATE (:person {name: 'Alice'})-[:knows]->({name: 'Bob'}),
+           ({name: 'Carol'})-[:knows]->(:person {name: 'Dave'})
+$$) AS (a agtype);
+SELECT * FROM cypher('start_end_node', $$
+    MATCH (a)-[e:knows]->(b)
+    WITH a, b, startNode(e) AS s, endNode(e) AS t
+    RETURN a.name, s.name, s = a, b.name, t.name, t = b
+    ORDER BY a.name
+$$) AS (a agtype, s agtype, s_is_a agtype, b agtype, t agtype, t_is_b agtype);
+SELECT * FROM drop_graph('start_end_node', true);
 -- type()
 SELECT * FROM cypher('expr', $$
     MATCH ()-[e]-() RETURN type(e)
@@ -2052,6 +2065,32 @@ SELECT * FROM cypher('UCSC', $$ RETURN collect(NULL) $$) AS (empty agtype);
 -- should fail
 SELECT * FROM cypher('UCSC', $$ RETURN collect() $$) AS (collect agtype);
 
+-- collect() can be aggregated partially in parallel workers
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SELECT * FROM cypher('UCSC', $$ MATCH (u) RETURN size(collect(u.name)), count(u.name) $$)
+AS (collected agtype, counted agtype);
+-- nested lists and maps are passed between the workers as well
+EXPLAIN (COSTS FALSE)
+SELECT * FROM cypher('UCSC', $$ MATCH (u:students) RETURN collect([u.name, {age: u.age}]) $$)
+AS (c agtype);
+SELECT * FROM cypher('UCSC', $$ MATCH (u:students) WITH collect([u.name, {age: u.age}]) AS c
+UNWIND c AS x RETURN x[0], x[1].age ORDER BY x[0] $$)
+AS (name agtype, age agtype);
+-- strings and numerics collected by the workers outlive their input
+SELECT * FROM cypher('UCSC', $$ MATCH (u:students) WITH collect(u.name) AS c
+UNWIND c AS x RETURN x ORDER BY x $$)
+AS (name agtype);
+SELECT * FROM cypher('UCSC', $$ MATCH (u:students) WITH collect(u.gpa) AS c
+UNWIND c AS x RETURN x ORDER BY x $$)
+AS (gpa agtype);
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
 -- test DISTINCT inside aggregate functions
 SELECT * FROM cypher('UCSC', $$CREATE (:students {name: "Sven", gpa: 3.2, age: 27, zip: 94110})$$)
 AS (a agtype);
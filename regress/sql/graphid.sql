@@ -45,3 +45,22 @@ EXPLAIN (COSTS FALSE) SELECT * FROM graphid_table WHERE gid = '1';
 EXPLAIN (COSTS FALSE) SELECT * FROM graphid_table WHERE gid > '0';
 SET enable_seqscan = ON;
 DROP TABLE graphid_table;
+
+-- hash index
+CREATE TABLE graphid_table (gid graphid);
+INSERT INTO graphid_table VALUES ('0'), ('1'), ('2');
+CREATE INDEX ON graphid_table USING hash (gid);
+SET enable_seqscan = OFF;
+EXPLAIN (COSTS FALSE) SELECT * FROM graphid_table WHERE gid = '1';
+SET enable_seqscan = ON;
+
+-- hash join
+SET enable_mergejoin = OFF;
+SET enable_nestloop = OFF;
+EXPLAIN (COSTS FALSE)
+SELECT * FROM graphid_table a JOIN graphid_table b ON a.gid = b.gid;
+SELECT * FROM graphid_table a JOIN graphid_table b ON a.gid = b.gid
+ORDER BY a.gid;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+DROP TABLE graphid_table;
@@ -25,6 +25,7 @@
 #include "nodes/ag_nodes.h"
 #include "optimizer/cypher_paths.h"
 #include "parser/cypher_analyze.h"
+#include "utils/ag_guc.h"
 
 PG_MODULE_MAGIC;
 
@@ -32,8 +33,10 @@ void _PG_init(void);
 
 void _PG_init(void)
 {
+    define_config_params();
     register_ag_nodes();
     set_rel_pathlist_init();
+    set_join_pathlist_init();
     object_access_hook_init();
     process_utility_hook_init();
     post_parse_analyze_init();
@@ -46,5 +49,6 @@ void _PG_fini(void)
     post_parse_analyze_fini();
     process_utility_hook_fini();
     object_access_hook_fini();
+    set_join_pathlist_fini();
     set_rel_pathlist_fini();
 }
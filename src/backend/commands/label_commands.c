@@ -29,6 +29,7 @@
 #include "commands/sequence.h"
 #include "commands/tablecmds.h"
 #include "miscadmin.h"
+#include "funcapi.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodes.h"
 #include "nodes/parsenodes.h"
@@ -50,6 +51,8 @@
 #include "catalog/ag_label.h"
 #include "commands/label_commands.h"
 #include "utils/ag_cache.h"
+#include "utils/ag_func.h"
+#include "utils/ag_guc.h"
 #include "utils/agtype.h"
 #include "utils/graphid.h"
 
@@ -59,30 +62,34 @@
  */
 #define gen_label_relation_name(label_name) (label_name)
 
-static void create_table_for_label(char *graph_name, char *label_name,
-                                   char *schema_name, char *rel_name,
+static void create_table_for_label(char *schema_name, char *rel_name,
                                    char *seq_name, char label_type,
-                                   List *parents);
+                                   int32 label_id, List *parents);
 
 // common
-static List *create_edge_table_elements(char *graph_name, char *label_name,
-                                        char *schema_name, char *rel_name,
-                                        char *seq_name);
-static List *create_vertex_table_elements(char *graph_name, char *label_name,
-                                          char *schema_name, char *rel_name,
-                                          char *seq_name);
+static List *create_edge_table_elements(int32 label_id, char *schema_name,
+                                        char *rel_name, char *seq_name);
+static List *create_vertex_table_elements(int32 label_id, char *schema_name,
+                                          char *rel_name, char *seq_name);
 static void create_sequence_for_label(RangeVar *seq_range_var);
+static void create_index_on_column(char *schema_name, char *rel_name,
+                                   char *col_name);
+static void create_index_on_property(char *schema_name, char *rel_name,
+                                     Oid relid, char *index_name,
+                                     char *property_name);
 static Constraint *build_pk_constraint(void);
-static Constraint *build_id_default(char *graph_name, char *label_name,
-                                    char *schema_name, char *seq_name);
-static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
+static Constraint *build_id_range_check(int32 label_id);
+static TypeCast *make_graphid_const(graphid id);
+static Constraint *build_id_default(int32 label_id, char *schema_name,
+                                    char *seq_name);
+static FuncCall *build_id_default_func_expr(int32 label_id,
                                             char *schema_name, char *seq_name);
 static Constraint *build_not_null_constraint(void);
 static Constraint *build_properties_default(void);
 static void alter_sequence_owned_by_for_label(RangeVar *seq_range_var,
                                               char *rel_name);
 static int32 get_new_label_id(Oid graph_oid, Oid nsp_id);
-static void change_label_id_default(char *graph_name, char *label_name,
+static void change_label_id_default(int32 label_id, char *label_name,
                                     char *schema_name, char *seq_name,
                                     Oid relid);
 
@@ -128,24 +135,35 @@ Oid create_label(char *graph_name, char *label_name, char label_type,
     seq_range_var = makeRangeVar(schema_name, seq_name, -1);
     create_sequence_for_label(seq_range_var);
 
+    // get a new "id" for the new label
+    label_id = get_new_label_id(graph_oid, nsp_id);
+
     // create a table for the new label
-    create_table_for_label(graph_name, label_name, schema_name, rel_name,
-                           seq_name, label_type, parents);
+    create_table_for_label(schema_name, rel_name, seq_name, label_type,
+                           label_id, parents);
+
+    /*
+     * Index the columns that are used to find the edges attached to a vertex.
+     * Indexes are not inherited, so this is done for every edge label.
+     */
+    if (label_type == LABEL_TYPE_EDGE && age_create_edge_indexes)
+    {
+        create_index_on_column(schema_name, rel_name,
+                               AG_EDGE_COLNAME_START_ID);
+        create_index_on_column(schema_name, rel_name, AG_EDGE_COLNAME_END_ID);
+    }
 
     // record the new label in ag_label
     relation_id = get_relname_relid(rel_name, nsp_id);
 
     // If a label has parents, switch the parents id default, with its own.
     if (list_length(parents) != 0)
-        change_label_id_default(graph_name, label_name, schema_name, seq_name,
+        change_label_id_default(label_id, label_name, schema_name, seq_name,
                                 relation_id);
 
     // associate the sequence with the "id" column
     alter_sequence_owned_by_for_label(seq_range_var, rel_name);
 
-    // get a new "id" for the new label
-    label_id = get_new_label_id(graph_oid, nsp_id);
-
     label_oid = insert_label(label_name, graph_oid, label_id, label_type,
                              relation_id);
 
@@ -158,14 +176,16 @@ Oid create_label(char *graph_name, char *label_name, char label_type,
 //   "id" graphid PRIMARY KEY DEFAULT "ag_catalog"."_graphid"(...),
 //   "start_id" graphid NOT NULL note: only for edge labels
 //   "end_id" graphid NOT NULL  note: only for edge labels
-//   "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"()
+//   "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"(),
+//   PRIMARY KEY ("id") note: only for labels with parents
+//   CHECK ("id" >= ... AND "id" <= ...) NO INHERIT
 // )
-static void create_table_for_label(char *graph_name, char *label_name,
-                                   char *schema_name, char *rel_name,
+static void create_table_for_label(char *schema_name, char *rel_name,
                                    char *seq_name, char label_type,
-                                   List *parents)
+                                   int32 label_id, List *parents)
 {
     CreateStmt *create_stmt;
+    Constraint *pk;
     PlannedStmt *wrapper;
 
     create_stmt = makeNode(CreateStmt);
@@ -182,10 +202,10 @@ static void create_table_for_label(char *graph_name, char *label_name,
         create_stmt->tableElts = NIL;
     else if (label_type == LABEL_TYPE_EDGE)
         create_stmt->tableElts = create_edge_table_elements(
-            graph_name, label_name, schema_name, rel_name, seq_name);
+            label_id, schema_name, rel_name, seq_name);
     else if (label_type == LABEL_TYPE_VERTEX)
         create_stmt->tableElts = create_vertex_table_elements(
-            graph_name, label_name, schema_name, rel_name, seq_name);
+            label_id, schema_name, rel_name, seq_name);
     else
         ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
                         errmsg("undefined label type \'%c\'", label_type)));
@@ -193,7 +213,20 @@ static void create_table_for_label(char *graph_name, char *label_name,
     create_stmt->inhRelations = parents;
     create_stmt->partbound = NULL;
     create_stmt->ofTypename = NULL;
-    create_stmt->constraints = NIL;
+
+    /*
+     * Constraints are not inherited, so the primary key on "id" is declared
+     * for every label table. The range check lets the planner exclude the
+     * label tables that cannot have a given id.
+     */
+    create_stmt->constraints = list_make1(build_id_range_check(label_id));
+    if (list_length(parents) != 0)
+    {
+        pk = build_pk_constraint();
+        pk->keys = list_make1(makeString(AG_VERTEX_COLNAME_ID));
+        create_stmt->constraints = lcons(pk, create_stmt->constraints);
+    }
+
     create_stmt->options = NIL;
     create_stmt->oncommit = ONCOMMIT_NOOP;
     create_stmt->tablespacename = NULL;
@@ -218,9 +251,8 @@ static void create_table_for_label(char *graph_name, char *label_name,
 //   "end_id" graphid NOT NULL
 //   "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"()
 // )
-static List *create_edge_table_elements(char *graph_name, char *label_name,
-                                        char *schema_name, char *rel_name,
-                                        char *seq_name)
+static List *create_edge_table_elements(int32 label_id, char *schema_name,
+                                        char *rel_name, char *seq_name)
 {
     ColumnDef *id;
     ColumnDef *start_id;
@@ -230,8 +262,8 @@ static List *create_edge_table_elements(char *graph_name, char *label_name,
     // "id" graphid PRIMARY KEY DEFAULT "ag_catalog"."_graphid"(...)
     id = makeColumnDef(AG_EDGE_COLNAME_ID, GRAPHIDOID, -1, InvalidOid);
     id->constraints = list_make2(build_pk_constraint(),
-                                 build_id_default(graph_name, label_name,
-                                                  schema_name, seq_name));
+                                 build_id_default(label_id, schema_name,
+                                                  seq_name));
 
     // "start_id" graphid NOT NULL
     start_id = makeColumnDef(AG_EDGE_COLNAME_START_ID, GRAPHIDOID, -1,
@@ -255,9 +287,8 @@ static List *create_edge_table_elements(char *graph_name, char *label_name,
 //   "id" graphid PRIMARY KEY DEFAULT "ag_catalog"."_graphid"(...),
 //   "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"()
 // )
-static List *create_vertex_table_elements(char *graph_name, char *label_name,
-                                          char *schema_name, char *rel_name,
-                                          char *seq_name)
+static List *create_vertex_table_elements(int32 label_id, char *schema_name,
+                                          char *rel_name, char *seq_name)
 {
     ColumnDef *id;
     ColumnDef *props;
@@ -265,8 +296,8 @@ static List *create_vertex_table_elements(char *graph_name, char *label_name,
     // "id" graphid PRIMARY KEY DEFAULT "ag_catalog"."_graphid"(...)
     id = makeColumnDef(AG_VERTEX_COLNAME_ID, GRAPHIDOID, -1, InvalidOid);
     id->constraints = list_make2(build_pk_constraint(),
-                                 build_id_default(graph_name, label_name,
-                                                  schema_name, seq_name));
+                                 build_id_default(label_id, schema_name,
+                                                  seq_name));
 
     // "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"()
     props = makeColumnDef(AG_VERTEX_COLNAME_PROPERTIES, AGTYPEOID, -1,
@@ -277,13 +308,20 @@ static List *create_vertex_table_elements(char *graph_name, char *label_name,
     return list_make2(id, props);
 }
 
-// CREATE SEQUENCE `seq_range_var` MAXVALUE `LOCAL_ID_MAX`
+/*
+ * CREATE SEQUENCE `seq_range_var` MAXVALUE `LOCAL_ID_MAX`
+ *                 CACHE `age_entry_id_cache_size`
+ *
+ * Each backend reserves a block of entry ids from the sequence at a time, so
+ * concurrent writers to the same label rarely contend for the sequence.
+ */
 static void create_sequence_for_label(RangeVar *seq_range_var)
 {
     ParseState *pstate;
     CreateSeqStmt *seq_stmt;
     char buf[32]; // greater than MAXINT8LEN+1
     DefElem *maxvalue;
+    DefElem *cache;
 
     pstate = make_parsestate(NULL);
     pstate->p_sourcetext = "(generated CREATE SEQUENCE command)";
@@ -292,7 +330,9 @@ static void create_sequence_for_label(RangeVar *seq_range_var)
     seq_stmt->sequence = seq_range_var;
     pg_lltoa(ENTRY_ID_MAX, buf);
     maxvalue = makeDefElem("maxvalue", (Node *)makeFloat(pstrdup(buf)), -1);
-    seq_stmt->options = list_make1(maxvalue);
+    cache = makeDefElem("cache", (Node *)makeInteger(age_entry_id_cache_size),
+                        -1);
+    seq_stmt->options = list_make2(maxvalue, cache);
     seq_stmt->ownerId = InvalidOid;
     seq_stmt->for_identity = false;
     seq_stmt->if_not_exists = false;
@@ -301,6 +341,215 @@ static void create_sequence_for_label(RangeVar *seq_range_var)
     CommandCounterIncrement();
 }
 
+// CREATE INDEX ON `schema_name`.`rel_name` USING btree (`col_name`)
+static void create_index_on_column(char *schema_name, char *rel_name,
+                                   char *col_name)
+{
+    IndexElem *index_col;
+    IndexStmt *index_stmt;
+    PlannedStmt *wrapper;
+
+    index_col = makeNode(IndexElem);
+    index_col->name = col_name;
+    index_col->expr = NULL;
+    index_col->indexcolname = NULL;
+    index_col->collation = NIL;
+    index_col->opclass = NIL;
+    index_col->ordering = SORTBY_DEFAULT;
+    index_col->nulls_ordering = SORTBY_NULLS_DEFAULT;
+
+    // idxname is NULL so that the name is chosen the same way as PostgreSQL
+    index_stmt = makeNode(IndexStmt);
+    index_stmt->idxname = NULL;
+    index_stmt->relation = makeRangeVar(schema_name, rel_name, -1);
+    index_stmt->accessMethod = "btree";
+    index_stmt->tableSpace = NULL;
+    index_stmt->indexParams = list_make1(index_col);
+    index_stmt->indexIncludingParams = NIL;
+    index_stmt->options = NIL;
+    index_stmt->whereClause = NULL;
+    index_stmt->excludeOpNames = NIL;
+    index_stmt->idxcomment = NULL;
+    index_stmt->indexOid = InvalidOid;
+    index_stmt->oldNode = InvalidOid;
+    index_stmt->unique = false;
+    index_stmt->primary = false;
+    index_stmt->isconstraint = false;
+    index_stmt->deferrable = false;
+    index_stmt->initdeferred = false;
+    index_stmt->transformed = false;
+    index_stmt->concurrent = false;
+    index_stmt->if_not_exists = false;
+
+    wrapper = makeNode(PlannedStmt);
+    wrapper->commandType = CMD_UTILITY;
+    wrapper->canSetTag = false;
+    wrapper->utilityStmt = (Node *)index_stmt;
+    wrapper->stmt_location = -1;
+    wrapper->stmt_len = 0;
+
+    ProcessUtility(wrapper, "(generated CREATE INDEX command)",
+                   PROCESS_UTILITY_SUBCOMMAND, NULL, NULL, None_Receiver,
+                   NULL);
+    // CommandCounterIncrement() is called in ProcessUtility()
+}
+
+/*
+ * CREATE INDEX `index_name` ON `schema_name`.`rel_name` USING btree
+ * (agtype_access_operator(properties, '"`property_name`"'))
+ *
+ * The index expression is built here in the exact shape that
+ * transform_A_Indirection() produces for `var.property_name`, rather than
+ * parsed from SQL, which would pack the variadic arguments of
+ * agtype_access_operator() into an array. Otherwise, the planner could not
+ * match Cypher property accesses to the index.
+ */
+static void create_index_on_property(char *schema_name, char *rel_name,
+                                     Oid relid, char *index_name,
+                                     char *property_name)
+{
+    Var *props;
+    Const *key;
+    FuncExpr *access;
+    Oid access_func_oid;
+    IndexElem *index_col;
+    IndexStmt *index_stmt;
+    PlannedStmt *wrapper;
+
+    props = makeVar(1, get_attnum(relid, AG_VERTEX_COLNAME_PROPERTIES),
+                    AGTYPEOID, -1, InvalidOid, 0);
+
+    key = makeConst(AGTYPEOID, -1, InvalidOid, -1,
+                    string_to_agtype(property_name), false, false);
+
+    access_func_oid = get_ag_func_oid("agtype_access_operator", 1,
+                                      AGTYPEARRAYOID);
+    access = makeFuncExpr(access_func_oid, AGTYPEOID, list_make2(props, key),
+                          InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+    index_col = makeNode(IndexElem);
+    index_col->name = NULL;
+    index_col->expr = (Node *)access;
+    index_col->indexcolname = property_name;
+    index_col->collation = NIL;
+    index_col->opclass = NIL;
+    index_col->ordering = SORTBY_DEFAULT;
+    index_col->nulls_ordering = SORTBY_NULLS_DEFAULT;
+
+    index_stmt = makeNode(IndexStmt);
+    index_stmt->idxname = index_name;
+    index_stmt->relation = makeRangeVar(schema_name, rel_name, -1);
+    index_stmt->accessMethod = "btree";
+    index_stmt->tableSpace = NULL;
+    index_stmt->indexParams = list_make1(index_col);
+    index_stmt->indexIncludingParams = NIL;
+    index_stmt->options = NIL;
+    index_stmt->whereClause = NULL;
+    index_stmt->excludeOpNames = NIL;
+    index_stmt->idxcomment = NULL;
+    index_stmt->indexOid = InvalidOid;
+    index_stmt->oldNode = InvalidOid;
+    index_stmt->unique = false;
+    index_stmt->primary = false;
+    index_stmt->isconstraint = false;
+    index_stmt->deferrable = false;
+    index_stmt->initdeferred = false;
+    // the index expression is already transformed
+    index_stmt->transformed = true;
+    index_stmt->concurrent = false;
+    index_stmt->if_not_exists = false;
+
+    wrapper = makeNode(PlannedStmt);
+    wrapper->commandType = CMD_UTILITY;
+    wrapper->canSetTag = false;
+    wrapper->utilityStmt = (Node *)index_stmt;
+    wrapper->stmt_location = -1;
+    wrapper->stmt_len = 0;
+
+    ProcessUtility(wrapper, "(generated CREATE INDEX command)",
+                   PROCESS_UTILITY_SUBCOMMAND, NULL, NULL, None_Receiver,
+                   NULL);
+    // CommandCounterIncrement() is called in ProcessUtility()
+}
+
+PG_FUNCTION_INFO_V1(_create_property_index);
+
+/*
+ * Execution function of the CREATE INDEX clause. It creates a btree index on
+ * a property of the label table and returns no rows.
+ */
+Datum _create_property_index(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *)fcinfo->resultinfo;
+    char *graph_name_str;
+    char *label_name_str;
+    char *property_name;
+    char *index_name;
+    graph_cache_data *cache_data;
+    Oid label_relation;
+    char *schema_name;
+    char *rel_name;
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    }
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("graph name must not be NULL")));
+    }
+    if (PG_ARGISNULL(1))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("label name must not be NULL")));
+    }
+    if (PG_ARGISNULL(2))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("property name must not be NULL")));
+    }
+    graph_name_str = NameStr(*PG_GETARG_NAME(0));
+    label_name_str = NameStr(*PG_GETARG_NAME(1));
+    property_name = text_to_cstring(PG_GETARG_TEXT_PP(2));
+
+    cache_data = search_graph_name_cache(graph_name_str);
+    if (!cache_data)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                 errmsg("graph \"%s\" does not exist", graph_name_str)));
+    }
+
+    label_relation = get_label_relation(label_name_str, cache_data->oid);
+    if (!OidIsValid(label_relation))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("label \"%s\" does not exist", label_name_str)));
+    }
+
+    schema_name = get_namespace_name(cache_data->namespace);
+    rel_name = get_rel_name(label_relation);
+
+    // name the index after the label and the property by default
+    if (PG_ARGISNULL(3))
+        index_name = ChooseRelationName(rel_name, property_name, "idx",
+                                        cache_data->namespace, false);
+    else
+        index_name = NameStr(*PG_GETARG_NAME(3));
+
+    create_index_on_property(schema_name, rel_name, label_relation,
+                             index_name, property_name);
+
+    rsinfo->isDone = ExprEndResult;
+
+    PG_RETURN_NULL();
+}
+
 /*
  * Builds the primary key constraint for when a table is created.
  */
@@ -319,18 +568,79 @@ static Constraint *build_pk_constraint(void)
     return pk;
 }
 
+/*
+ * CHECK ("id" >= `lower` AND "id" <= `upper`) NO INHERIT
+ *
+ * All ids of a label have the id of the label in their upper bits, so they
+ * are in a range that does not overlap with the ranges of the other labels.
+ */
+static Constraint *build_id_range_check(int32 label_id)
+{
+    ColumnRef *id;
+    List *ge_name;
+    List *le_name;
+    A_Expr *ge;
+    A_Expr *le;
+    Constraint *check;
+
+    id = makeNode(ColumnRef);
+    id->fields = list_make1(makeString(AG_VERTEX_COLNAME_ID));
+    id->location = -1;
+
+    ge_name = list_make2(makeString("ag_catalog"), makeString(">="));
+    ge = makeA_Expr(AEXPR_OP, ge_name, (Node *)id,
+                    (Node *)make_graphid_const(make_graphid(label_id,
+                                                            ENTRY_ID_MIN)),
+                    -1);
+
+    le_name = list_make2(makeString("ag_catalog"), makeString("<="));
+    le = makeA_Expr(AEXPR_OP, le_name, copyObject(id),
+                    (Node *)make_graphid_const(make_graphid(label_id,
+                                                            ENTRY_ID_MAX)),
+                    -1);
+
+    check = makeNode(Constraint);
+    check->contype = CONSTR_CHECK;
+    check->location = -1;
+    check->is_no_inherit = true;
+    check->raw_expr = (Node *)makeBoolExpr(AND_EXPR, list_make2(ge, le), -1);
+    check->cooked_expr = NULL;
+    check->skip_validation = false;
+    check->initially_valid = true;
+
+    return check;
+}
+
+// '`id`'::"ag_catalog"."graphid"
+static TypeCast *make_graphid_const(graphid id)
+{
+    char buf[32]; // greater than MAXINT8LEN+1
+    A_Const *id_const;
+    TypeCast *graphid_cast;
+
+    pg_lltoa(id, buf);
+    id_const = makeNode(A_Const);
+    id_const->val.type = T_String;
+    id_const->val.val.str = pstrdup(buf);
+    id_const->location = -1;
+
+    graphid_cast = makeNode(TypeCast);
+    graphid_cast->typeName = makeTypeNameFromNameList(
+        list_make2(makeString("ag_catalog"), makeString("graphid")));
+    graphid_cast->arg = (Node *)id_const;
+    graphid_cast->location = -1;
+
+    return graphid_cast;
+}
+
 /*
  * Construct a FuncCall node that will create the default logic for the label's
  * id.
  */
-static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
+static FuncCall *build_id_default_func_expr(int32 label_id,
                                             char *schema_name, char *seq_name)
 {
-    List *label_id_func_name;
-    A_Const *graph_name_const;
-    A_Const *label_name_const;
-    List *label_id_func_args;
-    FuncCall *label_id_func;
+    A_Const *label_id_const;
     List *nextval_func_name;
     char *qualified_seq_name;
     A_Const *qualified_seq_name_const;
@@ -341,19 +651,14 @@ static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
     List *graphid_func_args;
     FuncCall *graphid_func;
 
-    // Build a node that gets the label id
-    label_id_func_name = list_make2(makeString("ag_catalog"),
-                                    makeString("_label_id"));
-    graph_name_const = makeNode(A_Const);
-    graph_name_const->val.type = T_String;
-    graph_name_const->val.val.str = graph_name;
-    graph_name_const->location = -1;
-    label_name_const = makeNode(A_Const);
-    label_name_const->val.type = T_String;
-    label_name_const->val.val.str = label_name;
-    label_name_const->location = -1;
-    label_id_func_args = list_make2(graph_name_const, label_name_const);
-    label_id_func = makeFuncCall(label_id_func_name, label_id_func_args, -1);
+    /*
+     * The label id never changes, so it is stored in the default as a
+     * constant instead of being looked up by name for every new row.
+     */
+    label_id_const = makeNode(A_Const);
+    label_id_const->val.type = T_Integer;
+    label_id_const->val.val.ival = label_id;
+    label_id_const->location = -1;
 
     //Build a node that will get the next val from the label's sequence
     nextval_func_name = SystemFuncName("nextval");
@@ -370,12 +675,12 @@ static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
     nextval_func = makeFuncCall(nextval_func_name, nextval_func_args, -1);
 
     /*
-     * Build a node that contructs the graphid from the label id function
-     * and the next val function for the given sequence.
+     * Build a node that contructs the graphid from the label id and the next
+     * val function for the given sequence.
      */
     graphid_func_name = list_make2(makeString("ag_catalog"),
                                    makeString("_graphid"));
-    graphid_func_args = list_make2(label_id_func, nextval_func);
+    graphid_func_args = list_make2(label_id_const, nextval_func);
     graphid_func = makeFuncCall(graphid_func_name, graphid_func_args, -1);
 
     return graphid_func;
@@ -384,14 +689,14 @@ static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
 /*
  * Construct a default constraint on the id column for a newly created table
  */
-static Constraint *build_id_default(char *graph_name, char *label_name,
-                                    char *schema_name, char *seq_name)
+static Constraint *build_id_default(int32 label_id, char *schema_name,
+                                    char *seq_name)
 {
     FuncCall *graphid_func;
     Constraint *id_default;
 
-    graphid_func = build_id_default_func_expr(graph_name, label_name,
-                                              schema_name, seq_name);
+    graphid_func = build_id_default_func_expr(label_id, schema_name,
+                                              seq_name);
 
     id_default = makeNode(Constraint);
     id_default->contype = CONSTR_DEFAULT;
@@ -439,7 +744,7 @@ static Constraint *build_properties_default(void)
  * Alter the default constraint on the label's id to the use the given
  * sequence.
  */
-static void change_label_id_default(char *graph_name, char *label_name,
+static void change_label_id_default(int32 label_id, char *label_name,
                                     char *schema_name, char *seq_name,
                                     Oid relid)
 {
@@ -449,8 +754,7 @@ static void change_label_id_default(char *graph_name, char *label_name,
     RangeVar *rv;
     FuncCall *func_call;
 
-    func_call = build_id_default_func_expr(graph_name, label_name, schema_name,
-                                           seq_name);
+    func_call = build_id_default_func_expr(label_id, schema_name, seq_name);
 
     rv = makeRangeVar(schema_name, label_name, -1);
 
@@ -0,0 +1,859 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/xact.h"
+#include "catalog/dependency.h"
+#include "catalog/pg_authid.h"
+#include "commands/sequence.h"
+#include "executor/executor.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "storage/fd.h"
+#include "storage/lmgr.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/int8.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+#include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
+#include "commands/label_commands.h"
+#include "utils/ag_cache.h"
+#include "utils/agtype.h"
+#include "utils/graphid.h"
+
+/*
+ * Number of tuples handed to heap_multi_insert() at once. The tuples of a
+ * batch live in their own memory context that is reset after each flush.
+ */
+#define LOAD_BATCH_SIZE 1000
+
+// reads records from a CSV file (RFC 4180, the first record is the header)
+typedef struct csv_reader
+{
+    FILE *file;
+    char *path;
+    int64 line_no; // line where the current record starts
+    int64 next_line_no;
+    StringInfoData buf;
+    List *fields; // char * of the current record
+    List *quoted; // whether each field of the current record was quoted
+} csv_reader;
+
+// inserts tuples into a label table in batches
+typedef struct label_loader
+{
+    Relation rel;
+    EState *estate;
+    ResultRelInfo *resultRelInfo;
+    TupleTableSlot *slot;
+    BulkInsertState bistate;
+    CommandId cid;
+    MemoryContext batch_mcxt;
+    int num_tuples;
+    HeapTuple tuples[LOAD_BATCH_SIZE];
+} label_loader;
+
+static void check_load_arguments(FunctionCallInfo fcinfo, int nargs);
+static void check_file_read_permission(void);
+static label_cache_data *get_or_create_label(char *graph_name, Oid graph_oid,
+                                             char *label_name,
+                                             char label_type);
+static Oid get_label_seq_relid(label_cache_data *label);
+static int64 lock_label_seq(Oid seq_relid);
+
+static void csv_open(csv_reader *reader, char *path);
+static void csv_close(csv_reader *reader);
+static bool csv_read_record(csv_reader *reader);
+static void csv_end_field(csv_reader *reader, bool quoted);
+static void csv_check_num_fields(csv_reader *reader, int expected);
+static char *csv_field(csv_reader *reader, int n, bool *quoted);
+static int64 csv_int8_field(csv_reader *reader, int n, const char *name);
+
+static agtype *build_properties(csv_reader *reader, List *header, int first);
+static void infer_agtype_value(char *str, bool quoted, agtype_value *val);
+
+static void label_loader_begin(label_loader *loader, Oid relid);
+static void label_loader_insert(label_loader *loader, Datum *values,
+                                bool *nulls);
+static void label_loader_flush(label_loader *loader);
+static void label_loader_end(label_loader *loader);
+
+/*
+ * load_labels_from_file(graph_name, label_name, file_path, id_field_exists)
+ *
+ * Loads vertices of the given label from a CSV file. The first record of the
+ * file names the properties. If id_field_exists is true, the first column is
+ * the integer id of each vertex within the label and the rest are properties.
+ * Otherwise, every column is a property and ids are drawn from the label's
+ * sequence. The label is created if it does not exist.
+ *
+ * The ids in the file are used as the entry ids of the vertices as they are,
+ * there is no map from other external keys to generated ids. They must be
+ * greater than every id the label's sequence has handed out, and the sequence
+ * is advanced past them, see lock_label_seq().
+ */
+PG_FUNCTION_INFO_V1(load_labels_from_file);
+
+Datum load_labels_from_file(PG_FUNCTION_ARGS)
+{
+    char *graph_name;
+    char *label_name;
+    char *file_path;
+    bool id_field_exists;
+    graph_cache_data *graph;
+    label_cache_data *label;
+    Oid seq_relid;
+    csv_reader reader;
+    label_loader loader;
+    List *header;
+    int first_prop;
+    int64 last_seq_value = 0;
+    int64 max_entry_id = 0;
+
+    check_load_arguments(fcinfo, 3);
+
+    graph_name = NameStr(*PG_GETARG_NAME(0));
+    label_name = NameStr(*PG_GETARG_NAME(1));
+    file_path = text_to_cstring(PG_GETARG_TEXT_PP(2));
+    id_field_exists = PG_ARGISNULL(3) ? true : PG_GETARG_BOOL(3);
+
+    graph = search_graph_name_cache(graph_name);
+    if (!graph)
+    {
+        ereport(ERROR, (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                        errmsg("graph \"%s\" does not exist", graph_name)));
+    }
+
+    label = get_or_create_label(graph_name, graph->oid, label_name,
+                                LABEL_TYPE_VERTEX);
+    seq_relid = get_label_seq_relid(label);
+    if (id_field_exists)
+        last_seq_value = lock_label_seq(seq_relid);
+
+    csv_open(&reader, file_path);
+
+    if (!csv_read_record(&reader))
+    {
+        ereport(ERROR, (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                        errmsg("file \"%s\" has no header", file_path)));
+    }
+    header = reader.fields;
+    first_prop = id_field_exists ? 1 : 0;
+
+    label_loader_begin(&loader, label->relation);
+
+    for (;;)
+    {
+        MemoryContext old_mcxt;
+        graphid id;
+        agtype *props;
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        // the fields of a record are freed along with the batch
+        old_mcxt = MemoryContextSwitchTo(loader.batch_mcxt);
+        if (!csv_read_record(&reader))
+        {
+            MemoryContextSwitchTo(old_mcxt);
+            break;
+        }
+        csv_check_num_fields(&reader, list_length(header));
+
+        if (id_field_exists)
+        {
+            int64 entry_id = csv_int8_field(&reader, 0, linitial(header));
+
+            if (entry_id <= last_seq_value)
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("id " INT64_FORMAT " may already have been assigned by the sequence of label \"%s\"",
+                                entry_id, label_name),
+                         errhint("The ids loaded into the label must be greater than " INT64_FORMAT ".",
+                                 last_seq_value),
+                         errcontext("file \"%s\", line " INT64_FORMAT,
+                                    file_path, reader.line_no)));
+            }
+
+            id = make_graphid(label->id, entry_id);
+            if (entry_id > max_entry_id)
+                max_entry_id = entry_id;
+        }
+        else
+        {
+            id = make_graphid(label->id, nextval_internal(seq_relid, true));
+        }
+        props = build_properties(&reader, header, first_prop);
+
+        values[vertex_tuple_id] = GRAPHID_GET_DATUM(id);
+        values[vertex_tuple_properties] = AGTYPE_P_GET_DATUM(props);
+
+        MemoryContextSwitchTo(old_mcxt);
+
+        label_loader_insert(&loader, values, nulls);
+    }
+
+    label_loader_end(&loader);
+    csv_close(&reader);
+
+    /*
+     * Make sure that vertices created later through the label's sequence do
+     * not collide with the ids given in the file. The sequence stays locked
+     * until the end of the transaction.
+     */
+    if (max_entry_id > 0)
+    {
+        DirectFunctionCall2(setval_oid, ObjectIdGetDatum(seq_relid),
+                            Int64GetDatum(max_entry_id));
+    }
+
+    PG_RETURN_VOID();
+}
+
+/*
+ * load_edges_from_file(graph_name, label_name, file_path)
+ *
+ * Loads edges of the given label from a CSV file. The first four columns are
+ * start_id, start_vertex_type, end_id, and end_vertex_type where the ids are
+ * the integer ids of the vertices within the given vertex labels (as loaded
+ * by load_labels_from_file() with id_field_exists). The rest are properties.
+ * The label is created if it does not exist.
+ *
+ * Only the vertex labels are checked. No check is made that the start and end
+ * vertices exist, so the vertices must be loaded before their edges.
+ *
+ * The ids of the edges are drawn from the label's sequence.
+ */
+PG_FUNCTION_INFO_V1(load_edges_from_file);
+
+Datum load_edges_from_file(PG_FUNCTION_ARGS)
+{
+    char *graph_name;
+    char *label_name;
+    char *file_path;
+    graph_cache_data *graph;
+    label_cache_data *label;
+    Oid seq_relid;
+    csv_reader reader;
+    label_loader loader;
+    List *header;
+
+    check_load_arguments(fcinfo, 3);
+
+    graph_name = NameStr(*PG_GETARG_NAME(0));
+    label_name = NameStr(*PG_GETARG_NAME(1));
+    file_path = text_to_cstring(PG_GETARG_TEXT_PP(2));
+
+    graph = search_graph_name_cache(graph_name);
+    if (!graph)
+    {
+        ereport(ERROR, (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                        errmsg("graph \"%s\" does not exist", graph_name)));
+    }
+
+    label = get_or_create_label(graph_name, graph->oid, label_name,
+                                LABEL_TYPE_EDGE);
+    seq_relid = get_label_seq_relid(label);
+
+    csv_open(&reader, file_path);
+
+    if (!csv_read_record(&reader))
+    {
+        ereport(ERROR, (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                        errmsg("file \"%s\" has no header", file_path)));
+    }
+    header = reader.fields;
+    if (list_length(header) < 4)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                 errmsg("file \"%s\" must start with start_id, start_vertex_type, end_id, and end_vertex_type columns",
+                        file_path)));
+    }
+
+    label_loader_begin(&loader, label->relation);
+
+    for (;;)
+    {
+        MemoryContext old_mcxt;
+        graphid ids[2];
+        agtype *props;
+        Datum values[4];
+        bool nulls[4] = {false, false, false, false};
+        int i;
+
+        // the fields of a record are freed along with the batch
+        old_mcxt = MemoryContextSwitchTo(loader.batch_mcxt);
+        if (!csv_read_record(&reader))
+        {
+            MemoryContextSwitchTo(old_mcxt);
+            break;
+        }
+        csv_check_num_fields(&reader, list_length(header));
+
+        // start vertex (columns 0 and 1) and end vertex (columns 2 and 3)
+        for (i = 0; i < 2; i++)
+        {
+            int64 entry_id;
+            char *vertex_label;
+            label_cache_data *vlabel;
+
+            entry_id = csv_int8_field(&reader, i * 2,
+                                      list_nth(header, i * 2));
+            vertex_label = csv_field(&reader, i * 2 + 1, NULL);
+
+            vlabel = search_label_name_graph_cache(vertex_label, graph->oid);
+            if (!vlabel || vlabel->kind != LABEL_KIND_VERTEX)
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_UNDEFINED_OBJECT),
+                         errmsg("vertex label \"%s\" does not exist",
+                                vertex_label),
+                         errcontext("file \"%s\", line " INT64_FORMAT,
+                                    file_path, reader.line_no)));
+            }
+
+            ids[i] = make_graphid(vlabel->id, entry_id);
+        }
+        props = build_properties(&reader, header, 4);
+
+        values[edge_tuple_id] = GRAPHID_GET_DATUM(
+            make_graphid(label->id, nextval_internal(seq_relid, true)));
+        values[edge_tuple_start_id] = GRAPHID_GET_DATUM(ids[0]);
+        values[edge_tuple_end_id] = GRAPHID_GET_DATUM(ids[1]);
+        values[edge_tuple_properties] = AGTYPE_P_GET_DATUM(props);
+
+        MemoryContextSwitchTo(old_mcxt);
+
+        label_loader_insert(&loader, values, nulls);
+    }
+
+    label_loader_end(&loader);
+    csv_close(&reader);
+
+    PG_RETURN_VOID();
+}
+
+static void check_load_arguments(FunctionCallInfo fcinfo, int nargs)
+{
+    static const char *const arg_names[] = {"graph name", "label name",
+                                            "file path"};
+    int i;
+
+    for (i = 0; i < nargs; i++)
+    {
+        if (PG_ARGISNULL(i))
+        {
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                            errmsg("%s must not be NULL", arg_names[i])));
+        }
+    }
+
+    check_file_read_permission();
+}
+
+// the same rule as COPY FROM a file
+static void check_file_read_permission(void)
+{
+    if (!is_member_of_role(GetUserId(), DEFAULT_ROLE_READ_SERVER_FILES))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                 errmsg("must be superuser or a member of the pg_read_server_files role to load a graph from a file")));
+    }
+}
+
+static label_cache_data *get_or_create_label(char *graph_name, Oid graph_oid,
+                                             char *label_name, char label_type)
+{
+    label_cache_data *label;
+
+    if (IS_AG_DEFAULT_LABEL(label_name))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("cannot load into a default label")));
+    }
+
+    if (!label_exists(label_name, graph_oid))
+    {
+        char *parent_name;
+        RangeVar *parent;
+
+        parent_name = (label_type == LABEL_TYPE_VERTEX ?
+                           AG_DEFAULT_LABEL_VERTEX :
+                           AG_DEFAULT_LABEL_EDGE);
+        parent = get_label_range_var(graph_name, graph_oid, parent_name);
+
+        create_label(graph_name, label_name, label_type, list_make1(parent));
+    }
+
+    label = search_label_name_graph_cache(label_name, graph_oid);
+    Assert(label);
+
+    if (label->kind != label_type)
+    {
+        if (label_type == LABEL_TYPE_VERTEX)
+        {
+            ereport(ERROR, (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+                            errmsg("label \"%s\" is not a vertex label",
+                                   label_name)));
+        }
+        else
+        {
+            ereport(ERROR, (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+                            errmsg("label \"%s\" is not an edge label",
+                                   label_name)));
+        }
+    }
+
+    if (pg_class_aclcheck(label->relation, GetUserId(), ACL_INSERT) !=
+        ACLCHECK_OK)
+    {
+        aclcheck_error(ACLCHECK_NO_PRIV, OBJECT_TABLE,
+                       get_rel_name(label->relation));
+    }
+
+    return label;
+}
+
+// the sequence of a label is owned by the id column of its table
+static Oid get_label_seq_relid(label_cache_data *label)
+{
+    List *seqs;
+
+    seqs = getOwnedSequences(label->relation, Anum_ag_label_vertex_table_id);
+    if (list_length(seqs) != 1)
+    {
+        ereport(ERROR, (errcode(ERRCODE_UNDEFINED_OBJECT),
+                        errmsg("sequence for label \"%s\" does not exist",
+                               NameStr(label->name))));
+    }
+
+    return linitial_oid(seqs);
+}
+
+/*
+ * Locks the sequence of a label against nextval() and setval() in other
+ * backends until the end of the transaction, and returns its last value.
+ *
+ * Other backends may still hold cached blocks of the sequence, but none of
+ * their ids are above the last value, so ids above it are safe to load. They
+ * stay safe because no backend can take a new block until the sequence has
+ * been advanced past them and the transaction has ended.
+ */
+static int64 lock_label_seq(Oid seq_relid)
+{
+    FunctionCallInfoData locfcinfo;
+    Datum last_value;
+
+    LockRelationOid(seq_relid, ExclusiveLock);
+
+    InitFunctionCallInfoData(locfcinfo, NULL, 1, InvalidOid, NULL, NULL);
+    locfcinfo.arg[0] = ObjectIdGetDatum(seq_relid);
+    locfcinfo.argnull[0] = false;
+    last_value = pg_sequence_last_value(&locfcinfo);
+
+    // the sequence has not handed out any id yet
+    if (locfcinfo.isnull)
+        return 0;
+
+    return DatumGetInt64(last_value);
+}
+
+static void csv_open(csv_reader *reader, char *path)
+{
+    if (!is_absolute_path(path))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_NAME),
+                        errmsg("relative path not allowed for loading a graph")));
+    }
+
+    reader->file = AllocateFile(path, PG_BINARY_R);
+    if (!reader->file)
+    {
+        ereport(ERROR, (errcode_for_file_access(),
+                        errmsg("could not open file \"%s\" for reading: %m",
+                               path)));
+    }
+
+    reader->path = path;
+    reader->line_no = 0;
+    reader->next_line_no = 1;
+    initStringInfo(&reader->buf);
+    reader->fields = NIL;
+    reader->quoted = NIL;
+}
+
+static void csv_close(csv_reader *reader)
+{
+    if (FreeFile(reader->file))
+    {
+        ereport(ERROR, (errcode_for_file_access(),
+                        errmsg("could not close file \"%s\": %m",
+                               reader->path)));
+    }
+}
+
+/*
+ * Reads the next record into reader->fields. Fields are separated by commas
+ * and may be enclosed in double quotes, in which case they can contain commas,
+ * line breaks, and doubled double quotes. Empty lines are skipped. Returns
+ * false at the end of the file.
+ *
+ * Fields are allocated in the current memory context.
+ */
+static bool csv_read_record(csv_reader *reader)
+{
+    bool in_quotes = false;
+    bool quoted = false;
+    bool empty = true;
+
+    reader->fields = NIL;
+    reader->quoted = NIL;
+    reader->line_no = reader->next_line_no;
+    resetStringInfo(&reader->buf);
+
+    for (;;)
+    {
+        int c = getc(reader->file);
+
+        if (c == EOF)
+        {
+            if (ferror(reader->file))
+            {
+                ereport(ERROR, (errcode_for_file_access(),
+                                errmsg("could not read file \"%s\": %m",
+                                       reader->path)));
+            }
+            if (in_quotes)
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                         errmsg("unterminated quoted field in file \"%s\" at line "
+                                INT64_FORMAT, reader->path, reader->line_no)));
+            }
+            if (empty)
+                return false;
+
+            csv_end_field(reader, quoted);
+            return true;
+        }
+
+        if (in_quotes)
+        {
+            if (c == '"')
+            {
+                c = getc(reader->file);
+                if (c == '"')
+                {
+                    appendStringInfoCharMacro(&reader->buf, '"');
+                }
+                else
+                {
+                    in_quotes = false;
+                    if (c != EOF)
+                        ungetc(c, reader->file);
+                }
+            }
+            else
+            {
+                if (c == '\n')
+                    reader->next_line_no++;
+                appendStringInfoCharMacro(&reader->buf, c);
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+        case '\r':
+            // CRLF line endings
+            break;
+        case '\n':
+            reader->next_line_no++;
+            if (empty)
+            {
+                reader->line_no = reader->next_line_no;
+                break;
+            }
+            csv_end_field(reader, quoted);
+            return true;
+        case ',':
+            empty = false;
+            csv_end_field(reader, quoted);
+            quoted = false;
+            break;
+        case '"':
+            empty = false;
+            if (reader->buf.len == 0 && !quoted)
+            {
+                in_quotes = true;
+                quoted = true;
+            }
+            else
+            {
+                appendStringInfoCharMacro(&reader->buf, c);
+            }
+            break;
+        default:
+            empty = false;
+            appendStringInfoCharMacro(&reader->buf, c);
+            break;
+        }
+    }
+}
+
+static void csv_end_field(csv_reader *reader, bool quoted)
+{
+    reader->fields = lappend(reader->fields,
+                             pnstrdup(reader->buf.data, reader->buf.len));
+    reader->quoted = lappend_int(reader->quoted, quoted);
+    resetStringInfo(&reader->buf);
+}
+
+static void csv_check_num_fields(csv_reader *reader, int expected)
+{
+    int num_fields = list_length(reader->fields);
+
+    if (num_fields != expected)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+                 errmsg("line " INT64_FORMAT " of file \"%s\" has %d fields, expected %d",
+                        reader->line_no, reader->path, num_fields,
+                        expected)));
+    }
+}
+
+static char *csv_field(csv_reader *reader, int n, bool *quoted)
+{
+    if (quoted)
+        *quoted = list_nth_int(reader->quoted, n);
+
+    return list_nth(reader->fields, n);
+}
+
+static int64 csv_int8_field(csv_reader *reader, int n, const char *name)
+{
+    char *str = csv_field(reader, n, NULL);
+    int64 result;
+
+    if (!scanint8(str, true, &result))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid integer value \"%s\" for column \"%s\"", str,
+                        name),
+                 errcontext("file \"%s\", line " INT64_FORMAT, reader->path,
+                            reader->line_no)));
+    }
+
+    return result;
+}
+
+// builds a map from the header names to the fields starting at `first`
+static agtype *build_properties(csv_reader *reader, List *header, int first)
+{
+    agtype_parse_state *parse_state = NULL;
+    agtype_value *result;
+    int num_fields = list_length(reader->fields);
+    int i;
+
+    result = push_agtype_value(&parse_state, WAGT_BEGIN_OBJECT, NULL);
+
+    for (i = first; i < num_fields; i++)
+    {
+        char *key = list_nth(header, i);
+        bool quoted;
+        char *str = csv_field(reader, i, &quoted);
+        agtype_value key_val;
+        agtype_value val;
+
+        // an empty field means that the property does not exist
+        if (!quoted && str[0] == '\0')
+            continue;
+
+        key_val.type = AGTV_STRING;
+        key_val.val.string.len = strlen(key);
+        key_val.val.string.val = key;
+
+        infer_agtype_value(str, quoted, &val);
+
+        push_agtype_value(&parse_state, WAGT_KEY, &key_val);
+        push_agtype_value(&parse_state, WAGT_VALUE, &val);
+    }
+
+    result = push_agtype_value(&parse_state, WAGT_END_OBJECT, NULL);
+
+    return agtype_value_to_agtype(result);
+}
+
+/*
+ * Unquoted integers, floats, and booleans are stored as such. Anything else,
+ * including every quoted field, is stored as a string.
+ */
+static void infer_agtype_value(char *str, bool quoted, agtype_value *val)
+{
+    if (!quoted)
+    {
+        int64 i;
+        double f;
+        char *end;
+
+        if (scanint8(str, true, &i))
+        {
+            val->type = AGTV_INTEGER;
+            val->val.int_value = i;
+            return;
+        }
+
+        if (strcmp(str, "true") == 0 || strcmp(str, "false") == 0)
+        {
+            val->type = AGTV_BOOL;
+            val->val.boolean = (str[0] == 't');
+            return;
+        }
+
+        // accept only decimal notation (no "NaN", "Infinity", or hex)
+        if (strspn(str, "+-0123456789.eE") == strlen(str) &&
+            strpbrk(str, "0123456789"))
+        {
+            errno = 0;
+            f = strtod(str, &end);
+            if (*end == '\0' && errno == 0 && isfinite(f))
+            {
+                val->type = AGTV_FLOAT;
+                val->val.float_value = f;
+                return;
+            }
+        }
+    }
+
+    val->type = AGTV_STRING;
+    val->val.string.len = strlen(str);
+    val->val.string.val = str;
+}
+
+static void label_loader_begin(label_loader *loader, Oid relid)
+{
+    ResultRelInfo *resultRelInfo;
+
+    loader->rel = heap_open(relid, RowExclusiveLock);
+
+    loader->estate = CreateExecutorState();
+
+    resultRelInfo = makeNode(ResultRelInfo);
+    InitResultRelInfo(resultRelInfo, loader->rel, 1, NULL, 0);
+    ExecOpenIndices(resultRelInfo, false);
+
+    loader->resultRelInfo = resultRelInfo;
+    loader->estate->es_result_relations = resultRelInfo;
+    loader->estate->es_num_result_relations = 1;
+    loader->estate->es_result_relation_info = resultRelInfo;
+
+    loader->slot = ExecInitExtraTupleSlot(loader->estate,
+                                          RelationGetDescr(loader->rel));
+    loader->bistate = GetBulkInsertState();
+    loader->cid = GetCurrentCommandId(true);
+
+    loader->batch_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+                                               "label loader batch",
+                                               ALLOCSET_DEFAULT_SIZES);
+    loader->num_tuples = 0;
+}
+
+/*
+ * The values must be allocated in loader->batch_mcxt because they are kept
+ * until the batch is flushed.
+ */
+static void label_loader_insert(label_loader *loader, Datum *values,
+                                bool *nulls)
+{
+    MemoryContext old_mcxt;
+    HeapTuple tuple;
+
+    old_mcxt = MemoryContextSwitchTo(loader->batch_mcxt);
+    tuple = heap_form_tuple(RelationGetDescr(loader->rel), values, nulls);
+    MemoryContextSwitchTo(old_mcxt);
+
+    ExecStoreTuple(tuple, loader->slot, InvalidBuffer, false);
+    if (loader->rel->rd_att->constr)
+        ExecConstraints(loader->resultRelInfo, loader->slot, loader->estate);
+
+    loader->tuples[loader->num_tuples++] = tuple;
+    if (loader->num_tuples == LOAD_BATCH_SIZE)
+        label_loader_flush(loader);
+}
+
+static void label_loader_flush(label_loader *loader)
+{
+    int i;
+
+    if (loader->num_tuples == 0)
+        return;
+
+    heap_multi_insert(loader->rel, loader->tuples, loader->num_tuples,
+                      loader->cid, 0, loader->bistate);
+
+    if (loader->resultRelInfo->ri_NumIndices > 0)
+    {
+        for (i = 0; i < loader->num_tuples; i++)
+        {
+            List *recheck;
+
+            ExecStoreTuple(loader->tuples[i], loader->slot, InvalidBuffer,
+                           false);
+            recheck = ExecInsertIndexTuples(loader->slot,
+                                            &loader->tuples[i]->t_self,
+                                            loader->estate, false, NULL, NIL);
+            list_free(recheck);
+        }
+    }
+
+    ExecClearTuple(loader->slot);
+    ResetPerTupleExprContext(loader->estate);
+    MemoryContextReset(loader->batch_mcxt);
+    loader->num_tuples = 0;
+
+    CHECK_FOR_INTERRUPTS();
+}
+
+static void label_loader_end(label_loader *loader)
+{
+    label_loader_flush(loader);
+
+    FreeBulkInsertState(loader->bistate);
+    ExecCloseIndices(loader->resultRelInfo);
+    ExecResetTupleTable(loader->estate->es_tupleTable, false);
+    FreeExecutorState(loader->estate);
+    MemoryContextDelete(loader->batch_mcxt);
+
+    heap_close(loader->rel, RowExclusiveLock);
+}
@@ -19,6 +19,8 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/xact.h"
 #include "executor/tuptable.h"
@@ -28,6 +30,7 @@
 #include "nodes/plannodes.h"
 #include "parser/parse_relation.h"
 #include "rewrite/rewriteHandler.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/tqual.h"
 
@@ -45,16 +48,37 @@ static TupleTableSlot *exec_cypher_create(CustomScanState *node);
 static void end_cypher_create(CustomScanState *node);
 static void rescan_cypher_create(CustomScanState *node);
 
+/*
+ * Terminal CREATE clauses buffer the tuples of the new entities, and insert
+ * them into their label tables in batches with heap_multi_insert(), the way
+ * COPY does. Nothing reads the new tuples before the clause ends, because the
+ * clauses before it run with a command id that cannot see them.
+ */
+#define MAX_BUFFERED_TUPLES 1000
+#define MAX_BUFFERED_BYTES 65535
+
+typedef struct entity_insert_buffer
+{
+    ResultRelInfo *resultRelInfo;
+    TupleTableSlot *slot;
+    BulkInsertState bistate;
+    int num_tuples;
+    HeapTuple tuples[MAX_BUFFERED_TUPLES];
+} entity_insert_buffer;
+
 static void create_edge(cypher_create_custom_scan_state *css,
                         cypher_target_node *node, Datum prev_vertex_id,
                         ListCell *next);
 
 static Datum create_vertex(cypher_create_custom_scan_state *css,
                            cypher_target_node *node, ListCell *next);
-static HeapTuple insert_entity_tuple(ResultRelInfo *resultRelInfo,
-                                TupleTableSlot *elemTupleSlot, EState *estate);
+static HeapTuple buffer_entity_tuple(cypher_create_custom_scan_state *css,
+                                     ResultRelInfo *resultRelInfo,
+                                     TupleTableSlot *elemTupleSlot);
+static void flush_entity_buffers(cypher_create_custom_scan_state *css);
 static void process_pattern(cypher_create_custom_scan_state *css);
-static bool entity_exists(EState *estate, Oid graph_oid, graphid id);
+static entity_source *find_vertex_source(cypher_create_custom_scan_state *css,
+                                        char *var_name);
 
 const CustomExecMethods cypher_create_exec_methods = {CREATE_SCAN_STATE_NAME,
                                                       begin_cypher_create,
@@ -106,7 +130,18 @@ static void begin_cypher_create(CustomScanState *node, EState *estate,
             Relation rel;
 
             if (!CYPHER_TARGET_NODE_INSERT_ENTITY(cypher_node->flags))
+            {
+                // the vertex could be deleted, see create_vertex()
+                if (!SAFE_TO_SKIP_EXISTENCE_CHECK(cypher_node->flags) &&
+                    CYPHER_CLAUSE_HAS_PREVIOUS_DELETE(css->flags))
+                {
+                    css->vertex_sources = lappend(
+                        css->vertex_sources,
+                        resolve_entity_source(node,
+                                              cypher_node->variable_name));
+                }
                 continue;
+            }
 
             // Open relation and aquire a row exclusive lock.
             rel = heap_open(cypher_node->relid, RowExclusiveLock);
@@ -130,9 +165,30 @@ static void begin_cypher_create(CustomScanState *node, EState *estate,
                 cypher_node->id_expr_state =
                     ExecInitExpr(cypher_node->id_expr, (PlanState *)node);
             }
+
+            if (CYPHER_CLAUSE_IS_TERMINAL(css->flags))
+            {
+                entity_insert_buffer *buffer;
+
+                buffer = palloc0(sizeof(entity_insert_buffer));
+                buffer->resultRelInfo = cypher_node->resultRelInfo;
+                buffer->slot = cypher_node->elemTupleSlot;
+                buffer->bistate = GetBulkInsertState();
+
+                css->insert_buffers = lappend(css->insert_buffers, buffer);
+            }
         }
     }
 
+    if (CYPHER_CLAUSE_IS_TERMINAL(css->flags))
+    {
+        css->insert_buffer_mcxt = AllocSetContextCreate(
+            estate->es_query_cxt, "cypher create insert buffer",
+            ALLOCSET_DEFAULT_SIZES);
+        css->num_buffered_tuples = 0;
+        css->buffered_bytes = 0;
+    }
+
     /*
      * Postgres does not assign the es_output_cid in queries that do
      * not write to disk, ie: SELECT commands. We need the command id
@@ -225,8 +281,18 @@ static TupleTableSlot *exec_cypher_create(CustomScanState *node)
             css->tuple_info = NIL;
 
             process_pattern(css);
+
+            /*
+             * Flush between rows only, so that the tuples of the current row
+             * stay valid while its pattern is processed.
+             */
+            if (css->num_buffered_tuples >= MAX_BUFFERED_TUPLES ||
+                css->buffered_bytes >= MAX_BUFFERED_BYTES)
+                flush_entity_buffers(css);
         }
 
+        flush_entity_buffers(css);
+
         return NULL;
     }
     else
@@ -262,6 +328,13 @@ static void end_cypher_create(CustomScanState *node)
 
     ExecEndNode(node->ss.ps.lefttree);
 
+    foreach (lc, css->insert_buffers)
+    {
+        entity_insert_buffer *buffer = lfirst(lc);
+
+        FreeBulkInsertState(buffer->bistate);
+    }
+
     foreach (lc, css->pattern)
     {
         cypher_create_path *path = lfirst(lc);
@@ -272,7 +345,18 @@ static void end_cypher_create(CustomScanState *node)
                 (cypher_target_node *)lfirst(lc2);
 
             if (!CYPHER_TARGET_NODE_INSERT_ENTITY(cypher_node->flags))
+            {
+                // the vertex could be deleted, see create_vertex()
+                if (!SAFE_TO_SKIP_EXISTENCE_CHECK(cypher_node->flags) &&
+                    CYPHER_CLAUSE_HAS_PREVIOUS_DELETE(css->flags))
+                {
+                    css->vertex_sources = lappend(
+                        css->vertex_sources,
+                        resolve_entity_source(node,
+                                              cypher_node->variable_name));
+                }
                 continue;
+            }
 
             // close all indices for the node
             ExecCloseIndices(cypher_node->resultRelInfo);
@@ -400,7 +484,10 @@ static void create_edge(cypher_create_custom_scan_state *css,
         scanTupleSlot->tts_isnull[node->prop_attr_num];
 
     // Insert the new edge
-    tuple = insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
+    if (css->insert_buffers != NIL)
+        tuple = buffer_entity_tuple(css, resultRelInfo, elemTupleSlot);
+    else
+        tuple = insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
 
     if (node->variable_name != NULL)
         css->tuple_info = add_tuple_info(css->tuple_info, tuple, node->variable_name);
@@ -482,7 +569,10 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
             scanTupleSlot->tts_isnull[node->prop_attr_num];
 
         // Insert the new vertex
-        tuple = insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
+        if (css->insert_buffers != NIL)
+            tuple = buffer_entity_tuple(css, resultRelInfo, elemTupleSlot);
+        else
+            tuple = insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
 
         /*
          * If this vertex is a variable store the newly created tuple in
@@ -575,13 +665,16 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
          * the vertex's current status relative to this CREATE clause. If the variable
          * was initially created in this clause, we can skip this check, because the
          * transaction system guarantees that nothing can happen to that tuple, as
-         * far as we are concerned with at this time.
+         * far as we are concerned with at this time. Likewise, if none of the
+         * previous clauses deletes, the vertex is still there.
          */
-        if (!SAFE_TO_SKIP_EXISTENCE_CHECK(node->flags))
+        if (!SAFE_TO_SKIP_EXISTENCE_CHECK(node->flags) &&
+            CYPHER_CLAUSE_HAS_PREVIOUS_DELETE(css->flags))
         {
             bool is_deleted = false;
 
-            get_heap_tuple(&css->css, node->variable_name, &is_deleted);
+            get_entity_heap_tuple(find_vertex_source(css, node->variable_name),
+                                  &is_deleted);
 
             if (is_deleted || !entity_exists(estate, css->graph_oid, DATUM_GET_GRAPHID(id)))
                 ereport(ERROR,
@@ -605,72 +698,114 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
     return id;
 }
 
+// find the entity_source resolved for the bound vertex in begin_cypher_create()
+static entity_source *find_vertex_source(cypher_create_custom_scan_state *css,
+                                        char *var_name)
+{
+    ListCell *lc;
+
+    foreach (lc, css->vertex_sources)
+    {
+        entity_source *source = lfirst(lc);
+
+        if (strcmp(source->var_name, var_name) == 0)
+            return source;
+    }
+
+    ereport(ERROR, (errmsg_internal("vertex %s has no entity source",
+                                    var_name)));
+    return NULL;
+}
+
 /*
- * Find out if the entity still exists. This is for 'implicit' deletion
- * of an entity.
+ * Check the constraints of the edge/vertex tuple and add a copy of it to the
+ * insert buffer of its table. The buffers are flushed by the caller.
  */
-static bool entity_exists(EState *estate, Oid graph_oid, graphid id)
+static HeapTuple buffer_entity_tuple(cypher_create_custom_scan_state *css,
+                                     ResultRelInfo *resultRelInfo,
+                                     TupleTableSlot *elemTupleSlot)
 {
-    label_cache_data *label;
-    ScanKeyData scan_keys[1];
-    HeapScanDesc scan_desc;
+    EState *estate = css->css.ss.ps.state;
+    entity_insert_buffer *buffer = NULL;
+    MemoryContext old_mctx;
     HeapTuple tuple;
-    Relation rel;
-    bool result = true;
+    ListCell *lc;
 
-    /*
-     * Extract the label id from the graph id and get the table name
-     * the entity is part of.
-     */
-    label = search_label_graph_id_cache(graph_oid, GET_LABEL_ID(id));
+    foreach (lc, css->insert_buffers)
+    {
+        buffer = lfirst(lc);
+
+        if (buffer->resultRelInfo == resultRelInfo)
+            break;
+    }
+    Assert(buffer != NULL && buffer->resultRelInfo == resultRelInfo);
+    // each table gets at most one tuple per row, see exec_cypher_create()
+    Assert(buffer->num_tuples < MAX_BUFFERED_TUPLES);
 
-    // Setup the scan key to be the graphid
-    ScanKeyInit(&scan_keys[0], 1, BTEqualStrategyNumber,
-                F_GRAPHIDEQ, GRAPHID_GET_DATUM(id));
+    ExecStoreVirtualTuple(elemTupleSlot);
 
-    rel = heap_open(label->relation, RowExclusiveLock);
-    scan_desc = heap_beginscan(rel, estate->es_snapshot, 1, scan_keys);
+    // Check the constraints of the tuple
+    if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
+        ExecConstraints(resultRelInfo, elemTupleSlot, estate);
 
-    tuple = heap_getnext(scan_desc, ForwardScanDirection);
+    old_mctx = MemoryContextSwitchTo(css->insert_buffer_mcxt);
+    tuple = ExecCopySlotTuple(elemTupleSlot);
+    MemoryContextSwitchTo(old_mctx);
 
-    /*
-     * If a single tuple was returned, the tuple is still valid, otherwise'
-     * set to false.
-     */
-    if (!HeapTupleIsValid(tuple))
-        result = false;
+    tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
 
-    heap_endscan(scan_desc);
-    heap_close(rel, RowExclusiveLock);
+    buffer->tuples[buffer->num_tuples++] = tuple;
+    css->num_buffered_tuples++;
+    css->buffered_bytes += tuple->t_len;
 
-    return result;
+    return tuple;
 }
 
 /*
- * Insert the edge/vertex tuple into the table and indices. If the table's
- * constraints have not been violated.
+ * Insert the buffered tuples into their tables and indices.
  */
-static HeapTuple insert_entity_tuple(ResultRelInfo *resultRelInfo,
-                                      TupleTableSlot *elemTupleSlot, EState *estate)
+static void flush_entity_buffers(cypher_create_custom_scan_state *css)
 {
-    HeapTuple tuple;
+    EState *estate = css->css.ss.ps.state;
+    ListCell *lc;
 
-    ExecStoreVirtualTuple(elemTupleSlot);
-    tuple = ExecMaterializeSlot(elemTupleSlot);
+    if (css->num_buffered_tuples == 0)
+        return;
 
-    // Check the constraints of the tuple
-    tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
-    if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
-        ExecConstraints(resultRelInfo, elemTupleSlot, estate);
+    foreach (lc, css->insert_buffers)
+    {
+        entity_insert_buffer *buffer = lfirst(lc);
+        ResultRelInfo *resultRelInfo = buffer->resultRelInfo;
+        int i;
 
-    // Insert the tuple normally
-    heap_insert(resultRelInfo->ri_RelationDesc, tuple, estate->es_output_cid,
-                0, NULL);
+        if (buffer->num_tuples == 0)
+            continue;
 
-    // Insert index entries for the tuple
-    if (resultRelInfo->ri_NumIndices > 0)
-        ExecInsertIndexTuples(elemTupleSlot, &(tuple->t_self), estate, false,
-                              NULL, NIL);
+        heap_multi_insert(resultRelInfo->ri_RelationDesc, buffer->tuples,
+                          buffer->num_tuples, estate->es_output_cid, 0,
+                          buffer->bistate);
 
-    return tuple;
+        // Insert index entries for the tuples
+        if (resultRelInfo->ri_NumIndices > 0)
+        {
+            estate->es_result_relation_info = resultRelInfo;
+
+            for (i = 0; i < buffer->num_tuples; i++)
+            {
+                ExecStoreTuple(buffer->tuples[i], buffer->slot, InvalidBuffer,
+                               false);
+                ExecInsertIndexTuples(buffer->slot,
+                                      &(buffer->tuples[i]->t_self), estate,
+                                      false, NULL, NIL);
+            }
+
+            ExecClearTuple(buffer->slot);
+        }
+
+        buffer->num_tuples = 0;
+    }
+
+    MemoryContextReset(css->insert_buffer_mcxt);
+    css->num_buffered_tuples = 0;
+    css->buffered_bytes = 0;
 }
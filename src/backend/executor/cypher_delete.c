@@ -19,6 +19,8 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "access/sysattr.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
@@ -32,6 +34,7 @@
 #include "parser/parsetree.h"
 #include "parser/parse_relation.h"
 #include "rewrite/rewriteHandler.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/tqual.h"
 
@@ -44,6 +47,14 @@
 #include "utils/agtype.h"
 #include "utils/graphid.h"
 
+// The start_id and end_id indexes of an edge label, InvalidOid if missing
+typedef struct edge_label_indexes_entry
+{
+    NameData label_name; // hash key
+    Oid start_id_index;
+    Oid end_id_index;
+} edge_label_indexes_entry;
+
 static void begin_cypher_delete(CustomScanState *node, EState *estate,
                                 int eflags);
 static TupleTableSlot *exec_cypher_delete(CustomScanState *node);
@@ -54,10 +65,40 @@ static void process_delete_list(CustomScanState *node);
 
 static void find_connected_edges(CustomScanState *node, char *graph_name, List *labels,
                                  char *var_name, graphid id, bool detach_delete);
+static void find_connected_edges_batch(CustomScanState *node);
+static edge_label_indexes_entry *get_edge_label_indexes(
+    CustomScanState *node, char *label_name, Relation rel);
+static void process_connected_edges_by_index(CustomScanState *node,
+                                             ResultRelInfo *resultRelInfo,
+                                             Oid index_oid, bool end_id_probe,
+                                             char *var_name, graphid id,
+                                             bool detach_delete);
+static void process_connected_edges_by_scan(CustomScanState *node,
+                                            ResultRelInfo *resultRelInfo,
+                                            char *var_name, graphid id,
+                                            bool detach_delete);
+static void process_connected_edges_by_batch_scan(CustomScanState *node,
+                                                  ResultRelInfo *resultRelInfo,
+                                                  bool detach_delete);
+static void process_connected_edge(CustomScanState *node,
+                                   ResultRelInfo *resultRelInfo, HeapTuple tuple,
+                                   char *var_name, bool detach_delete);
 static agtype_value *extract_entity(CustomScanState *node, TupleTableSlot *scanTupleSlot,
                                     int entity_position);
 static void delete_entity(CustomScanState *node, char *graph_name,
                           char *label_name, HeapTuple tuple);
+static void delete_tuple(CustomScanState *node, ResultRelInfo *resultRelInfo,
+                         HeapTuple tuple);
+
+/*
+ * Entry of the set of vertices deleted by a terminal DELETE clause, the
+ * edges attached to them are processed once all the vertices are known.
+ */
+typedef struct deleted_vertex_entry
+{
+    graphid id; // hash key
+    char *var_name;
+} deleted_vertex_entry;
 
 const CustomExecMethods cypher_delete_exec_methods = {DELETE_SCAN_STATE_NAME,
                                                       begin_cypher_delete,
@@ -85,6 +126,8 @@ static void begin_cypher_delete(CustomScanState *node, EState *estate,
     cypher_delete_custom_scan_state *css =
         (cypher_delete_custom_scan_state *)node;
     Plan *subplan;
+    ListCell *lc;
+    int i;
 
     Assert(list_length(css->cs->custom_plans) == 1);
 
@@ -106,12 +149,47 @@ static void begin_cypher_delete(CustomScanState *node, EState *estate,
         ExecAssignProjectionInfo(&node->ss.ps, tupdesc);
     }
 
+    // find where the tuples of the deleted variables come from
+    css->item_sources = palloc(sizeof(entity_source *) *
+                               list_length(css->delete_data->delete_items));
+    i = 0;
+    foreach (lc, css->delete_data->delete_items)
+    {
+        cypher_delete_item *item = lfirst(lc);
+
+        css->item_sources[i++] = resolve_entity_source(node, item->var_name);
+    }
+
+    css->tuple_info_mcxt = AllocSetContextCreate(estate->es_query_cxt,
+                                                 "cypher delete tuple info",
+                                                 ALLOCSET_DEFAULT_SIZES);
+
     /*
      *  Get all the labels that are visible to this delete clause at this point
      *  in the transaction. To be used later when the delete clause finds vertices.
      */
     css->edge_labels = get_all_edge_labels_per_graph(estate, css->delete_data->graph_oid);
 
+    /*
+     * A terminal DELETE clause does not pass its tuples on to another
+     * clause, so the edges attached to the deleted vertices can be handled
+     * after the whole subtree has been processed. Collect the ids of the
+     * vertices, so each edge label only needs to be visited once.
+     */
+    if (CYPHER_CLAUSE_IS_TERMINAL(css->flags))
+    {
+        HASHCTL hash_ctl;
+
+        MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+        hash_ctl.keysize = sizeof(graphid);
+        hash_ctl.entrysize = sizeof(deleted_vertex_entry);
+        hash_ctl.hcxt = estate->es_query_cxt;
+
+        css->deleted_vertices = hash_create("cypher DELETE vertex set", 1024,
+                                            &hash_ctl,
+                                            HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+    }
+
     /*
      * Postgres does not assign the es_output_cid in queries that do
      * not write to disk, ie: SELECT commands. We need the command id
@@ -161,11 +239,14 @@ static TupleTableSlot *exec_cypher_delete(CustomScanState *node)
             econtext->ecxt_scantuple =
                 node->ss.ps.lefttree->ps_ProjInfo->pi_exprContext->ecxt_scantuple;
 
+            MemoryContextReset(css->tuple_info_mcxt);
             css->tuple_info = NIL;
 
             process_delete_list(node);
         }
 
+        find_connected_edges_batch(node);
+
         return NULL;
     }
     else
@@ -182,6 +263,7 @@ static TupleTableSlot *exec_cypher_delete(CustomScanState *node)
         econtext->ecxt_scantuple =
             node->ss.ps.lefttree->ps_ProjInfo->pi_exprContext->ecxt_scantuple;
 
+        MemoryContextReset(css->tuple_info_mcxt);
         css->tuple_info = NIL;
 
         process_delete_list(node);
@@ -194,11 +276,29 @@ static TupleTableSlot *exec_cypher_delete(CustomScanState *node)
 }
 
 /*
- * Called at the end of execution. Tell its child to
- * end its execution.
+ * Called at the end of execution. Close the label tables and tell its child
+ * to end its execution.
  */
 static void end_cypher_delete(CustomScanState *node)
 {
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+
+    if (css->deleted_vertices)
+    {
+        hash_destroy(css->deleted_vertices);
+        css->deleted_vertices = NULL;
+    }
+
+    if (css->edge_label_indexes)
+    {
+        hash_destroy(css->edge_label_indexes);
+        css->edge_label_indexes = NULL;
+    }
+
+    close_entity_result_rel_infos(css->result_rel_infos);
+    css->result_rel_infos = NULL;
+
     ExecEndNode(node->ss.ps.lefttree);
 }
 
@@ -285,16 +385,31 @@ static void delete_entity(CustomScanState *node, char *graph_name,
     cypher_delete_custom_scan_state *css =
         (cypher_delete_custom_scan_state *)node;
     EState *estate = css->css.ss.ps.state;
-    ResultRelInfo *resultRelInfo, *saved_resultRelInfo;
+    entity_result_rel_info_entry *entry;
+
+    entry = get_entity_result_rel_info(&css->result_rel_infos, estate,
+                                       graph_name, label_name);
+
+    delete_tuple(node, entry->resultRelInfo, tuple);
+}
+
+/*
+ * Delete the HeapTuple from the already opened table described by
+ * resultRelInfo.
+ */
+static void delete_tuple(CustomScanState *node, ResultRelInfo *resultRelInfo,
+                         HeapTuple tuple)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    ResultRelInfo *saved_resultRelInfo;
     LockTupleMode lockmode;
     HeapUpdateFailureData hufd;
     HTSU_Result lock_result;
     HTSU_Result delete_result;
     Buffer buffer;
 
-    resultRelInfo = create_entity_result_rel_info(estate, graph_name, label_name);
-    ExecOpenIndices(resultRelInfo, false);
-
     // Find the physical tuple, this variable is coming from
     saved_resultRelInfo = estate->es_result_relation_info;
     estate->es_result_relation_info = resultRelInfo;
@@ -352,9 +467,6 @@ static void delete_entity(CustomScanState *node, char *graph_name,
     ReleaseBuffer(buffer);
 
     estate->es_result_relation_info = saved_resultRelInfo;
-
-    ExecCloseIndices(resultRelInfo);
-    heap_close(resultRelInfo->ri_RelationDesc, RowExclusiveLock);
 }
 
 /*
@@ -368,6 +480,8 @@ static void process_delete_list(CustomScanState *node)
     ListCell *lc;
     ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
     TupleTableSlot *scanTupleSlot = econtext->ecxt_scantuple;
+    int item_index = -1;
+    MemoryContext old_mcxt;
 
     foreach(lc, css->delete_data->delete_items)
     {
@@ -380,6 +494,7 @@ static void process_delete_list(CustomScanState *node)
         bool is_deleted;
 
         item = lfirst(lc);
+        item_index++;
 
         pos = item->entity_position;
         entity_position = pos->val.ival;
@@ -392,7 +507,8 @@ static void process_delete_list(CustomScanState *node)
          * find the where the entity came from, if the tuple was deleted
          * by a previous DELETE clause its safe to skip this tuple
          */
-        heap_tuple = get_heap_tuple(node, item->var_name, &is_deleted);
+        heap_tuple = get_entity_heap_tuple(css->item_sources[item_index],
+                                           &is_deleted);
         if (is_deleted || heap_tuple == NULL)
             continue;
 
@@ -408,8 +524,30 @@ static void process_delete_list(CustomScanState *node)
          * on if the query specified the DETACH option.
          */
         if (original_entity_value->type == AGTV_VERTEX)
-            find_connected_edges(node, css->delete_data->graph_name, css->edge_labels,
-                                 item->var_name, id->val.int_value, css->delete_data->detach);
+        {
+            /*
+             * A terminal DELETE clause postpones this until every vertex
+             * it deletes is known, see find_connected_edges_batch().
+             */
+            if (css->deleted_vertices)
+            {
+                deleted_vertex_entry *entry;
+                graphid vertex_id = id->val.int_value;
+                bool found;
+
+                entry = hash_search(css->deleted_vertices, &vertex_id,
+                                    HASH_ENTER, &found);
+                if (!found)
+                    entry->var_name = item->var_name;
+            }
+            else
+            {
+                find_connected_edges(node, css->delete_data->graph_name,
+                                     css->edge_labels, item->var_name,
+                                     id->val.int_value,
+                                     css->delete_data->detach);
+            }
+        }
 
         /*
          * At this point, we are ready to delete the node/vertex.
@@ -420,7 +558,9 @@ static void process_delete_list(CustomScanState *node)
          * Add the deleted tuple to the custom scan state's info on updated
          * tuples.
          */
+        old_mcxt = MemoryContextSwitchTo(css->tuple_info_mcxt);
         css->tuple_info = add_tuple_info(css->tuple_info, heap_tuple, item->var_name);
+        MemoryContextSwitchTo(old_mcxt);
     }
 }
 
@@ -439,66 +579,301 @@ static void find_connected_edges(CustomScanState *node, char *graph_name, List *
     Increment_Estate_CommandId(estate);
 
     /*
-     * We need to scan through all the edges to see if this vertex has
-     * any edges attached to it.
-     *
-     * XXX: If we implement an on-disc graph storage system. Such as
-     * an adjacency matrix, the performace of this check can be massively
-     * improved. However, right now we have to scan every edge to see if
-     * one has this vertex as a start or end vertex.
+     * Edge labels are indexed on their start_id and end_id columns, so the
+     * edges attached to this vertex can be found with two index scans per
+     * label. If a label is missing one of the indexes, scan every edge of
+     * that label to see if one has this vertex as a start or end vertex.
      */
     foreach(lc, labels)
     {
         char *label_name = lfirst(lc);
         ResultRelInfo *resultRelInfo;
-        HeapScanDesc scan_desc;
-        HeapTuple tuple;
-        TupleTableSlot *slot;
+        edge_label_indexes_entry *indexes;
 
-        resultRelInfo = create_entity_result_rel_info(estate, graph_name, label_name);
+        resultRelInfo = get_entity_result_rel_info(&css->result_rel_infos,
+                                                   estate, graph_name,
+                                                   label_name)->resultRelInfo;
+        indexes = get_edge_label_indexes(node, label_name,
+                                         resultRelInfo->ri_RelationDesc);
 
-        scan_desc = heap_beginscan(resultRelInfo->ri_RelationDesc, estate->es_snapshot, 0, NULL);
+        if (OidIsValid(indexes->start_id_index) &&
+            OidIsValid(indexes->end_id_index))
+        {
+            process_connected_edges_by_index(node, resultRelInfo,
+                                             indexes->start_id_index, false,
+                                             var_name, id, detach_delete);
+            process_connected_edges_by_index(node, resultRelInfo,
+                                             indexes->end_id_index, true,
+                                             var_name, id, detach_delete);
+        }
+        else
+        {
+            process_connected_edges_by_scan(node, resultRelInfo, var_name, id,
+                                            detach_delete);
+        }
+    }
 
-        slot = ExecInitExtraTupleSlot(estate,
-                    RelationGetDescr(resultRelInfo->ri_RelationDesc));
+    Decrement_Estate_CommandId(estate);
+}
 
-        // scan the table
-        while(true)
-        {
-            graphid startid, endid;
-            bool isNull;
+/*
+ * Find the edges connected to all the vertices a terminal DELETE clause
+ * deleted. Each edge label is visited once: when there are few vertices
+ * compared to the size of the label, the start_id and end_id indexes are
+ * probed for every vertex. Otherwise, the label is scanned once and each
+ * edge is looked up in the set of deleted vertices.
+ */
+static void find_connected_edges_batch(CustomScanState *node)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    char *graph_name = css->delete_data->graph_name;
+    bool detach_delete = css->delete_data->detach;
+    long num_vertices;
+    ListCell *lc;
 
-            tuple = heap_getnext(scan_desc, ForwardScanDirection);
+    num_vertices = hash_get_num_entries(css->deleted_vertices);
+    if (num_vertices == 0)
+        return;
 
-            // no more tuples to process, break and scan the next label.
-            if (!HeapTupleIsValid(tuple))
-                break;
+    Increment_Estate_CommandId(estate);
 
-            ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+    foreach(lc, css->edge_labels)
+    {
+        char *label_name = lfirst(lc);
+        ResultRelInfo *resultRelInfo;
+        Relation rel;
+        edge_label_indexes_entry *indexes;
 
-            startid = GRAPHID_GET_DATUM(slot_getattr(slot, Anum_ag_label_edge_table_start_id, &isNull));
-            endid = GRAPHID_GET_DATUM(slot_getattr(slot, Anum_ag_label_edge_table_end_id, &isNull));
+        resultRelInfo = get_entity_result_rel_info(&css->result_rel_infos,
+                                                   estate, graph_name,
+                                                   label_name)->resultRelInfo;
+        rel = resultRelInfo->ri_RelationDesc;
+        indexes = get_edge_label_indexes(node, label_name, rel);
 
-            if (id == startid || id == endid)
+        /*
+         * Each vertex costs two index probes, while a scan reads every
+         * page of the label once.
+         */
+        if (OidIsValid(indexes->start_id_index) &&
+            OidIsValid(indexes->end_id_index) &&
+            num_vertices * 2 < RelationGetNumberOfBlocks(rel))
+        {
+            HASH_SEQ_STATUS hash_seq;
+            deleted_vertex_entry *entry;
+
+            hash_seq_init(&hash_seq, css->deleted_vertices);
+            while ((entry = hash_seq_search(&hash_seq)) != NULL)
             {
-                /*
-                 * We have found an edge that uses the vertex. Either delete the edge
-                 * or throw an error. Depending on whether the DETACH option was
-                 * specified in the query.
-                 */
-                if (detach_delete)
-                    delete_entity(node, graph_name, label_name, tuple);
-                else
-                    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-                            errmsg("Cannot delete vertex %s, because it still has edges attached. "
-                                    "To delete this vertex, you must first delete the attached edges.",
-                                    var_name)));
+                process_connected_edges_by_index(node, resultRelInfo,
+                                                 indexes->start_id_index,
+                                                 false, entry->var_name,
+                                                 entry->id, detach_delete);
+                process_connected_edges_by_index(node, resultRelInfo,
+                                                 indexes->end_id_index, true,
+                                                 entry->var_name, entry->id,
+                                                 detach_delete);
             }
         }
-
-        heap_endscan(scan_desc);
-        heap_close(resultRelInfo->ri_RelationDesc, RowExclusiveLock);
+        else
+        {
+            process_connected_edges_by_batch_scan(node, resultRelInfo,
+                                                  detach_delete);
+        }
     }
 
     Decrement_Estate_CommandId(estate);
 }
+
+/*
+ * Find the start_id and end_id indexes of the edge label. They are looked up
+ * in the catalog once per label, and kept for the rest of the clause.
+ */
+static edge_label_indexes_entry *get_edge_label_indexes(
+    CustomScanState *node, char *label_name, Relation rel)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    edge_label_indexes_entry *entry;
+    bool found;
+
+    if (css->edge_label_indexes == NULL)
+    {
+        HASHCTL hash_ctl;
+
+        MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+        hash_ctl.keysize = NAMEDATALEN;
+        hash_ctl.entrysize = sizeof(edge_label_indexes_entry);
+        hash_ctl.hcxt = estate->es_query_cxt;
+
+        css->edge_label_indexes = hash_create("cypher DELETE edge indexes",
+                                              16, &hash_ctl,
+                                              HASH_ELEM | HASH_CONTEXT);
+    }
+
+    entry = hash_search(css->edge_label_indexes, label_name, HASH_ENTER,
+                        &found);
+    if (!found)
+    {
+        entry->start_id_index =
+            find_index_on_column(rel, Anum_ag_label_edge_table_start_id);
+        entry->end_id_index =
+            find_index_on_column(rel, Anum_ag_label_edge_table_end_id);
+    }
+
+    return entry;
+}
+
+/*
+ * Use the given start_id or end_id index of the edge label to find the edges
+ * that are attached to the vertex.
+ *
+ * The end_id index is probed after the start_id index. It skips the edges
+ * the start_id probes already found: the self loops of the vertex and, for a
+ * terminal clause, the edges that start at a vertex the clause deletes.
+ */
+static void process_connected_edges_by_index(CustomScanState *node,
+                                             ResultRelInfo *resultRelInfo,
+                                             Oid index_oid, bool end_id_probe,
+                                             char *var_name, graphid id,
+                                             bool detach_delete)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    TupleDesc tupdesc = RelationGetDescr(resultRelInfo->ri_RelationDesc);
+    ScanKeyData scan_keys[1];
+    Relation index_rel;
+    IndexScanDesc scan_desc;
+    HeapTuple tuple;
+
+    ScanKeyInit(&scan_keys[0], 1, BTEqualStrategyNumber, F_GRAPHIDEQ,
+                GRAPHID_GET_DATUM(id));
+
+    index_rel = index_open(index_oid, AccessShareLock);
+    scan_desc = index_beginscan(resultRelInfo->ri_RelationDesc, index_rel,
+                                estate->es_snapshot, 1, 0);
+    index_rescan(scan_desc, scan_keys, 1, NULL, 0);
+
+    while ((tuple = index_getnext(scan_desc, ForwardScanDirection)) != NULL)
+    {
+        if (end_id_probe)
+        {
+            graphid startid;
+            bool isNull;
+
+            startid = DATUM_GET_GRAPHID(heap_getattr(tuple, Anum_ag_label_edge_table_start_id,
+                                                     tupdesc, &isNull));
+
+            if (startid == id ||
+                (css->deleted_vertices != NULL &&
+                 hash_search(css->deleted_vertices, &startid, HASH_FIND,
+                             NULL) != NULL))
+                continue;
+        }
+
+        process_connected_edge(node, resultRelInfo, tuple, var_name,
+                               detach_delete);
+    }
+
+    index_endscan(scan_desc);
+    index_close(index_rel, AccessShareLock);
+}
+
+/*
+ * Scan every edge of the edge label to find the edges that are attached to
+ * the vertex.
+ */
+static void process_connected_edges_by_scan(CustomScanState *node,
+                                            ResultRelInfo *resultRelInfo,
+                                            char *var_name, graphid id,
+                                            bool detach_delete)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    Relation rel = resultRelInfo->ri_RelationDesc;
+    TupleDesc tupdesc = RelationGetDescr(rel);
+    HeapScanDesc scan_desc;
+    HeapTuple tuple;
+
+    scan_desc = heap_beginscan(rel, estate->es_snapshot, 0, NULL);
+
+    while ((tuple = heap_getnext(scan_desc, ForwardScanDirection)) != NULL)
+    {
+        graphid startid, endid;
+        bool isNull;
+
+        startid = DATUM_GET_GRAPHID(heap_getattr(tuple, Anum_ag_label_edge_table_start_id,
+                                                 tupdesc, &isNull));
+        endid = DATUM_GET_GRAPHID(heap_getattr(tuple, Anum_ag_label_edge_table_end_id,
+                                               tupdesc, &isNull));
+
+        if (id == startid || id == endid)
+            process_connected_edge(node, resultRelInfo, tuple, var_name,
+                                   detach_delete);
+    }
+
+    heap_endscan(scan_desc);
+}
+
+/*
+ * Scan every edge of the edge label once, and look up its start and end
+ * vertices in the set of vertices deleted by the clause.
+ */
+static void process_connected_edges_by_batch_scan(CustomScanState *node,
+                                                  ResultRelInfo *resultRelInfo,
+                                                  bool detach_delete)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    Relation rel = resultRelInfo->ri_RelationDesc;
+    TupleDesc tupdesc = RelationGetDescr(rel);
+    HeapScanDesc scan_desc;
+    HeapTuple tuple;
+
+    scan_desc = heap_beginscan(rel, estate->es_snapshot, 0, NULL);
+
+    while ((tuple = heap_getnext(scan_desc, ForwardScanDirection)) != NULL)
+    {
+        deleted_vertex_entry *entry;
+        graphid startid, endid;
+        bool isNull;
+
+        startid = DATUM_GET_GRAPHID(heap_getattr(tuple, Anum_ag_label_edge_table_start_id,
+                                                 tupdesc, &isNull));
+        endid = DATUM_GET_GRAPHID(heap_getattr(tuple, Anum_ag_label_edge_table_end_id,
+                                               tupdesc, &isNull));
+
+        entry = hash_search(css->deleted_vertices, &startid, HASH_FIND, NULL);
+        if (entry == NULL)
+            entry = hash_search(css->deleted_vertices, &endid, HASH_FIND, NULL);
+
+        if (entry != NULL)
+            process_connected_edge(node, resultRelInfo, tuple, entry->var_name,
+                                   detach_delete);
+    }
+
+    heap_endscan(scan_desc);
+}
+
+/*
+ * We have found an edge that uses the vertex. Either delete the edge
+ * or throw an error. Depending on whether the DETACH option was
+ * specified in the query.
+ */
+static void process_connected_edge(CustomScanState *node,
+                                   ResultRelInfo *resultRelInfo, HeapTuple tuple,
+                                   char *var_name, bool detach_delete)
+{
+    if (detach_delete)
+        delete_tuple(node, resultRelInfo, tuple);
+    else
+        ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+                errmsg("Cannot delete vertex %s, because it still has edges attached. "
+                        "To delete this vertex, you must first delete the attached edges.",
+                        var_name)));
+}
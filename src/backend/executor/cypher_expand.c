@@ -0,0 +1,337 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/skey.h"
+#include "access/stratnum.h"
+#include "commands/explain.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "nodes/execnodes.h"
+#include "nodes/extensible.h"
+#include "nodes/nodes.h"
+#include "nodes/plannodes.h"
+#include "utils/rel.h"
+
+#include "catalog/ag_label.h"
+#include "executor/cypher_executor.h"
+#include "executor/cypher_utils.h"
+#include "utils/graphid.h"
+
+static void begin_cypher_expand(CustomScanState *node, EState *estate,
+                                int eflags);
+static TupleTableSlot *exec_cypher_expand(CustomScanState *node);
+static void end_cypher_expand(CustomScanState *node);
+static void rescan_cypher_expand(CustomScanState *node);
+static void explain_cypher_expand(CustomScanState *node, List *ancestors,
+                                  ExplainState *es);
+
+static TupleTableSlot *next_cypher_expand(ScanState *node);
+static bool recheck_cypher_expand(ScanState *node, TupleTableSlot *slot);
+static bool fetch_outer_tuple(cypher_expand_custom_scan_state *css);
+static void store_scan_tuple(cypher_expand_custom_scan_state *css,
+                             HeapTuple edge, TupleDesc edge_tupdesc);
+
+const CustomExecMethods cypher_expand_exec_methods = {EXPAND_SCAN_STATE_NAME,
+                                                      begin_cypher_expand,
+                                                      exec_cypher_expand,
+                                                      end_cypher_expand,
+                                                      rescan_cypher_expand,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      NULL,
+                                                      explain_cypher_expand};
+
+/*
+ * Setup the child node, the id expressions, and open the tables of the edge
+ * label with the indexes the edges are looked up in. PostgreSQL already made
+ * the scan tuple slot, the projection info, and the quals out of the
+ * custom_scan_tlist.
+ */
+static void begin_cypher_expand(CustomScanState *node, EState *estate,
+                                int eflags)
+{
+    cypher_expand_custom_scan_state *css =
+        (cypher_expand_custom_scan_state *)node;
+    List *rel_oids = linitial(css->cs->custom_private);
+    List *index_oids = lsecond(css->cs->custom_private);
+    Plan *subplan;
+    ListCell *lc;
+    ListCell *lc2;
+    int i;
+
+    Assert(list_length(css->cs->custom_plans) == 1);
+
+    // setup child
+    subplan = linitial(css->cs->custom_plans);
+    node->ss.ps.lefttree = ExecInitNode(subplan, estate, eflags);
+
+    css->outer_natts = ExecGetResultType(node->ss.ps.lefttree)->natts;
+
+    css->key_expr = ExecInitExpr(linitial(css->cs->custom_exprs),
+                                 &node->ss.ps);
+    if (css->into_attnum != InvalidAttrNumber)
+        css->into_expr = ExecInitExpr(lsecond(css->cs->custom_exprs),
+                                      &node->ss.ps);
+
+    css->num_labels = list_length(rel_oids);
+    css->label_rels = palloc(sizeof(Relation) * css->num_labels);
+    css->index_rels = palloc(sizeof(Relation) * css->num_labels);
+    css->scan_descs = palloc(sizeof(IndexScanDesc) * css->num_labels);
+
+    i = 0;
+    forboth (lc, rel_oids, lc2, index_oids)
+    {
+        css->label_rels[i] = heap_open(lfirst_oid(lc), AccessShareLock);
+        css->index_rels[i] = index_open(lfirst_oid(lc2), AccessShareLock);
+
+        /*
+         * The scans use the snapshot of the estate, so they see the command
+         * id changes of the clauses above, like the scans PostgreSQL makes.
+         */
+        css->scan_descs[i] = index_beginscan(css->label_rels[i],
+                                             css->index_rels[i],
+                                             estate->es_snapshot, 1, 0);
+        i++;
+    }
+
+    css->current_label = -1;
+    css->outer_slot = NULL;
+    css->edge_tuple = NULL;
+}
+
+static TupleTableSlot *exec_cypher_expand(CustomScanState *node)
+{
+    return ExecScan(&node->ss, next_cypher_expand, recheck_cypher_expand);
+}
+
+/*
+ * Return the next edge of the current outer tuple, in the scan tuple slot.
+ * When the edges of the outer tuple are exhausted, the next outer tuple is
+ * fetched and its edges are looked up in the index of each label table.
+ */
+static TupleTableSlot *next_cypher_expand(ScanState *node)
+{
+    cypher_expand_custom_scan_state *css =
+        (cypher_expand_custom_scan_state *)node;
+
+    for (;;)
+    {
+        IndexScanDesc scan_desc;
+        HeapTuple tuple;
+
+        if (css->current_label < 0 && !fetch_outer_tuple(css))
+        {
+            css->edge_tuple = NULL;
+            return ExecClearTuple(node->ss_ScanTupleSlot);
+        }
+
+        scan_desc = css->scan_descs[css->current_label];
+        tuple = index_getnext(scan_desc, ForwardScanDirection);
+
+        if (tuple == NULL)
+        {
+            css->current_label++;
+            if (css->current_label == css->num_labels)
+            {
+                css->current_label = -1;
+                continue;
+            }
+
+            index_rescan(css->scan_descs[css->current_label], &css->scan_key,
+                         1, NULL, 0);
+            continue;
+        }
+
+        // expand into, the other end of the edge is bound as well
+        if (css->into_attnum != InvalidAttrNumber)
+        {
+            TupleDesc tupdesc = RelationGetDescr(scan_desc->heapRelation);
+            bool isnull;
+            Datum id;
+
+            id = heap_getattr(tuple, css->into_attnum, tupdesc, &isnull);
+            if (isnull || DATUM_GET_GRAPHID(id) != css->into_id)
+                continue;
+        }
+
+        store_scan_tuple(css, tuple, RelationGetDescr(scan_desc->heapRelation));
+
+        return node->ss_ScanTupleSlot;
+    }
+}
+
+/*
+ * Fetch the next tuple of the outer plan whose ids are not NULL and start the
+ * scan of its edges in the first label table. Returns false when the outer
+ * plan is exhausted.
+ */
+static bool fetch_outer_tuple(cypher_expand_custom_scan_state *css)
+{
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+
+    for (;;)
+    {
+        Datum key;
+        bool isnull;
+
+        css->outer_slot = ExecProcNode(outerPlanState(css));
+        if (TupIsNull(css->outer_slot))
+            return false;
+
+        // the ids are computed from the outer part of the scan tuple
+        store_scan_tuple(css, NULL, NULL);
+        econtext->ecxt_scantuple = css->css.ss.ss_ScanTupleSlot;
+
+        key = ExecEvalExpr(css->key_expr, econtext, &isnull);
+        if (isnull)
+            continue;
+
+        if (css->into_attnum != InvalidAttrNumber)
+        {
+            Datum into_id = ExecEvalExpr(css->into_expr, econtext, &isnull);
+
+            if (isnull)
+                continue;
+
+            css->into_id = DATUM_GET_GRAPHID(into_id);
+        }
+
+        ScanKeyInit(&css->scan_key, 1, BTEqualStrategyNumber, F_GRAPHIDEQ,
+                    key);
+        index_rescan(css->scan_descs[0], &css->scan_key, 1, NULL, 0);
+        css->current_label = 0;
+
+        return true;
+    }
+}
+
+/*
+ * The scan tuple is the outer tuple followed by the columns of the edge. The
+ * edge columns are NULL when there is no edge yet.
+ */
+static void store_scan_tuple(cypher_expand_custom_scan_state *css,
+                             HeapTuple edge, TupleDesc edge_tupdesc)
+{
+    TupleTableSlot *slot = css->css.ss.ss_ScanTupleSlot;
+    int natts = slot->tts_tupleDescriptor->natts;
+    int i;
+
+    ExecClearTuple(slot);
+
+    slot_getallattrs(css->outer_slot);
+    memcpy(slot->tts_values, css->outer_slot->tts_values,
+           sizeof(Datum) * css->outer_natts);
+    memcpy(slot->tts_isnull, css->outer_slot->tts_isnull,
+           sizeof(bool) * css->outer_natts);
+
+    for (i = css->outer_natts; i < natts; i++)
+    {
+        if (edge == NULL)
+        {
+            slot->tts_values[i] = (Datum)0;
+            slot->tts_isnull[i] = true;
+        }
+        else
+        {
+            slot->tts_values[i] = heap_getattr(edge, i - css->outer_natts + 1,
+                                               edge_tupdesc,
+                                               &slot->tts_isnull[i]);
+        }
+    }
+
+    css->edge_tuple = edge;
+
+    ExecStoreVirtualTuple(slot);
+}
+
+// the edges are not locked, there is nothing to recheck
+static bool recheck_cypher_expand(ScanState *node, TupleTableSlot *slot)
+{
+    return true;
+}
+
+static void end_cypher_expand(CustomScanState *node)
+{
+    cypher_expand_custom_scan_state *css =
+        (cypher_expand_custom_scan_state *)node;
+    int i;
+
+    for (i = 0; i < css->num_labels; i++)
+    {
+        index_endscan(css->scan_descs[i]);
+        index_close(css->index_rels[i], AccessShareLock);
+        heap_close(css->label_rels[i], AccessShareLock);
+    }
+
+    ExecEndNode(node->ss.ps.lefttree);
+}
+
+static void rescan_cypher_expand(CustomScanState *node)
+{
+    cypher_expand_custom_scan_state *css =
+        (cypher_expand_custom_scan_state *)node;
+
+    css->current_label = -1;
+    css->edge_tuple = NULL;
+
+    if (node->ss.ps.lefttree->chgParam == NULL)
+        ExecReScan(node->ss.ps.lefttree);
+}
+
+static void explain_cypher_expand(CustomScanState *node, List *ancestors,
+                                  ExplainState *es)
+{
+    cypher_expand_custom_scan_state *css =
+        (cypher_expand_custom_scan_state *)node;
+
+    if (css->key_attnum == Anum_ag_label_edge_table_start_id)
+        ExplainPropertyText("Direction", "outgoing", es);
+    else
+        ExplainPropertyText("Direction", "incoming", es);
+
+    if (css->into_attnum != InvalidAttrNumber)
+        ExplainPropertyBool("Expand Into", true, es);
+}
+
+Node *create_cypher_expand_plan_state(CustomScan *cscan)
+{
+    cypher_expand_custom_scan_state *cypher_css =
+        palloc0(sizeof(cypher_expand_custom_scan_state));
+
+    cypher_css->cs = cscan;
+
+    cypher_css->key_attnum = intVal(lthird(cscan->custom_private));
+    cypher_css->into_attnum = intVal(lfourth(cscan->custom_private));
+    cypher_css->var_name = strVal(list_nth(cscan->custom_private, 4));
+
+    cypher_css->css.ss.ps.type = T_CustomScanState;
+    cypher_css->css.methods = &cypher_expand_exec_methods;
+
+    return (Node *)cypher_css;
+}
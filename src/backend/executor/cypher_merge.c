@@ -0,0 +1,1434 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/hash.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/skey.h"
+#include "access/stratnum.h"
+#include "access/xact.h"
+#include "catalog/pg_am_d.h"
+#include "catalog/pg_inherits.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "nodes/extensible.h"
+#include "nodes/nodes.h"
+#include "nodes/plannodes.h"
+#include "storage/bufmgr.h"
+#include "storage/lmgr.h"
+#include "storage/lock.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/tqual.h"
+
+#include "catalog/ag_label.h"
+#include "commands/label_commands.h"
+#include "executor/cypher_executor.h"
+#include "executor/cypher_utils.h"
+#include "nodes/cypher_nodes.h"
+#include "utils/ag_cache.h"
+#include "utils/ag_func.h"
+#include "utils/agtype.h"
+#include "utils/graphid.h"
+
+/*
+ * The Cypher Merge node matches the path of a MERGE clause for every row of
+ * the previous clauses, and creates the path when there is no match.
+ *
+ * The path is matched with a depth-first search from its first vertex, or
+ * from its last one when only that one is bound by the previous clauses. The
+ * edges are looked up in the start_id and end_id indexes of the tables of
+ * their label, and the vertices they lead to in the primary keys. The first
+ * vertex is looked up with a property index when one of its properties has
+ * one. Otherwise, every table of its label is scanned in full for each row,
+ * so the first vertex of a pattern that is merged often should have an index
+ * on one of its properties (CREATE INDEX ON :label(property)).
+ *
+ * The label tables have no unique index on the properties, so two
+ * transactions could both miss the path and both create it. To prevent
+ * that, the path is matched and created while holding a lock on a hash of
+ * the pattern, and the entities are looked up with a dirty snapshot, which
+ * sees the entities other transactions are inserting. Matching waits for
+ * those transactions to end and starts over. The lock is released once the
+ * entities are inserted, since from then on the other transactions see them
+ * and wait.
+ */
+
+// the fourth field of the lock tags, the advisory locks use 1 and 2
+#define MERGE_LOCKTAG_FIELD4 3
+
+// a path matched or created for a row, by element
+typedef struct merge_match
+{
+    Datum *values;
+    HeapTuple *tuples;
+} merge_match;
+
+// a property index of a table of the first vertex
+typedef struct merge_property_index
+{
+    int label;
+    Relation index_rel;
+    char *key;
+    RegProcedure eq_proc;
+} merge_property_index;
+
+// a lookup in a label table, with one of its indexes or a scan of the table
+typedef struct merge_scan
+{
+    IndexScanDesc index_scan;
+    HeapScanDesc heap_scan;
+} merge_scan;
+
+static void begin_cypher_merge(CustomScanState *node, EState *estate,
+                               int eflags);
+static TupleTableSlot *exec_cypher_merge(CustomScanState *node);
+static void end_cypher_merge(CustomScanState *node);
+static void rescan_cypher_merge(CustomScanState *node);
+
+static void open_element_tables(cypher_merge_element *element);
+static void find_property_indexes(cypher_merge_element *element);
+static void process_merge_row(cypher_merge_custom_scan_state *css);
+static void read_bound_vertices(cypher_merge_custom_scan_state *css);
+static void check_null_properties(cypher_merge_element *element,
+                                  agtype *properties);
+static void get_merge_lock_tag(cypher_merge_custom_scan_state *css,
+                               LOCKTAG *tag);
+static agtype *get_element_properties(cypher_merge_custom_scan_state *css,
+                                      int i);
+static bool match_step(cypher_merge_custom_scan_state *css, int step,
+                       graphid vertex_id);
+static bool match_first_vertex(cypher_merge_custom_scan_state *css);
+static bool match_next_vertex(cypher_merge_custom_scan_state *css, int step,
+                              graphid vertex_id);
+static bool match_edges(cypher_merge_custom_scan_state *css, int step);
+static bool edge_in_path(cypher_merge_custom_scan_state *css, graphid id);
+static void begin_merge_scan(cypher_merge_custom_scan_state *css,
+                             merge_scan *scan, Relation rel,
+                             Relation index_rel, ScanKey key);
+static HeapTuple merge_scan_next(merge_scan *scan, Buffer *buffer);
+static void end_merge_scan(merge_scan *scan);
+static bool must_wait(cypher_merge_custom_scan_state *css);
+static void check_tuple_visible(cypher_merge_custom_scan_state *css,
+                                HeapTuple tuple, Buffer buffer);
+static void add_match(cypher_merge_custom_scan_state *css);
+static void create_merge_path(cypher_merge_custom_scan_state *css);
+static void store_merge_match(cypher_merge_custom_scan_state *css,
+                              merge_match *match);
+
+const CustomExecMethods cypher_merge_exec_methods = {MERGE_SCAN_STATE_NAME,
+                                                     begin_cypher_merge,
+                                                     exec_cypher_merge,
+                                                     end_cypher_merge,
+                                                     rescan_cypher_merge,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL,
+                                                     NULL};
+
+static void begin_cypher_merge(CustomScanState *node, EState *estate,
+                               int eflags)
+{
+    cypher_merge_custom_scan_state *css =
+        (cypher_merge_custom_scan_state *)node;
+    Plan *subplan;
+    ListCell *lc;
+    int n;
+    int i;
+
+    Assert(list_length(css->cs->custom_plans) == 1);
+
+    subplan = linitial(css->cs->custom_plans);
+    node->ss.ps.lefttree = ExecInitNode(subplan, estate, eflags);
+
+    ExecAssignExprContext(estate, &node->ss.ps);
+
+    ExecInitScanTupleSlot(estate, &node->ss,
+                          ExecGetResultType(node->ss.ps.lefttree));
+
+    if (!CYPHER_CLAUSE_IS_TERMINAL(css->flags))
+    {
+        TupleDesc tupdesc = node->ss.ss_ScanTupleSlot->tts_tupleDescriptor;
+
+        ExecAssignProjectionInfo(&node->ss.ps, tupdesc);
+    }
+
+    n = list_length(css->path->target_nodes);
+    css->num_elements = n;
+    css->elements = palloc0(sizeof(cypher_merge_element) * n);
+    css->order = palloc(sizeof(int) * n);
+    css->ids = palloc0(sizeof(graphid) * n);
+    css->values = palloc0(sizeof(Datum) * n);
+    css->tuples = palloc0(sizeof(HeapTuple) * n);
+    css->assigned = palloc0(sizeof(bool) * n);
+
+    i = 0;
+    foreach (lc, css->path->target_nodes)
+    {
+        cypher_target_node *target_node = lfirst(lc);
+        cypher_merge_element *element = &css->elements[i];
+
+        element->node = target_node;
+        element->alias = -1;
+
+        if (!CYPHER_TARGET_NODE_INSERT_ENTITY(target_node->flags))
+        {
+            int j;
+
+            Assert(target_node->type == LABEL_KIND_VERTEX);
+
+            element->bound = !SAFE_TO_SKIP_EXISTENCE_CHECK(target_node->flags);
+            if (element->bound)
+            {
+                if (CYPHER_CLAUSE_HAS_PREVIOUS_DELETE(css->flags))
+                    element->source = resolve_entity_source(
+                        node, target_node->variable_name);
+            }
+            else
+            {
+                // the variable was declared earlier in the path
+                for (j = 0; j < i; j++)
+                {
+                    cypher_target_node *prev = css->elements[j].node;
+
+                    if (CYPHER_TARGET_NODE_INSERT_ENTITY(prev->flags) &&
+                        prev->tuple_position == target_node->tuple_position)
+                    {
+                        element->alias = j;
+                        break;
+                    }
+                }
+
+                if (element->alias < 0)
+                    ereport(ERROR,
+                            (errmsg_internal("vertex %s is not in the path",
+                                             target_node->variable_name)));
+            }
+
+            i++;
+            continue;
+        }
+
+        // Open relation and aquire a row exclusive lock.
+        target_node->resultRelInfo = makeNode(ResultRelInfo);
+        InitResultRelInfo(target_node->resultRelInfo,
+                          heap_open(target_node->relid, RowExclusiveLock),
+                          list_length(estate->es_range_table), NULL,
+                          estate->es_instrument);
+
+        // Open all indexes for the relation
+        ExecOpenIndices(target_node->resultRelInfo, false);
+
+        // Setup the relation's tuple slot
+        target_node->elemTupleSlot = ExecInitExtraTupleSlot(
+            estate,
+            RelationGetDescr(target_node->resultRelInfo->ri_RelationDesc));
+
+        if (target_node->id_expr != NULL)
+            target_node->id_expr_state =
+                ExecInitExpr(target_node->id_expr, (PlanState *)node);
+
+        open_element_tables(element);
+
+        i++;
+    }
+
+    /*
+     * The path is matched from the vertex it is cheapest to start from. A
+     * bound vertex has one candidate, so when only the last vertex is bound,
+     * the path is matched backwards.
+     */
+    for (i = 0; i < n; i++)
+    {
+        if (!css->elements[0].bound && css->elements[n - 1].bound)
+            css->order[i] = n - 1 - i;
+        else
+            css->order[i] = i;
+    }
+
+    if (!css->elements[css->order[0]].bound)
+        find_property_indexes(&css->elements[css->order[0]]);
+
+    InitDirtySnapshot(css->dirty_snapshot);
+
+    css->row_mcxt = AllocSetContextCreate(estate->es_query_cxt,
+                                          "cypher merge row",
+                                          ALLOCSET_DEFAULT_SIZES);
+    css->matches = NIL;
+    css->next_match = NULL;
+
+    /*
+     * Postgres does not assign the es_output_cid in queries that do
+     * not write to disk, ie: SELECT commands. We need the command id
+     * for our clauses, and we may need to initialize it. We cannot use
+     * GetCurrentCommandId because there may be other cypher clauses
+     * that have modified the command id.
+     */
+    if (estate->es_output_cid == 0)
+        estate->es_output_cid = estate->es_snapshot->curcid;
+
+    CommandCounterIncrement();
+    Increment_Estate_CommandId(estate);
+}
+
+/*
+ * Open the tables of the label of the element, and of the labels inheriting
+ * it, with the indexes the entities are looked up with.
+ */
+static void open_element_tables(cypher_merge_element *element)
+{
+    cypher_target_node *target_node = element->node;
+    List *rel_oids;
+    ListCell *lc;
+    int i;
+
+    rel_oids = find_all_inheritors(target_node->relid, AccessShareLock, NULL);
+
+    element->num_labels = list_length(rel_oids);
+    element->label_rels = palloc(sizeof(Relation) * element->num_labels);
+    element->label_names = palloc(sizeof(char *) * element->num_labels);
+    element->id_index_rels = palloc0(sizeof(Relation) * element->num_labels);
+    element->start_index_rels = palloc0(sizeof(Relation) *
+                                        element->num_labels);
+    element->end_index_rels = palloc0(sizeof(Relation) * element->num_labels);
+
+    i = 0;
+    foreach (lc, rel_oids)
+    {
+        Oid relid = lfirst_oid(lc);
+        label_cache_data *lcd;
+        Relation rel;
+        Oid index_oid;
+
+        lcd = search_label_relation_cache(relid);
+        if (lcd == NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_UNDEFINED_OBJECT),
+                     errmsg("table %s is not a label", get_rel_name(relid))));
+
+        if (IS_AG_DEFAULT_LABEL(NameStr(lcd->name)))
+            element->label_names[i] = "";
+        else
+            element->label_names[i] = pstrdup(NameStr(lcd->name));
+
+        rel = heap_open(relid, AccessShareLock);
+        element->label_rels[i] = rel;
+
+        if (target_node->type == LABEL_KIND_VERTEX)
+        {
+            index_oid = RelationGetPrimaryKeyIndex(rel);
+            if (OidIsValid(index_oid))
+                element->id_index_rels[i] = index_open(index_oid,
+                                                       AccessShareLock);
+        }
+        else
+        {
+            index_oid = find_index_on_column(rel,
+                                             Anum_ag_label_edge_table_start_id);
+            if (OidIsValid(index_oid))
+                element->start_index_rels[i] = index_open(index_oid,
+                                                          AccessShareLock);
+
+            index_oid = find_index_on_column(rel,
+                                             Anum_ag_label_edge_table_end_id);
+            if (OidIsValid(index_oid))
+                element->end_index_rels[i] = index_open(index_oid,
+                                                        AccessShareLock);
+        }
+
+        i++;
+    }
+}
+
+/*
+ * Find the indexes made by create_property_index() on the tables of the
+ * vertex, the btree indexes on properties -> key.
+ */
+static void find_property_indexes(cypher_merge_element *element)
+{
+    Oid access_func_oid;
+    int i;
+
+    access_func_oid = get_ag_func_oid("agtype_access_operator", 1,
+                                      AGTYPEARRAYOID);
+
+    for (i = 0; i < element->num_labels; i++)
+    {
+        List *index_oids = RelationGetIndexList(element->label_rels[i]);
+        ListCell *lc;
+
+        foreach (lc, index_oids)
+        {
+            Relation index_rel;
+            Form_pg_index index_form;
+            FuncExpr *access = NULL;
+            Var *props;
+            Const *key;
+            agtype_value *key_value;
+            merge_property_index *property_index;
+            Oid opno;
+
+            index_rel = index_open(lfirst_oid(lc), AccessShareLock);
+            index_form = index_rel->rd_index;
+
+            if (index_rel->rd_rel->relam == BTREE_AM_OID &&
+                IndexIsValid(index_form) && index_form->indnatts == 1 &&
+                index_form->indkey.values[0] == 0 &&
+                RelationGetIndexPredicate(index_rel) == NIL)
+            {
+                List *exprs = RelationGetIndexExpressions(index_rel);
+
+                if (IsA(linitial(exprs), FuncExpr) &&
+                    ((FuncExpr *)linitial(exprs))->funcid == access_func_oid)
+                    access = linitial(exprs);
+            }
+
+            if (access == NULL || list_length(access->args) != 2 ||
+                !IsA(linitial(access->args), Var) ||
+                !IsA(lsecond(access->args), Const))
+            {
+                index_close(index_rel, AccessShareLock);
+                continue;
+            }
+
+            props = linitial(access->args);
+            key = lsecond(access->args);
+            if (props->varattno != Anum_ag_label_vertex_table_properties ||
+                key->constisnull)
+            {
+                index_close(index_rel, AccessShareLock);
+                continue;
+            }
+
+            key_value = get_ith_agtype_value_from_container(
+                &DATUM_GET_AGTYPE_P(key->constvalue)->root, 0);
+            opno = get_opfamily_member(index_rel->rd_opfamily[0], AGTYPEOID,
+                                       AGTYPEOID, BTEqualStrategyNumber);
+            if (key_value->type != AGTV_STRING || !OidIsValid(opno))
+            {
+                index_close(index_rel, AccessShareLock);
+                continue;
+            }
+
+            property_index = palloc(sizeof(merge_property_index));
+            property_index->label = i;
+            property_index->index_rel = index_rel;
+            property_index->key = pnstrdup(key_value->val.string.val,
+                                           key_value->val.string.len);
+            property_index->eq_proc = get_opcode(opno);
+
+            element->property_indexes = lappend(element->property_indexes,
+                                                property_index);
+        }
+
+        list_free(index_oids);
+    }
+}
+
+static TupleTableSlot *exec_cypher_merge(CustomScanState *node)
+{
+    cypher_merge_custom_scan_state *css =
+        (cypher_merge_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    TupleTableSlot *slot;
+
+    if (CYPHER_CLAUSE_IS_TERMINAL(css->flags))
+    {
+        /*
+         * Nothing is returned when MERGE is the last clause, so all the
+         * rows of the previous clauses are processed in the first call.
+         */
+        while (true)
+        {
+            //Process the subtree first
+            Decrement_Estate_CommandId(estate)
+            slot = ExecProcNode(node->ss.ps.lefttree);
+            Increment_Estate_CommandId(estate)
+
+            if (TupIsNull(slot))
+                break;
+
+            econtext->ecxt_scantuple =
+                node->ss.ps.lefttree->ps_ProjInfo->pi_exprContext->ecxt_scantuple;
+
+            process_merge_row(css);
+        }
+
+        return NULL;
+    }
+
+    // a row is returned for every path matched for the row of the subtree
+    while (css->next_match == NULL)
+    {
+        //Process the subtree first
+        Decrement_Estate_CommandId(estate)
+        slot = ExecProcNode(node->ss.ps.lefttree);
+        Increment_Estate_CommandId(estate)
+
+        if (TupIsNull(slot))
+            return NULL;
+
+        econtext->ecxt_scantuple =
+            node->ss.ps.lefttree->ps_ProjInfo->pi_exprContext->ecxt_scantuple;
+
+        process_merge_row(css);
+    }
+
+    store_merge_match(css, lfirst(css->next_match));
+    css->next_match = lnext(css->next_match);
+
+    econtext->ecxt_scantuple = ExecProject(node->ss.ps.lefttree->ps_ProjInfo);
+
+    return ExecProject(node->ss.ps.ps_ProjInfo);
+}
+
+/*
+ * Match the path for the current row of the subtree, or create it if there
+ * is no match. The paths are kept in css->matches for store_merge_match().
+ */
+static void process_merge_row(cypher_merge_custom_scan_state *css)
+{
+    MemoryContext old_mcxt;
+    LOCKTAG tag;
+    int i;
+
+    MemoryContextReset(css->row_mcxt);
+    old_mcxt = MemoryContextSwitchTo(css->row_mcxt);
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        css->assigned[i] = false;
+
+        if (CYPHER_TARGET_NODE_INSERT_ENTITY(css->elements[i].node->flags))
+            check_null_properties(&css->elements[i],
+                                  get_element_properties(css, i));
+    }
+
+    read_bound_vertices(css);
+
+    get_merge_lock_tag(css, &tag);
+
+    for (;;)
+    {
+        LockAcquire(&tag, ExclusiveLock, false, false);
+
+        css->matches = NIL;
+        css->wait_xid = InvalidTransactionId;
+
+        if (match_step(css, 0, 0))
+            break;
+
+        /*
+         * Another transaction is inserting or deleting one of the entities,
+         * wait for it to end and see if the path is there then. The lock is
+         * released while waiting, the transaction might be waiting for it.
+         */
+        LockRelease(&tag, ExclusiveLock, false);
+        XactLockTableWait(css->wait_xid, NULL, NULL, XLTW_None);
+    }
+
+    css->created = css->matches == NIL;
+    if (css->created)
+        create_merge_path(css);
+
+    LockRelease(&tag, ExclusiveLock, false);
+
+    css->next_match = list_head(css->matches);
+
+    MemoryContextSwitchTo(old_mcxt);
+}
+
+/*
+ * Get the ids of the vertices bound by the previous clauses, they are the
+ * same for every path of the row.
+ */
+static void read_bound_vertices(cypher_merge_custom_scan_state *css)
+{
+    EState *estate = css->css.ss.ps.state;
+    TupleTableSlot *scantuple =
+        css->css.ss.ps.lefttree->ps_ExprContext->ecxt_scantuple;
+    int i;
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        cypher_target_node *target_node = css->elements[i].node;
+        agtype *a;
+        agtype_value *v;
+        agtype_value *id_value;
+
+        if (!css->elements[i].bound)
+            continue;
+
+        if (scantuple->tts_isnull[target_node->tuple_position - 1])
+            ereport(ERROR,
+                    (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                     errmsg("cannot merge a path with the null vertex of variable %s",
+                            target_node->variable_name)));
+
+        a = DATUM_GET_AGTYPE_P(
+            scantuple->tts_values[target_node->tuple_position - 1]);
+        v = get_ith_agtype_value_from_container(&a->root, 0);
+
+        if (v->type != AGTV_VERTEX)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("agtype must resolve to a vertex")));
+
+        id_value = get_agtype_value_object_value(v, "id");
+
+        css->ids[i] = id_value->val.int_value;
+        css->values[i] = scantuple->tts_values[target_node->tuple_position - 1];
+        css->tuples[i] = NULL;
+        css->assigned[i] = true;
+
+        // the vertex could have been deleted, see create_vertex()
+        if (css->elements[i].source != NULL)
+        {
+            bool is_deleted = false;
+
+            get_entity_heap_tuple(css->elements[i].source, &is_deleted);
+
+            if (is_deleted ||
+                !entity_exists(estate, css->graph_oid, css->ids[i]))
+                ereport(ERROR,
+                        (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                         errmsg("vertex assigned to variable %s was deleted",
+                                target_node->variable_name)));
+        }
+    }
+}
+
+// the path cannot be matched on a null property, it never equals anything
+static void check_null_properties(cypher_merge_element *element,
+                                  agtype *properties)
+{
+    agtype_iterator *it;
+    agtype_iterator_token tok;
+    agtype_value key;
+    agtype_value v;
+
+    if (!AGT_ROOT_IS_OBJECT(properties))
+        return;
+
+    it = agtype_iterator_init(&properties->root);
+
+    while ((tok = agtype_iterator_next(&it, &v, true)) != WAGT_DONE)
+    {
+        if (tok == WAGT_KEY)
+            key = v;
+        else if (tok == WAGT_VALUE && v.type == AGTV_NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                     errmsg("cannot merge %s with the null value of property %.*s",
+                            element->node->type == LABEL_KIND_VERTEX ?
+                                "a vertex" :
+                                "an edge",
+                            key.val.string.len, key.val.string.val)));
+    }
+}
+
+/*
+ * The lock taken while the path of the row is matched and created. It is
+ * the same for every row that has the same pattern: the same labels,
+ * properties, and bound vertices.
+ */
+static void get_merge_lock_tag(cypher_merge_custom_scan_state *css,
+                               LOCKTAG *tag)
+{
+    StringInfoData buf;
+    uint32 hash;
+    int i;
+
+    initStringInfo(&buf);
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        cypher_merge_element *element = &css->elements[i];
+        agtype *properties;
+
+        if (element->bound)
+        {
+            appendBinaryStringInfo(&buf, (char *)&css->ids[i],
+                                   sizeof(graphid));
+            continue;
+        }
+
+        if (element->alias >= 0)
+        {
+            appendBinaryStringInfo(&buf, (char *)&element->alias,
+                                   sizeof(int));
+            continue;
+        }
+
+        appendBinaryStringInfo(&buf, (char *)&element->node->relid,
+                               sizeof(Oid));
+        appendBinaryStringInfo(&buf, (char *)&element->node->dir,
+                               sizeof(cypher_rel_dir));
+
+        properties = get_element_properties(css, i);
+        appendBinaryStringInfo(&buf, VARDATA_ANY(properties),
+                               VARSIZE_ANY_EXHDR(properties));
+    }
+
+    hash = DatumGetUInt32(hash_any((unsigned char *)buf.data, buf.len));
+
+    SET_LOCKTAG_ADVISORY(*tag, MyDatabaseId, css->graph_oid, hash,
+                         MERGE_LOCKTAG_FIELD4);
+
+    pfree(buf.data);
+}
+
+// the properties of the element in the current row of the subtree
+static agtype *get_element_properties(cypher_merge_custom_scan_state *css,
+                                      int i)
+{
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    cypher_target_node *target_node = css->elements[i].node;
+
+    Assert(CYPHER_TARGET_NODE_INSERT_ENTITY(target_node->flags));
+
+    return DATUM_GET_AGTYPE_P(
+        econtext->ecxt_scantuple->tts_values[target_node->prop_attr_num]);
+}
+
+/*
+ * Match the element at the given step of css->order, and the ones after it.
+ * vertex_id is the vertex the edge of the previous step leads to. Returns
+ * false when the matching must start over, once css->wait_xid ends.
+ */
+static bool match_step(cypher_merge_custom_scan_state *css, int step,
+                       graphid vertex_id)
+{
+    if (step == css->num_elements)
+    {
+        add_match(css);
+        return true;
+    }
+
+    if (css->elements[css->order[step]].node->type == LABEL_KIND_EDGE)
+        return match_edges(css, step);
+
+    if (step == 0)
+        return match_first_vertex(css);
+
+    return match_next_vertex(css, step, vertex_id);
+}
+
+/*
+ * Find the candidates of the vertex the path is matched from, with a
+ * property index when there is one, with a scan of the tables otherwise.
+ */
+static bool match_first_vertex(cypher_merge_custom_scan_state *css)
+{
+    int i = css->order[0];
+    cypher_merge_element *element = &css->elements[i];
+    agtype *properties;
+    int label;
+
+    // the variable is bound, it is its only candidate
+    if (element->bound)
+        return match_step(css, 1, css->ids[i]);
+
+    properties = get_element_properties(css, i);
+
+    for (label = 0; label < element->num_labels; label++)
+    {
+        Relation rel = element->label_rels[label];
+        TupleDesc tupdesc = RelationGetDescr(rel);
+        Relation index_rel = NULL;
+        ScanKeyData key;
+        merge_scan scan;
+        HeapTuple tuple;
+        Buffer buffer;
+        ListCell *lc;
+
+        foreach (lc, element->property_indexes)
+        {
+            merge_property_index *property_index = lfirst(lc);
+            agtype_value key_value;
+            agtype_value *value;
+
+            if (property_index->label != label)
+                continue;
+
+            key_value.type = AGTV_STRING;
+            key_value.val.string.val = property_index->key;
+            key_value.val.string.len = strlen(property_index->key);
+
+            value = find_agtype_value_from_container(&properties->root,
+                                                     AGT_FOBJECT, &key_value);
+            if (value == NULL || !IS_A_AGTYPE_SCALAR(value))
+                continue;
+
+            ScanKeyInit(&key, 1, BTEqualStrategyNumber,
+                        property_index->eq_proc,
+                        AGTYPE_P_GET_DATUM(agtype_value_to_agtype(value)));
+            index_rel = property_index->index_rel;
+            break;
+        }
+
+        begin_merge_scan(css, &scan, rel, index_rel,
+                         index_rel != NULL ? &key : NULL);
+
+        while ((tuple = merge_scan_next(&scan, &buffer)) != NULL)
+        {
+            bool isnull;
+            Datum id;
+            Datum props;
+
+            props = heap_getattr(tuple, Anum_ag_label_vertex_table_properties,
+                                 tupdesc, &isnull);
+            if (isnull ||
+                !entity_has_properties(DATUM_GET_AGTYPE_P(props), properties))
+                continue;
+
+            if (must_wait(css))
+            {
+                end_merge_scan(&scan);
+                return false;
+            }
+
+            check_tuple_visible(css, tuple, buffer);
+
+            tuple = heap_copytuple(tuple);
+            id = heap_getattr(tuple, Anum_ag_label_vertex_table_id, tupdesc,
+                              &isnull);
+            props = heap_getattr(tuple, Anum_ag_label_vertex_table_properties,
+                                 tupdesc, &isnull);
+
+            css->ids[i] = DATUM_GET_GRAPHID(id);
+            css->values[i] = make_vertex(
+                id, CStringGetDatum(element->label_names[label]), props);
+            css->tuples[i] = tuple;
+            css->assigned[i] = true;
+
+            if (!match_step(css, 1, css->ids[i]))
+            {
+                end_merge_scan(&scan);
+                return false;
+            }
+
+            css->assigned[i] = false;
+        }
+
+        end_merge_scan(&scan);
+    }
+
+    return true;
+}
+
+// match the vertex the edge of the previous step leads to
+static bool match_next_vertex(cypher_merge_custom_scan_state *css, int step,
+                              graphid vertex_id)
+{
+    int i = css->order[step];
+    cypher_merge_element *element = &css->elements[i];
+    int origin = element->alias >= 0 ? element->alias : i;
+    cypher_merge_element *origin_element = &css->elements[origin];
+    label_cache_data *lcd;
+    Relation rel;
+    TupleDesc tupdesc;
+    ScanKeyData key;
+    merge_scan scan;
+    HeapTuple tuple;
+    Buffer buffer;
+    bool result = true;
+    int label;
+
+    // the vertex is bound or it was already matched earlier in the path
+    if (css->assigned[origin])
+    {
+        if (css->ids[origin] != vertex_id)
+            return true;
+
+        if (origin == i)
+            return match_step(css, step + 1, vertex_id);
+
+        css->ids[i] = vertex_id;
+        css->values[i] = css->values[origin];
+        css->assigned[i] = true;
+
+        result = match_step(css, step + 1, vertex_id);
+
+        css->assigned[i] = false;
+
+        return result;
+    }
+
+    // the vertex must be in one of the tables of the label
+    lcd = search_label_graph_id_cache(css->graph_oid, GET_LABEL_ID(vertex_id));
+    if (lcd == NULL)
+        return true;
+
+    for (label = 0; label < origin_element->num_labels; label++)
+    {
+        if (RelationGetRelid(origin_element->label_rels[label]) ==
+            lcd->relation)
+            break;
+    }
+    if (label == origin_element->num_labels)
+        return true;
+
+    rel = origin_element->label_rels[label];
+    tupdesc = RelationGetDescr(rel);
+
+    if (origin_element->id_index_rels[label] != NULL)
+        ScanKeyInit(&key, 1, BTEqualStrategyNumber, F_GRAPHIDEQ,
+                    GRAPHID_GET_DATUM(vertex_id));
+    else
+        ScanKeyInit(&key, Anum_ag_label_vertex_table_id, BTEqualStrategyNumber,
+                    F_GRAPHIDEQ, GRAPHID_GET_DATUM(vertex_id));
+
+    begin_merge_scan(css, &scan, rel, origin_element->id_index_rels[label],
+                     &key);
+
+    while ((tuple = merge_scan_next(&scan, &buffer)) != NULL)
+    {
+        bool isnull;
+        Datum props;
+
+        props = heap_getattr(tuple, Anum_ag_label_vertex_table_properties,
+                             tupdesc, &isnull);
+        if (isnull ||
+            !entity_has_properties(DATUM_GET_AGTYPE_P(props),
+                                   get_element_properties(css, origin)))
+            continue;
+
+        if (must_wait(css))
+        {
+            result = false;
+            break;
+        }
+
+        check_tuple_visible(css, tuple, buffer);
+
+        tuple = heap_copytuple(tuple);
+        props = heap_getattr(tuple, Anum_ag_label_vertex_table_properties,
+                             tupdesc, &isnull);
+
+        css->ids[origin] = vertex_id;
+        css->values[origin] = make_vertex(
+            GRAPHID_GET_DATUM(vertex_id),
+            CStringGetDatum(origin_element->label_names[label]), props);
+        css->tuples[origin] = tuple;
+        css->assigned[origin] = true;
+
+        // the path is matched backwards, and reached the alias first
+        if (origin != i)
+        {
+            css->ids[i] = vertex_id;
+            css->values[i] = css->values[origin];
+            css->assigned[i] = true;
+        }
+
+        result = match_step(css, step + 1, vertex_id);
+
+        css->assigned[origin] = false;
+        css->assigned[i] = false;
+
+        // there is one vertex with the id
+        break;
+    }
+
+    end_merge_scan(&scan);
+
+    return result;
+}
+
+// match the edges of the vertex of the previous step
+static bool match_edges(cypher_merge_custom_scan_state *css, int step)
+{
+    int i = css->order[step];
+    cypher_merge_element *element = &css->elements[i];
+    graphid from_id = css->ids[css->order[step - 1]];
+    agtype *properties = get_element_properties(css, i);
+    bool forward = css->order[0] == 0;
+    bool from_start;
+    int label;
+
+    /*
+     * The vertex of the previous step is the start of the edge when the
+     * edge points away from it.
+     */
+    from_start = (element->node->dir == CYPHER_REL_DIR_RIGHT) == forward;
+
+    for (label = 0; label < element->num_labels; label++)
+    {
+        Relation rel = element->label_rels[label];
+        TupleDesc tupdesc = RelationGetDescr(rel);
+        Relation index_rel;
+        AttrNumber attnum;
+        ScanKeyData key;
+        merge_scan scan;
+        HeapTuple tuple;
+        Buffer buffer;
+
+        if (from_start)
+        {
+            index_rel = element->start_index_rels[label];
+            attnum = Anum_ag_label_edge_table_start_id;
+        }
+        else
+        {
+            index_rel = element->end_index_rels[label];
+            attnum = Anum_ag_label_edge_table_end_id;
+        }
+
+        ScanKeyInit(&key, index_rel != NULL ? 1 : attnum,
+                    BTEqualStrategyNumber, F_GRAPHIDEQ,
+                    GRAPHID_GET_DATUM(from_id));
+
+        begin_merge_scan(css, &scan, rel, index_rel, &key);
+
+        while ((tuple = merge_scan_next(&scan, &buffer)) != NULL)
+        {
+            Datum values[Natts_ag_label_edge_table];
+            bool isnull;
+            graphid next_id;
+            int j;
+
+            values[edge_tuple_properties] = heap_getattr(
+                tuple, Anum_ag_label_edge_table_properties, tupdesc, &isnull);
+            if (isnull ||
+                !entity_has_properties(
+                    DATUM_GET_AGTYPE_P(values[edge_tuple_properties]),
+                    properties))
+                continue;
+
+            if (must_wait(css))
+            {
+                end_merge_scan(&scan);
+                return false;
+            }
+
+            values[edge_tuple_id] = heap_getattr(
+                tuple, Anum_ag_label_edge_table_id, tupdesc, &isnull);
+
+            // an edge is in the path only once
+            if (edge_in_path(css, DATUM_GET_GRAPHID(values[edge_tuple_id])))
+                continue;
+
+            check_tuple_visible(css, tuple, buffer);
+
+            tuple = heap_copytuple(tuple);
+            for (j = 0; j < Natts_ag_label_edge_table; j++)
+                values[j] = heap_getattr(tuple, j + 1, tupdesc, &isnull);
+
+            if (from_start)
+                next_id = DATUM_GET_GRAPHID(values[edge_tuple_end_id]);
+            else
+                next_id = DATUM_GET_GRAPHID(values[edge_tuple_start_id]);
+
+            css->ids[i] = DATUM_GET_GRAPHID(values[edge_tuple_id]);
+            css->values[i] = make_edge(
+                values[edge_tuple_id], values[edge_tuple_start_id],
+                values[edge_tuple_end_id],
+                CStringGetDatum(element->label_names[label]),
+                values[edge_tuple_properties]);
+            css->tuples[i] = tuple;
+            css->assigned[i] = true;
+
+            if (!match_step(css, step + 1, next_id))
+            {
+                end_merge_scan(&scan);
+                return false;
+            }
+
+            css->assigned[i] = false;
+        }
+
+        end_merge_scan(&scan);
+    }
+
+    return true;
+}
+
+static bool edge_in_path(cypher_merge_custom_scan_state *css, graphid id)
+{
+    int i;
+
+    for (i = 1; i < css->num_elements; i += 2)
+    {
+        if (css->assigned[i] && css->ids[i] == id)
+            return true;
+    }
+
+    return false;
+}
+
+static void begin_merge_scan(cypher_merge_custom_scan_state *css,
+                             merge_scan *scan, Relation rel,
+                             Relation index_rel, ScanKey key)
+{
+    if (index_rel != NULL)
+    {
+        scan->heap_scan = NULL;
+        scan->index_scan = index_beginscan(rel, index_rel,
+                                           &css->dirty_snapshot, 1, 0);
+        index_rescan(scan->index_scan, key, 1, NULL, 0);
+    }
+    else
+    {
+        scan->index_scan = NULL;
+        scan->heap_scan = heap_beginscan(rel, &css->dirty_snapshot,
+                                         key != NULL ? 1 : 0, key);
+    }
+}
+
+// returns the next tuple and the buffer that holds it, NULL at the end
+static HeapTuple merge_scan_next(merge_scan *scan, Buffer *buffer)
+{
+    HeapTuple tuple;
+
+    if (scan->index_scan != NULL)
+    {
+        tuple = index_getnext(scan->index_scan, ForwardScanDirection);
+        *buffer = scan->index_scan->xs_cbuf;
+    }
+    else
+    {
+        tuple = heap_getnext(scan->heap_scan, ForwardScanDirection);
+        *buffer = scan->heap_scan->rs_cbuf;
+    }
+
+    return tuple;
+}
+
+static void end_merge_scan(merge_scan *scan)
+{
+    if (scan->index_scan != NULL)
+        index_endscan(scan->index_scan);
+    else
+        heap_endscan(scan->heap_scan);
+}
+
+/*
+ * Whether the tuple just fetched is being inserted or deleted by another
+ * transaction, the dirty snapshot tells which one. The tuples that do not
+ * match are not waited for.
+ */
+static bool must_wait(cypher_merge_custom_scan_state *css)
+{
+    TransactionId xwait;
+
+    xwait = TransactionIdIsValid(css->dirty_snapshot.xmin) ?
+                css->dirty_snapshot.xmin :
+                css->dirty_snapshot.xmax;
+
+    if (!TransactionIdIsValid(xwait))
+        return false;
+
+    css->wait_xid = xwait;
+
+    return true;
+}
+
+/*
+ * With REPEATABLE READ and SERIALIZABLE, a path cannot be matched on an
+ * entity the snapshot of the transaction does not see, and it cannot be
+ * created either, it is there. Like ExecCheckHeapTupleVisible() does for
+ * INSERT ... ON CONFLICT, report a serialization failure.
+ */
+static void check_tuple_visible(cypher_merge_custom_scan_state *css,
+                                HeapTuple tuple, Buffer buffer)
+{
+    EState *estate = css->css.ss.ps.state;
+
+    if (!IsolationUsesXactSnapshot())
+        return;
+
+    LockBuffer(buffer, BUFFER_LOCK_SHARE);
+    if (!HeapTupleSatisfiesVisibility(tuple, estate->es_snapshot, buffer) &&
+        !TransactionIdIsCurrentTransactionId(
+            HeapTupleHeaderGetXmin(tuple->t_data)))
+        ereport(ERROR,
+                (errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+                 errmsg("could not serialize access due to concurrent update")));
+    LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+}
+
+// add the path in css->values and css->tuples to the matches of the row
+static void add_match(cypher_merge_custom_scan_state *css)
+{
+    merge_match *match = palloc(sizeof(merge_match));
+    int n = css->num_elements;
+
+    match->values = palloc(sizeof(Datum) * n);
+    memcpy(match->values, css->values, sizeof(Datum) * n);
+    match->tuples = palloc(sizeof(HeapTuple) * n);
+    memcpy(match->tuples, css->tuples, sizeof(HeapTuple) * n);
+
+    css->matches = lappend(css->matches, match);
+}
+
+/*
+ * Create the entities of the path the row did not match. The vertices are
+ * created first, the edges need their ids.
+ */
+static void create_merge_path(cypher_merge_custom_scan_state *css)
+{
+    EState *estate = css->css.ss.ps.state;
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    TupleTableSlot *scantuple = econtext->ecxt_scantuple;
+    ResultRelInfo *saved_resultRelInfo = estate->es_result_relation_info;
+    int i;
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        cypher_merge_element *element = &css->elements[i];
+        cypher_target_node *target_node = element->node;
+        TupleTableSlot *elemTupleSlot = target_node->elemTupleSlot;
+        Datum id;
+        Datum props;
+        bool isnull;
+
+        if (target_node->type != LABEL_KIND_VERTEX || element->bound)
+            continue;
+
+        if (element->alias >= 0)
+        {
+            css->ids[i] = css->ids[element->alias];
+            css->values[i] = css->values[element->alias];
+            css->tuples[i] = NULL;
+            continue;
+        }
+
+        estate->es_result_relation_info = target_node->resultRelInfo;
+
+        ExecClearTuple(elemTupleSlot);
+
+        id = ExecEvalExpr(target_node->id_expr_state, econtext, &isnull);
+        props = scantuple->tts_values[target_node->prop_attr_num];
+
+        elemTupleSlot->tts_values[vertex_tuple_id] = id;
+        elemTupleSlot->tts_isnull[vertex_tuple_id] = isnull;
+        elemTupleSlot->tts_values[vertex_tuple_properties] = props;
+        elemTupleSlot->tts_isnull[vertex_tuple_properties] = false;
+
+        css->tuples[i] = heap_copytuple(insert_entity_tuple(
+            target_node->resultRelInfo, elemTupleSlot, estate));
+        css->ids[i] = DATUM_GET_GRAPHID(id);
+        css->values[i] = make_vertex(
+            id, CStringGetDatum(target_node->label_name), props);
+    }
+
+    for (i = 1; i < css->num_elements; i += 2)
+    {
+        cypher_target_node *target_node = css->elements[i].node;
+        TupleTableSlot *elemTupleSlot = target_node->elemTupleSlot;
+        Datum id;
+        Datum start_id;
+        Datum end_id;
+        Datum props;
+        bool isnull;
+
+        if (target_node->dir == CYPHER_REL_DIR_RIGHT)
+        {
+            start_id = GRAPHID_GET_DATUM(css->ids[i - 1]);
+            end_id = GRAPHID_GET_DATUM(css->ids[i + 1]);
+        }
+        else
+        {
+            start_id = GRAPHID_GET_DATUM(css->ids[i + 1]);
+            end_id = GRAPHID_GET_DATUM(css->ids[i - 1]);
+        }
+
+        estate->es_result_relation_info = target_node->resultRelInfo;
+
+        ExecClearTuple(elemTupleSlot);
+
+        id = ExecEvalExpr(target_node->id_expr_state, econtext, &isnull);
+        props = scantuple->tts_values[target_node->prop_attr_num];
+
+        elemTupleSlot->tts_values[edge_tuple_id] = id;
+        elemTupleSlot->tts_isnull[edge_tuple_id] = isnull;
+        elemTupleSlot->tts_values[edge_tuple_start_id] = start_id;
+        elemTupleSlot->tts_isnull[edge_tuple_start_id] = false;
+        elemTupleSlot->tts_values[edge_tuple_end_id] = end_id;
+        elemTupleSlot->tts_isnull[edge_tuple_end_id] = false;
+        elemTupleSlot->tts_values[edge_tuple_properties] = props;
+        elemTupleSlot->tts_isnull[edge_tuple_properties] = false;
+
+        css->tuples[i] = heap_copytuple(insert_entity_tuple(
+            target_node->resultRelInfo, elemTupleSlot, estate));
+        css->ids[i] = DATUM_GET_GRAPHID(id);
+        css->values[i] = make_edge(id, start_id, end_id,
+                                   CStringGetDatum(target_node->label_name),
+                                   props);
+    }
+
+    estate->es_result_relation_info = saved_resultRelInfo;
+
+    add_match(css);
+}
+
+/*
+ * Put the entities of the path in the scan tuple of the subtree, for the
+ * clauses above, along with whether the path was created, for the ON CREATE
+ * SET and ON MATCH SET actions.
+ */
+static void store_merge_match(cypher_merge_custom_scan_state *css,
+                              merge_match *match)
+{
+    TupleTableSlot *scantuple =
+        css->css.ss.ps.lefttree->ps_ExprContext->ecxt_scantuple;
+    List *path_values = NIL;
+    MemoryContext old_mcxt;
+    int i;
+
+    old_mcxt = MemoryContextSwitchTo(css->row_mcxt);
+
+    css->tuple_info = NIL;
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        cypher_target_node *target_node = css->elements[i].node;
+
+        if (CYPHER_TARGET_NODE_IN_PATH(target_node->flags))
+            path_values = lappend(path_values,
+                                  DatumGetPointer(match->values[i]));
+
+        if (!CYPHER_TARGET_NODE_INSERT_ENTITY(target_node->flags))
+            continue;
+
+        /*
+         * The tuple of the variable is recorded, for the clauses above that
+         * update it.
+         */
+        if (target_node->variable_name != NULL)
+            css->tuple_info = add_tuple_info(css->tuple_info,
+                                             match->tuples[i],
+                                             target_node->variable_name);
+
+        if (CYPHER_TARGET_NODE_IS_VARIABLE(target_node->flags))
+        {
+            scantuple->tts_values[target_node->tuple_position - 1] =
+                match->values[i];
+            scantuple->tts_isnull[target_node->tuple_position - 1] = false;
+        }
+    }
+
+    if (css->path->path_attr_num != InvalidAttrNumber)
+    {
+        scantuple->tts_values[css->path->path_attr_num - 1] =
+            make_path(path_values);
+        scantuple->tts_isnull[css->path->path_attr_num - 1] = false;
+    }
+
+    scantuple->tts_values[css->merge_function_attr - 1] =
+        boolean_to_agtype(css->created);
+    scantuple->tts_isnull[css->merge_function_attr - 1] = false;
+
+    MemoryContextSwitchTo(old_mcxt);
+}
+
+static void end_cypher_merge(CustomScanState *node)
+{
+    cypher_merge_custom_scan_state *css =
+        (cypher_merge_custom_scan_state *)node;
+    int i;
+
+    ExecEndNode(node->ss.ps.lefttree);
+
+    for (i = 0; i < css->num_elements; i++)
+    {
+        cypher_merge_element *element = &css->elements[i];
+        cypher_target_node *target_node = element->node;
+        ListCell *lc;
+        int j;
+
+        if (!CYPHER_TARGET_NODE_INSERT_ENTITY(target_node->flags))
+            continue;
+
+        foreach (lc, element->property_indexes)
+        {
+            merge_property_index *property_index = lfirst(lc);
+
+            index_close(property_index->index_rel, AccessShareLock);
+        }
+
+        for (j = 0; j < element->num_labels; j++)
+        {
+            if (element->id_index_rels[j] != NULL)
+                index_close(element->id_index_rels[j], AccessShareLock);
+            if (element->start_index_rels[j] != NULL)
+                index_close(element->start_index_rels[j], AccessShareLock);
+            if (element->end_index_rels[j] != NULL)
+                index_close(element->end_index_rels[j], AccessShareLock);
+
+            heap_close(element->label_rels[j], AccessShareLock);
+        }
+
+        // close all indices for the node
+        ExecCloseIndices(target_node->resultRelInfo);
+
+        // close the relation itself
+        heap_close(target_node->resultRelInfo->ri_RelationDesc,
+                   RowExclusiveLock);
+    }
+}
+
+static void rescan_cypher_merge(CustomScanState *node)
+{
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                    errmsg("cypher merge clause cannot be rescaned"),
+                    errhint("its unsafe to use joins in a query with a Cypher MERGE clause")));
+}
+
+Node *create_cypher_merge_plan_state(CustomScan *cscan)
+{
+    cypher_merge_custom_scan_state *cypher_css =
+        palloc0(sizeof(cypher_merge_custom_scan_state));
+    cypher_merge_information *merge_information;
+    char *serialized_data;
+    Const *c;
+
+    cypher_css->cs = cscan;
+
+    // get the serialized data structure from the Const and deserialize it.
+    c = linitial(cscan->custom_private);
+    serialized_data = (char *)c->constvalue;
+    merge_information = stringToNode(serialized_data);
+
+    Assert(is_ag_node(merge_information, cypher_merge_information));
+
+    cypher_css->flags = merge_information->flags;
+    cypher_css->graph_oid = merge_information->graph_oid;
+    cypher_css->merge_function_attr = merge_information->merge_function_attr;
+    cypher_css->path = merge_information->path;
+    cypher_css->tuple_info = NIL;
+
+    cypher_css->css.ss.ps.type = T_CustomScanState;
+    cypher_css->css.methods = &cypher_merge_exec_methods;
+
+    return (Node *)cypher_css;
+}
@@ -31,6 +31,7 @@
 #include "parser/parsetree.h"
 #include "parser/parse_relation.h"
 #include "rewrite/rewriteHandler.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 
 #include "catalog/ag_label.h"
@@ -40,6 +41,7 @@
 #include "parser/cypher_parse_node.h"
 #include "nodes/cypher_nodes.h"
 #include "utils/agtype.h"
+#include "utils/agtype_ext.h"
 #include "utils/graphid.h"
 
 static void begin_cypher_set(CustomScanState *node, EState *estate,
@@ -49,9 +51,9 @@ static void end_cypher_set(CustomScanState *node);
 static void rescan_cypher_set(CustomScanState *node);
 
 static void process_update_list(CustomScanState *node);
-agtype_value *alter_property_value(agtype_value *properties, char *var_name, agtype *new_v, bool remove_property);
 static HeapTuple update_entity_tuple(ResultRelInfo *resultRelInfo,
-                                TupleTableSlot *elemTupleSlot, EState *estate, HeapTuple old_tuple);
+                                TupleTableSlot *elemTupleSlot, EState *estate,
+                                HeapTuple old_tuple, MemoryContext tuple_mcxt);
 
 const CustomExecMethods cypher_set_exec_methods = {SET_SCAN_STATE_NAME,
                                                       begin_cypher_set,
@@ -73,6 +75,8 @@ static void begin_cypher_set(CustomScanState *node, EState *estate,
     cypher_set_custom_scan_state *css =
         (cypher_set_custom_scan_state *)node;
     Plan *subplan;
+    ListCell *lc;
+    int i;
 
     Assert(list_length(css->cs->custom_plans) == 1);
 
@@ -91,6 +95,22 @@ static void begin_cypher_set(CustomScanState *node, EState *estate,
         ExecAssignProjectionInfo(&node->ss.ps, tupdesc);
     }
 
+    // find where the tuples of the updated variables come from
+    css->item_sources = palloc(sizeof(entity_source *) *
+                               list_length(css->set_list->set_items));
+    i = 0;
+    foreach (lc, css->set_list->set_items)
+    {
+        cypher_update_item *update_item = lfirst(lc);
+
+        css->item_sources[i++] = resolve_entity_source(node,
+                                                       update_item->var_name);
+    }
+
+    css->tuple_info_mcxt = AllocSetContextCreate(estate->es_query_cxt,
+                                                 "cypher set tuple info",
+                                                 ALLOCSET_DEFAULT_SIZES);
+
     /*
      * Postgres does not assign the es_output_cid in queries that do
      * not write to disk, ie: SELECT commands. We need the command id
@@ -106,7 +126,8 @@ static void begin_cypher_set(CustomScanState *node, EState *estate,
 }
 
 static HeapTuple update_entity_tuple(ResultRelInfo *resultRelInfo,
-                                TupleTableSlot *elemTupleSlot, EState *estate, HeapTuple old_tuple)
+                                TupleTableSlot *elemTupleSlot, EState *estate,
+                                HeapTuple old_tuple, MemoryContext tuple_mcxt)
 {
     HeapTuple tuple = NULL;
     LockTupleMode lockmode;
@@ -114,6 +135,7 @@ static HeapTuple update_entity_tuple(ResultRelInfo *resultRelInfo,
     HTSU_Result lock_result;
     HTSU_Result update_result;
     Buffer buffer;
+    MemoryContext old_mcxt;
 
     ResultRelInfo *saved_resultRelInfo = saved_resultRelInfo;;
     estate->es_result_relation_info = resultRelInfo;
@@ -125,8 +147,15 @@ static HeapTuple update_entity_tuple(ResultRelInfo *resultRelInfo,
 
     if (lock_result == HeapTupleMayBeUpdated)
     {
+        /*
+         * The slot is reused for every entity of the label, so the new tuple
+         * is copied out of it. Later clauses find the tuple in tuple_info,
+         * until the copy is freed with the next row.
+         */
         ExecStoreVirtualTuple(elemTupleSlot);
-        tuple = ExecMaterializeSlot(elemTupleSlot);
+        old_mcxt = MemoryContextSwitchTo(tuple_mcxt);
+        tuple = ExecCopySlotTuple(elemTupleSlot);
+        MemoryContextSwitchTo(old_mcxt);
         tuple->t_self = old_tuple->t_self;
 
         // Check the constraints of the tuple
@@ -180,23 +209,6 @@ static void process_all_tuples(CustomScanState *node)
     } while (!TupIsNull(slot));
 }
 
-static bool check_path(agtype_value *path, graphid updated_id)
-{
-    int i;
-
-    for (i = 0; i < path->val.array.num_elems; i++)
-    {
-        agtype_value *elem = &path->val.array.elems[i];
-
-        agtype_value *id = get_agtype_value_object_value(elem, "id");
-
-        if (updated_id == id->val.int_value)
-            return true;
-    }
-
-    return false;
-}
-
 static agtype_value *replace_entity_in_path(agtype_value *path, graphid updated_id, agtype *updated_entity)
 {
     agtype_iterator *it;
@@ -247,34 +259,65 @@ static void update_all_paths(CustomScanState *node, graphid id, agtype *updated_
         (cypher_set_custom_scan_state *)node;
     ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
     TupleTableSlot *scanTupleSlot = econtext->ecxt_scantuple;
+    ListCell *lc;
 
-    int i;
-    for (i = 0; i < scanTupleSlot->tts_tupleDescriptor->natts; i++)
+    // only the columns found to be able to hold paths are searched
+    foreach (lc, css->set_list->path_positions)
     {
-        agtype *original_entity;
-        agtype_value *original_entity_value;
-
-        if (scanTupleSlot->tts_tupleDescriptor->attrs[i].atttypid != AGTYPEOID)
-            continue;
+        int i = lfirst_int(lc) - 1;
+        agtype *original_path;
+        agtype_value *original_path_value;
+        agtype_value *new_path;
 
         if (scanTupleSlot->tts_isnull[i])
             continue;
 
-        original_entity = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[i]);
-        original_entity_value = get_ith_agtype_value_from_container(&original_entity->root, 0);
+        original_path = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[i]);
 
-        if (original_entity_value->type == AGTV_PATH)
-        {
-            if (check_path(original_entity_value, id))
-            {
-                agtype_value *new_path = replace_entity_in_path(original_entity_value, id, updated_entity);
+        if (!ag_path_contains_entity(original_path, id))
+            continue;
 
-                scanTupleSlot->tts_values[i] = AGTYPE_P_GET_DATUM(agtype_value_to_agtype(new_path));
-            }
-        }
+        original_path_value = get_ith_agtype_value_from_container(&original_path->root, 0);
+        new_path = replace_entity_in_path(original_path_value, id, updated_entity);
+
+        scanTupleSlot->tts_values[i] = AGTYPE_P_GET_DATUM(agtype_value_to_agtype(new_path));
     }
 }
 
+/*
+ * The changes a row makes to an entity. All the items of the clause that
+ * update the same entity are applied to one properties map, and the entity is
+ * written once as a single new version of its tuple.
+ *
+ * The entity and its properties are kept serialized. Each item patches the
+ * properties in place with agtype_set_object_key(), rather than rebuilding
+ * the whole map from an agtype_value.
+ */
+typedef struct entity_update
+{
+    graphid id;
+    enum agtype_value_type type; // AGTV_VERTEX or AGTV_EDGE
+    agtype_container *entity; // the vertex or edge before the update
+    agtype *properties; // the properties with the changes applied
+    List *entity_positions; // the columns of the variables of the entity
+    List *var_names;
+    entity_source *source;
+} entity_update;
+
+/*
+ * Look up a field of a serialized vertex or edge.
+ */
+static agtype_value *get_entity_field(agtype_container *entity, char *key)
+{
+    agtype_value key_value;
+
+    key_value.type = AGTV_STRING;
+    key_value.val.string.val = key;
+    key_value.val.string.len = strlen(key);
+
+    return find_agtype_value_from_container(entity, AGT_FOBJECT, &key_value);
+}
+
 static void process_update_list(CustomScanState *node)
 {
     cypher_set_custom_scan_state *css =
@@ -283,22 +326,46 @@ static void process_update_list(CustomScanState *node)
     TupleTableSlot *scanTupleSlot = econtext->ecxt_scantuple;
     ListCell *lc;
     EState *estate = css->css.ss.ps.state;
+    char *clause_name = css->set_list->clause_name;
+    List *updates = NIL;
+    int item_index = -1;
+    MemoryContext old_mcxt;
 
+    // the tuples recorded for the previous row are no longer needed
+    MemoryContextReset(css->tuple_info_mcxt);
     css->tuple_info = NIL;
 
+    /*
+     * ON CREATE SET and ON MATCH SET only update the rows MERGE created the
+     * path of, or the ones it matched the path of.
+     */
+    if (css->set_list->merge_position != InvalidAttrNumber)
+    {
+        int i = css->set_list->merge_position - 1;
+        agtype *created;
+
+        if (scanTupleSlot->tts_isnull[i])
+            return;
+
+        created = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[i]);
+        if (get_ith_agtype_value_from_container(&created->root, 0)->val.boolean !=
+            css->set_list->on_create)
+            return;
+    }
+
+    // apply the changes of every item to the properties of its entity
     foreach (lc, css->set_list->set_items)
     {
-        agtype_value *altered_properties, *original_entity_value, *original_properties, *id, *label;
+        agtype_container *entity;
+        agtype_value *id;
         agtype *original_entity, *new_property_value;
+        enum agtype_value_type entity_type;
         bool remove_property;
-        char *label_name;
         cypher_update_item *update_item = (cypher_update_item *)lfirst(lc);
-        Datum new_entity;
-        HeapTuple heap_tuple;
-        char *clause_name = css->set_list->clause_name;
-        bool is_deleted;
+        entity_update *update = NULL;
+        ListCell *lc2;
 
-        update_item = (cypher_update_item *)lfirst(lc);
+        item_index++;
 
         /*
          * If the entity is null, we can skip this update. this will be
@@ -312,19 +379,55 @@ static void process_update_list(CustomScanState *node)
                     errmsg("age %s clause can only update agtype", clause_name)));
 
         original_entity = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[update_item->entity_position - 1]);
-        original_entity_value = get_ith_agtype_value_from_container(&original_entity->root, 0);
+        entity = ag_get_entity_container(original_entity, &entity_type);
 
-        if (original_entity_value->type != AGTV_VERTEX && original_entity_value->type != AGTV_EDGE)
+        if (entity == NULL)
             ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
                     errmsg("age %s clause can only update vertex and edges", clause_name)));
 
-        // get the id and label for later
-        id = get_agtype_value_object_value(original_entity_value, "id");
-        label = get_agtype_value_object_value(original_entity_value, "label");
-        label_name = pnstrdup(label->val.string.val, label->val.string.len);
+        id = get_entity_field(entity, "id");
 
-        // get the properties we need to update
-        original_properties = get_agtype_value_object_value(original_entity_value, "properties");
+        // find the changes made to the entity by the previous items
+        foreach (lc2, updates)
+        {
+            entity_update *u = lfirst(lc2);
+
+            if (u->id == id->val.int_value)
+            {
+                update = u;
+                break;
+            }
+        }
+
+        if (update == NULL)
+        {
+            agtype_value *properties = get_entity_field(entity, "properties");
+
+            if (properties == NULL || properties->type != AGTV_BINARY ||
+                !AGTYPE_CONTAINER_IS_OBJECT(properties->val.binary.data))
+                ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                                errmsg("can only update objects")));
+
+            update = palloc(sizeof(entity_update));
+            update->id = id->val.int_value;
+            update->type = entity_type;
+            update->entity = entity;
+            update->properties = agtype_value_to_agtype(properties);
+            update->entity_positions = NIL;
+            update->var_names = NIL;
+            update->source = css->item_sources[item_index];
+
+            updates = lappend(updates, update);
+        }
+
+        if (!list_member_int(update->entity_positions, update_item->entity_position))
+        {
+            update->entity_positions = lappend_int(update->entity_positions,
+                                                   update_item->entity_position);
+            if (update_item->var_name != NULL)
+                update->var_names = lappend(update->var_names,
+                                            update_item->var_name);
+        }
 
         /*
          * Determine if the property should be removed.
@@ -339,72 +442,86 @@ static void process_update_list(CustomScanState *node)
         else
             new_property_value = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[update_item->prop_position - 1]);
 
-        altered_properties = alter_property_value(original_properties, update_item->prop_name,
-                                                  new_property_value, remove_property);
+        update->properties = agtype_set_object_key(&update->properties->root,
+                                                    update_item->prop_name,
+                                                    strlen(update_item->prop_name),
+                                                    new_property_value);
+    }
+
+    // write each updated entity once
+    foreach (lc, updates)
+    {
+        entity_update *update = lfirst(lc);
+        agtype_value *id, *label, *startid = NULL, *endid = NULL;
+        char *label_name;
+        Datum new_entity;
+        HeapTuple heap_tuple;
+        ListCell *lc2;
+        bool is_deleted;
+
+        id = get_entity_field(update->entity, "id");
+        label = get_entity_field(update->entity, "label");
+        label_name = pnstrdup(label->val.string.val, label->val.string.len);
 
-        if (original_entity_value->type == AGTV_VERTEX)
+        if (update->type == AGTV_VERTEX)
         {
             new_entity = make_vertex(GRAPHID_GET_DATUM(id->val.int_value),
                                      CStringGetDatum(label_name),
-                                     AGTYPE_P_GET_DATUM(agtype_value_to_agtype(altered_properties)));
+                                     AGTYPE_P_GET_DATUM(update->properties));
         }
-        else if (original_entity_value->type == AGTV_EDGE)
+        else
         {
-            agtype_value *startid = get_agtype_value_object_value(original_entity_value, "start_id");
-            agtype_value *endid = get_agtype_value_object_value(original_entity_value, "end_id");
+            startid = get_entity_field(update->entity, "start_id");
+            endid = get_entity_field(update->entity, "end_id");
 
             new_entity = make_edge(GRAPHID_GET_DATUM(id->val.int_value),
                                    GRAPHID_GET_DATUM(startid->val.int_value),
                                    GRAPHID_GET_DATUM(endid->val.int_value),
                                    CStringGetDatum(label_name),
-                                   AGTYPE_P_GET_DATUM(agtype_value_to_agtype(altered_properties)));
+                                   AGTYPE_P_GET_DATUM(update->properties));
         }
-	else
-	{
-            ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-                    errmsg("age %s clause can only update vertex and edges", clause_name)));
-	}
 
         // update the in-memory tuple slot
-        scanTupleSlot->tts_values[update_item->entity_position - 1] = new_entity;
+        foreach (lc2, update->entity_positions)
+            scanTupleSlot->tts_values[lfirst_int(lc2) - 1] = new_entity;
 
         update_all_paths(node, id->val.int_value, DATUM_GET_AGTYPE_P(new_entity));
 
         // update the on-disc table
-        heap_tuple = get_heap_tuple(node, update_item->var_name, &is_deleted);
+        heap_tuple = get_entity_heap_tuple(update->source, &is_deleted);
 
         if (!is_deleted)
         {
-            ResultRelInfo *resultRelInfo;
+            entity_result_rel_info_entry *entry;
             TupleTableSlot *elemTupleSlot;
             HeapTuple tuple;
 
-            resultRelInfo = create_entity_result_rel_info(estate, css->set_list->graph_name, label_name);
-
-            ExecOpenIndices(resultRelInfo, false);
+            entry = get_entity_result_rel_info(&css->result_rel_infos, estate,
+                                               css->set_list->graph_name,
+                                               label_name);
 
-            elemTupleSlot = ExecInitExtraTupleSlot(estate, RelationGetDescr(resultRelInfo->ri_RelationDesc));
-            if (original_entity_value->type == AGTV_VERTEX)
+            elemTupleSlot = entry->slot;
+            ExecClearTuple(elemTupleSlot);
+            if (update->type == AGTV_VERTEX)
             {
-                elemTupleSlot = populate_vertex_tts(elemTupleSlot, id, altered_properties);
+                elemTupleSlot = populate_vertex_tts(elemTupleSlot, id,
+                                                    update->properties);
             }
-            else if (original_entity_value->type == AGTV_EDGE)
+            else
             {
-                agtype_value *startid = get_agtype_value_object_value(original_entity_value, "start_id");
-                agtype_value *endid = get_agtype_value_object_value(original_entity_value, "end_id");
-
-                elemTupleSlot = populate_edge_tts(elemTupleSlot, id, startid, endid, altered_properties);
+                elemTupleSlot = populate_edge_tts(elemTupleSlot, id, startid,
+                                                  endid, update->properties);
             }
 
-            tuple = update_entity_tuple(resultRelInfo, elemTupleSlot, estate, heap_tuple);
-
-            if (update_item->var_name != NULL)
-                css->tuple_info = add_tuple_info(css->tuple_info, tuple, update_item->var_name);
-
-            ExecCloseIndices(resultRelInfo);
-
-            heap_close(resultRelInfo->ri_RelationDesc, RowExclusiveLock);
+            tuple = update_entity_tuple(entry->resultRelInfo, elemTupleSlot,
+                                        estate, heap_tuple,
+                                        css->tuple_info_mcxt);
 
+            old_mcxt = MemoryContextSwitchTo(css->tuple_info_mcxt);
+            foreach (lc2, update->var_names)
+                css->tuple_info = add_tuple_info(css->tuple_info, tuple,
+                                                 lfirst(lc2));
+            MemoryContextSwitchTo(old_mcxt);
         }
     }
 }
@@ -454,6 +571,12 @@ static TupleTableSlot *exec_cypher_set(CustomScanState *node)
 
 static void end_cypher_set(CustomScanState *node)
 {
+    cypher_set_custom_scan_state *css =
+        (cypher_set_custom_scan_state *)node;
+
+    close_entity_result_rel_infos(css->result_rel_infos);
+    css->result_rel_infos = NULL;
+
     ExecEndNode(node->ss.ps.lefttree);
 }
 
@@ -19,10 +19,16 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "access/htup_details.h"
+#include "access/skey.h"
+#include "access/stratnum.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "access/multixact.h"
+#include "catalog/pg_am_d.h"
+#include "executor/executor.h"
 #include "nodes/extensible.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodes.h"
@@ -31,223 +37,344 @@
 #include "parser/parsetree.h"
 #include "parser/parse_relation.h"
 #include "storage/procarray.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
+#include "utils/relcache.h"
 
 #include "catalog/ag_label.h"
 #include "commands/label_commands.h"
 #include "executor/cypher_executor.h"
 #include "executor/cypher_utils.h"
+#include "utils/ag_cache.h"
 #include "utils/agtype.h"
 #include "utils/graphid.h"
 
-static bool find_scan_state_walker(PlanState *p, void *context);
-static bool inspect_clause_tuple_info(List *tuple_info, char *var_name);
+static bool collect_entity_sources_walker(PlanState *p, void *context);
+static bool clause_may_hold_variable(CustomScanState *css, char *var_name);
+static HeapTuple find_clause_tuple(List *tuple_info, char *var_name,
+                                   bool *found);
+static HeapTuple get_scan_heap_tuple(PlanState *ps);
 
-typedef struct find_scan_state_context {
+typedef struct collect_entity_sources_context
+{
     char *var_name;
-    PlanState *variable_plan_state;
     EState *estate;
-    bool is_deleted;
-} find_scan_state_context;
+    List *sources;
+    bool complete; // a source that always has the tuple has been found
+} collect_entity_sources_context;
 
 /*
- * This function will find the scan state that a variable name
- * is referencing.
+ * Find the plan states below the given clause that can hold the heap tuple of
+ * a variable, in the order they are to be checked: the CREATE, SET, and DELETE
+ * clauses that modify the variable, from the closest one, and then the scan
+ * that read the tuple. This is done once at executor startup so that
+ * get_entity_heap_tuple() does not need to walk the plan state tree for every
+ * row.
  */
-PlanState *find_plan_state(CustomScanState *node, char *var_name, bool *is_deleted)
+entity_source *resolve_entity_source(CustomScanState *node, char *var_name)
 {
-    PlanState *ps;
-    find_scan_state_context *context;
-
-    context = palloc(sizeof(find_scan_state_context));
-    context->var_name = var_name;
-    context->estate = node->ss.ps.state;
-    context->is_deleted = false;
-    context->variable_plan_state = NULL;
-
-    planstate_tree_walker((PlanState *)node, find_scan_state_walker, context);
+    collect_entity_sources_context context;
+    entity_source *source;
 
-    ps = context->variable_plan_state;
+    context.var_name = var_name;
+    context.estate = node->ss.ps.state;
+    context.sources = NIL;
+    context.complete = false;
 
-    if (ps == NULL)
-        ereport(ERROR,
-            (errmsg("cannot find plan state for variable '%s'", var_name)));
+    planstate_tree_walker((PlanState *)node, collect_entity_sources_walker,
+                          &context);
 
-    *is_deleted = context->is_deleted;
+    source = palloc(sizeof(entity_source));
+    source->var_name = var_name;
+    source->plan_states = context.sources;
 
-    return ps;
+    return source;
 }
 
-
-static bool find_scan_state_walker(PlanState *p, void *context)
+static bool collect_entity_sources_walker(PlanState *p, void *context)
 {
-    find_scan_state_context *cnxt = (find_scan_state_context *)context;
-    EState *estate = cnxt->estate;
-    char *var_name = cnxt->var_name;
+    collect_entity_sources_context *cnxt = context;
 
     switch (p->type)
     {
-        case T_CustomScanState:
+    case T_CustomScanState:
+    {
+        CustomScanState *css = (CustomScanState *)p;
+
+        // an Expand reads the tuples of its edge, like a scan of the label
+        if (css->methods == &cypher_expand_exec_methods)
         {
-            CustomScanState *css = (CustomScanState *)p;
-            const struct CustomExecMethods *methods = css->methods;
+            cypher_expand_custom_scan_state *expand_css =
+                (cypher_expand_custom_scan_state *)css;
 
-            if (!strcmp(methods->CustomName, CREATE_SCAN_STATE_NAME))
+            if (strcmp(expand_css->var_name, cnxt->var_name) == 0)
             {
-                cypher_create_custom_scan_state *custom_state = (cypher_create_custom_scan_state *)css;
-                if (inspect_clause_tuple_info(custom_state->tuple_info, var_name))
-                {
-                    cnxt->variable_plan_state = (PlanState *)p;
-                    return true;
-                }
+                cnxt->sources = lappend(cnxt->sources, p);
+                cnxt->complete = true;
+                return true;
             }
-            else if (!strcmp(methods->CustomName, SET_SCAN_STATE_NAME))
+        }
+        // MERGE has the tuple of the variables it declares, matched or not
+        else if (css->methods == &cypher_merge_exec_methods)
+        {
+            if (clause_may_hold_variable(css, cnxt->var_name))
             {
-                cypher_set_custom_scan_state *custom_state = (cypher_set_custom_scan_state *)css;
-                if (inspect_clause_tuple_info(custom_state->tuple_info, var_name))
-                {
-                    cnxt->variable_plan_state = (PlanState *)p;
-                    return true;
-                }
+                cnxt->sources = lappend(cnxt->sources, p);
+                cnxt->complete = true;
+                return true;
             }
-            else if (!strcmp(methods->CustomName, DELETE_SCAN_STATE_NAME))
+        }
+        else if (clause_may_hold_variable(css, cnxt->var_name))
+        {
+            cnxt->sources = lappend(cnxt->sources, p);
+        }
+        break;
+    }
+    case T_AppendState:
+    {
+        List *sources = cnxt->sources;
+
+        /*
+         * The tuple is read by whichever child of the Append is active, so
+         * the Append itself is the source.
+         */
+        cnxt->sources = NIL;
+        planstate_tree_walker(p, collect_entity_sources_walker, context);
+        if (cnxt->sources != NIL)
+        {
+            list_free(cnxt->sources);
+            cnxt->sources = lappend(sources, p);
+        }
+        else
+        {
+            cnxt->sources = sources;
+        }
+
+        return cnxt->complete;
+    }
+    case T_SeqScanState:
+    case T_IndexScanState:
+    case T_BitmapHeapScanState:
+    {
+        Scan *scan = (Scan *)p->plan;
+        RangeTblEntry *rte = rt_fetch(scan->scanrelid,
+                                      cnxt->estate->es_range_table);
+
+        if (rte->alias != NULL &&
+            strcmp(rte->alias->aliasname, cnxt->var_name) == 0)
+        {
+            cnxt->sources = lappend(cnxt->sources, p);
+            cnxt->complete = true;
+        }
+
+        return cnxt->complete;
+    }
+    default:
+        break;
+    }
+
+    return planstate_tree_walker(p, collect_entity_sources_walker, context);
+}
+
+/*
+ * whether the CREATE, SET, DELETE, or MERGE clause records the tuple of the
+ * variable
+ */
+static bool clause_may_hold_variable(CustomScanState *css, char *var_name)
+{
+    ListCell *lc;
+
+    if (css->methods == &cypher_create_exec_methods)
+    {
+        cypher_create_custom_scan_state *create_css =
+            (cypher_create_custom_scan_state *)css;
+
+        foreach (lc, create_css->pattern)
+        {
+            cypher_create_path *path = lfirst(lc);
+            ListCell *lc2;
+
+            foreach (lc2, path->target_nodes)
             {
-                cypher_delete_custom_scan_state *custom_state = (cypher_delete_custom_scan_state *)css;
-                if (inspect_clause_tuple_info(custom_state->tuple_info, var_name))
-                {
-                    cnxt->is_deleted = true;
-                    cnxt->variable_plan_state = (PlanState *)p;
+                cypher_target_node *target_node = lfirst(lc2);
+
+                if (target_node->variable_name != NULL &&
+                    strcmp(target_node->variable_name, var_name) == 0)
                     return true;
-                }
             }
-            break;
         }
-        case T_AppendState:
+    }
+    else if (css->methods == &cypher_set_exec_methods)
+    {
+        cypher_set_custom_scan_state *set_css =
+            (cypher_set_custom_scan_state *)css;
+
+        foreach (lc, set_css->set_list->set_items)
         {
-            if (planstate_tree_walker(p, find_scan_state_walker, context))
-            {
-                AppendState *append = (AppendState *)p;
-                cnxt->variable_plan_state = (PlanState *)append->appendplans[append->as_whichplan];
+            cypher_update_item *item = lfirst(lc);
+
+            if (item->var_name != NULL &&
+                strcmp(item->var_name, var_name) == 0)
                 return true;
-            }
-            else
-            {
-                return false;
-            }
         }
-        case T_SeqScanState:
+    }
+    else if (css->methods == &cypher_delete_exec_methods)
+    {
+        cypher_delete_custom_scan_state *delete_css =
+            (cypher_delete_custom_scan_state *)css;
+
+        foreach (lc, delete_css->delete_data->delete_items)
         {
-            SeqScanState *seq = (SeqScanState *)p;
-            SeqScan *scan = (SeqScan *)seq->ss.ps.plan;
-            RangeTblEntry *rte = rt_fetch(scan->scanrelid, estate->es_range_table);
-            Alias *alias = rte->alias;
+            cypher_delete_item *item = lfirst(lc);
 
-            if (!strcmp(alias->aliasname, var_name))
-            {
-                cnxt->variable_plan_state = (PlanState *)seq;
+            if (strcmp(item->var_name, var_name) == 0)
                 return true;
-            }
+        }
+    }
+    else if (css->methods == &cypher_merge_exec_methods)
+    {
+        cypher_merge_custom_scan_state *merge_css =
+            (cypher_merge_custom_scan_state *)css;
 
-            return false;
+        foreach (lc, merge_css->path->target_nodes)
+        {
+            cypher_target_node *target_node = lfirst(lc);
+
+            // the vertices bound by the previous clauses are not recorded
+            if (CYPHER_TARGET_NODE_INSERT_ENTITY(target_node->flags) &&
+                target_node->variable_name != NULL &&
+                strcmp(target_node->variable_name, var_name) == 0)
+                return true;
         }
-        default:
-            break;
     }
 
-    return planstate_tree_walker(p, find_scan_state_walker, context);
+    return false;
 }
 
 /*
  * In the custom scan states we need to find the heap tuple that we want to
- * modify (CREATE, DELETE, SET, etc). Find the scan state that has most recently
- * modified, if no clause have finds the heap tuple in the original scan state.
+ * modify (CREATE, DELETE, SET, etc). Find the clause that has most recently
+ * modified it, if no clause has, find the heap tuple in the original scan
+ * state.
  */
-HeapTuple get_heap_tuple(CustomScanState *node, char *var_name, bool *is_deleted)
+HeapTuple get_entity_heap_tuple(entity_source *source, bool *is_deleted)
 {
-    PlanState *ps = find_plan_state(node, var_name, is_deleted);
-    HeapTuple heap_tuple = NULL;
+    ListCell *lc;
 
-    switch (ps->type)
+    *is_deleted = false;
+
+    foreach (lc, source->plan_states)
     {
-        case T_CustomScanState:
+        PlanState *ps = lfirst(lc);
+
+        if (IsA(ps, CustomScanState))
         {
             CustomScanState *css = (CustomScanState *)ps;
-            const struct CustomExecMethods *methods = css->methods;
-            List *tuple_info;
-            ListCell *lc;
+            HeapTuple tuple;
+            bool is_delete = false;
+            bool found;
 
-            if (!strcmp(methods->CustomName, CREATE_SCAN_STATE_NAME))
+            if (css->methods == &cypher_expand_exec_methods)
+                return ((cypher_expand_custom_scan_state *)css)->edge_tuple;
+
+            if (css->methods == &cypher_create_exec_methods)
             {
-                cypher_create_custom_scan_state *css = (cypher_create_custom_scan_state *)ps;
-                tuple_info = css->tuple_info;
+                tuple = find_clause_tuple(
+                    ((cypher_create_custom_scan_state *)css)->tuple_info,
+                    source->var_name, &found);
             }
-            else if (!strcmp(methods->CustomName, SET_SCAN_STATE_NAME))
+            else if (css->methods == &cypher_set_exec_methods)
             {
-                cypher_set_custom_scan_state *css = (cypher_set_custom_scan_state *)ps;
-                tuple_info = css->tuple_info;
+                tuple = find_clause_tuple(
+                    ((cypher_set_custom_scan_state *)css)->tuple_info,
+                    source->var_name, &found);
             }
-            else if (!strcmp(methods->CustomName, DELETE_SCAN_STATE_NAME))
+            else if (css->methods == &cypher_merge_exec_methods)
             {
-                cypher_delete_custom_scan_state *css = (cypher_delete_custom_scan_state *)ps;
-                tuple_info = css->tuple_info;
+                tuple = find_clause_tuple(
+                    ((cypher_merge_custom_scan_state *)css)->tuple_info,
+                    source->var_name, &found);
             }
             else
             {
-                ereport(ERROR, (errmsg("cannot extract tuple information from %s", methods->CustomName)));
+                Assert(css->methods == &cypher_delete_exec_methods);
+
+                tuple = find_clause_tuple(
+                    ((cypher_delete_custom_scan_state *)css)->tuple_info,
+                    source->var_name, &found);
+                is_delete = true;
             }
 
-            foreach(lc, tuple_info)
+            if (found)
             {
-                clause_tuple_information *info = lfirst(lc);
-
-                if (!strcmp(info->name, var_name))
-                {
-                    heap_tuple = info->tuple;
-                    break;
-                }
+                *is_deleted = is_delete;
+                return tuple;
             }
-            break;
         }
-        case T_SeqScanState:
+        else if (IsA(ps, AppendState))
         {
-            bool isNull;
-            TupleTableSlot *ss_tts = ((SeqScanState *)ps)->ss.ss_ScanTupleSlot;
-
-            if (!ss_tts->tts_tuple)
-            {
-                heap_tuple = ss_tts->tts_tuple;
-                break;
-            }
-
-            heap_getsysattr(ss_tts->tts_tuple, SelfItemPointerAttributeNumber,
-                            ss_tts->tts_tupleDescriptor, &isNull);
+            AppendState *append = (AppendState *)ps;
 
-            if (isNull)
-                ereport(ERROR, (errmsg("cypher cannot find entity to update")));
-
-            heap_tuple = ss_tts->tts_tuple;
-            break;
+            return get_scan_heap_tuple(append->appendplans[append->as_whichplan]);
+        }
+        else
+        {
+            return get_scan_heap_tuple(ps);
         }
-        default:
-            ereport(ERROR, (errmsg("cannot extract heap tuple from scan state")));
-            break;
     }
 
-    return heap_tuple;
+    ereport(ERROR, (errmsg("cannot find plan state for variable '%s'",
+                           source->var_name)));
+    return NULL;
 }
 
-static bool inspect_clause_tuple_info(List *tuple_info, char *var_name)
+static HeapTuple find_clause_tuple(List *tuple_info, char *var_name,
+                                   bool *found)
 {
     ListCell *lc;
 
-    foreach(lc, tuple_info)
+    foreach (lc, tuple_info)
     {
         clause_tuple_information *info = lfirst(lc);
 
         if (!strcmp(info->name, var_name))
-            return true;
+        {
+            *found = true;
+            return info->tuple;
+        }
     }
-    return false;
+
+    *found = false;
+    return NULL;
+}
+
+static HeapTuple get_scan_heap_tuple(PlanState *ps)
+{
+    TupleTableSlot *ss_tts;
+    bool isNull;
+
+    switch (ps->type)
+    {
+    case T_SeqScanState:
+    case T_IndexScanState:
+    case T_BitmapHeapScanState:
+        ss_tts = ((ScanState *)ps)->ss_ScanTupleSlot;
+        break;
+    default:
+        ereport(ERROR, (errmsg("cannot extract heap tuple from scan state")));
+        return NULL;
+    }
+
+    if (!ss_tts->tts_tuple)
+        return NULL;
+
+    heap_getsysattr(ss_tts->tts_tuple, SelfItemPointerAttributeNumber,
+                    ss_tts->tts_tupleDescriptor, &isNull);
+
+    if (isNull)
+        ereport(ERROR, (errmsg("cypher cannot find entity to update")));
+
+    return ss_tts->tts_tuple;
 }
 
 ResultRelInfo *create_entity_result_rel_info(EState *estate, char *graph_name, char *label_name)
@@ -281,6 +408,221 @@ ResultRelInfo *create_entity_result_rel_info(EState *estate, char *graph_name, c
     return resultRelInfo;
 }
 
+/*
+ * Return the label table of the given label, opened for modification along
+ * with its indexes and a tuple slot of its row type. The table is opened the
+ * first time the label is seen and stays open until
+ * close_entity_result_rel_infos() is called, so that a clause modifying many
+ * entities of a label opens the table only once.
+ */
+entity_result_rel_info_entry *get_entity_result_rel_info(HTAB **result_rel_infos,
+                                                         EState *estate,
+                                                         char *graph_name,
+                                                         char *label_name)
+{
+    entity_result_rel_info_entry *entry;
+    MemoryContext old_mcxt;
+    bool found;
+
+    if (*result_rel_infos == NULL)
+    {
+        HASHCTL hash_ctl;
+
+        MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+        hash_ctl.keysize = NAMEDATALEN;
+        hash_ctl.entrysize = sizeof(entity_result_rel_info_entry);
+        hash_ctl.hcxt = estate->es_query_cxt;
+
+        *result_rel_infos = hash_create("cypher label result relations", 16,
+                                        &hash_ctl, HASH_ELEM | HASH_CONTEXT);
+    }
+
+    entry = hash_search(*result_rel_infos, label_name, HASH_ENTER, &found);
+    if (found)
+        return entry;
+
+    old_mcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+
+    entry->resultRelInfo = create_entity_result_rel_info(estate, graph_name,
+                                                         label_name);
+    ExecOpenIndices(entry->resultRelInfo, false);
+    entry->slot = ExecInitExtraTupleSlot(
+        estate, RelationGetDescr(entry->resultRelInfo->ri_RelationDesc));
+
+    MemoryContextSwitchTo(old_mcxt);
+
+    return entry;
+}
+
+// close the label tables opened by get_entity_result_rel_info()
+void close_entity_result_rel_infos(HTAB *result_rel_infos)
+{
+    HASH_SEQ_STATUS hash_seq;
+    entity_result_rel_info_entry *entry;
+
+    if (result_rel_infos == NULL)
+        return;
+
+    hash_seq_init(&hash_seq, result_rel_infos);
+    while ((entry = hash_seq_search(&hash_seq)) != NULL)
+    {
+        ExecCloseIndices(entry->resultRelInfo);
+        heap_close(entry->resultRelInfo->ri_RelationDesc, RowExclusiveLock);
+    }
+
+    hash_destroy(result_rel_infos);
+}
+
+/*
+ * Find a btree index of the given relation whose first key column is the
+ * given attribute. Partial indexes are skipped because they cannot be used to
+ * find every matching tuple. Returns InvalidOid if there is no such index.
+ */
+Oid find_index_on_column(Relation rel, AttrNumber attnum)
+{
+    List *index_oids;
+    ListCell *lc;
+    Oid result = InvalidOid;
+
+    index_oids = RelationGetIndexList(rel);
+
+    foreach (lc, index_oids)
+    {
+        Oid index_oid = lfirst_oid(lc);
+        Relation index_rel;
+        Form_pg_index index_form;
+
+        index_rel = index_open(index_oid, AccessShareLock);
+        index_form = index_rel->rd_index;
+
+        if (index_rel->rd_rel->relam == BTREE_AM_OID &&
+            IndexIsValid(index_form) &&
+            index_form->indkey.values[0] == attnum &&
+            RelationGetIndexPredicate(index_rel) == NIL)
+            result = index_oid;
+
+        index_close(index_rel, AccessShareLock);
+
+        if (OidIsValid(result))
+            break;
+    }
+
+    list_free(index_oids);
+
+    return result;
+}
+
+// properties @> constraints, see agtype_contains()
+bool entity_has_properties(agtype *properties, agtype *constraints)
+{
+    agtype_iterator *properties_it;
+    agtype_iterator *constraints_it;
+
+    if (AGT_ROOT_IS_OBJECT(properties) != AGT_ROOT_IS_OBJECT(constraints))
+        return false;
+
+    properties_it = agtype_iterator_init(&properties->root);
+    constraints_it = agtype_iterator_init(&constraints->root);
+
+    return agtype_deep_contains(&properties_it, &constraints_it);
+}
+
+/*
+ * Find out if the entity still exists. This is for 'implicit' deletion
+ * of an entity.
+ */
+bool entity_exists(EState *estate, Oid graph_oid, graphid id)
+{
+    label_cache_data *label;
+    ScanKeyData scan_keys[1];
+    HeapTuple tuple;
+    Relation rel;
+    Oid pk_index_oid;
+    bool result = true;
+
+    /*
+     * Extract the label id from the graph id and get the table name
+     * the entity is part of.
+     */
+    label = search_label_graph_id_cache(graph_oid, GET_LABEL_ID(id));
+
+    // Setup the scan key to be the graphid
+    ScanKeyInit(&scan_keys[0], 1, BTEqualStrategyNumber,
+                F_GRAPHIDEQ, GRAPHID_GET_DATUM(id));
+
+    rel = heap_open(label->relation, RowExclusiveLock);
+
+    // probe the primary key on the id column, or scan the table without it
+    pk_index_oid = RelationGetPrimaryKeyIndex(rel);
+    if (OidIsValid(pk_index_oid))
+    {
+        Relation index_rel;
+        IndexScanDesc scan_desc;
+
+        index_rel = index_open(pk_index_oid, AccessShareLock);
+        scan_desc = index_beginscan(rel, index_rel, estate->es_snapshot, 1, 0);
+        index_rescan(scan_desc, scan_keys, 1, NULL, 0);
+
+        tuple = index_getnext(scan_desc, ForwardScanDirection);
+
+        /*
+         * If a single tuple was returned, the tuple is still valid, otherwise'
+         * set to false.
+         */
+        if (!HeapTupleIsValid(tuple))
+            result = false;
+
+        index_endscan(scan_desc);
+        index_close(index_rel, AccessShareLock);
+    }
+    else
+    {
+        HeapScanDesc scan_desc;
+
+        scan_desc = heap_beginscan(rel, estate->es_snapshot, 1, scan_keys);
+
+        tuple = heap_getnext(scan_desc, ForwardScanDirection);
+
+        if (!HeapTupleIsValid(tuple))
+            result = false;
+
+        heap_endscan(scan_desc);
+    }
+
+    heap_close(rel, RowExclusiveLock);
+
+    return result;
+}
+
+/*
+ * Insert the edge/vertex tuple into the table and indices. If the table's
+ * constraints have not been violated.
+ */
+HeapTuple insert_entity_tuple(ResultRelInfo *resultRelInfo,
+                              TupleTableSlot *elemTupleSlot, EState *estate)
+{
+    HeapTuple tuple;
+
+    ExecStoreVirtualTuple(elemTupleSlot);
+    tuple = ExecMaterializeSlot(elemTupleSlot);
+
+    // Check the constraints of the tuple
+    tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
+    if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
+        ExecConstraints(resultRelInfo, elemTupleSlot, estate);
+
+    // Insert the tuple normally
+    heap_insert(resultRelInfo->ri_RelationDesc, tuple, estate->es_output_cid,
+                0, NULL);
+
+    // Insert index entries for the tuple
+    if (resultRelInfo->ri_NumIndices > 0)
+        ExecInsertIndexTuples(elemTupleSlot, &(tuple->t_self), estate, false,
+                              NULL, NIL);
+
+    return tuple;
+}
+
 ItemPointer get_self_item_pointer(TupleTableSlot *tts)
 {
     ItemPointer ip;
@@ -302,7 +644,7 @@ ItemPointer get_self_item_pointer(TupleTableSlot *tts)
 }
 
 TupleTableSlot *populate_vertex_tts(
-    TupleTableSlot *elemTupleSlot, agtype_value *id, agtype_value *properties)
+    TupleTableSlot *elemTupleSlot, agtype_value *id, agtype *properties)
 {
     bool properties_isnull;
 
@@ -316,7 +658,7 @@ TupleTableSlot *populate_vertex_tts(
     elemTupleSlot->tts_isnull[vertex_tuple_id] = false;
 
     elemTupleSlot->tts_values[vertex_tuple_properties] =
-        AGTYPE_P_GET_DATUM(agtype_value_to_agtype(properties));
+        AGTYPE_P_GET_DATUM(properties);
     elemTupleSlot->tts_isnull[vertex_tuple_properties] = properties_isnull;
 
     return elemTupleSlot;
@@ -324,7 +666,7 @@ TupleTableSlot *populate_vertex_tts(
 
 TupleTableSlot *populate_edge_tts(
     TupleTableSlot *elemTupleSlot, agtype_value *id, agtype_value *startid,
-    agtype_value *endid, agtype_value *properties)
+    agtype_value *endid, agtype *properties)
 {
     bool properties_isnull;
 
@@ -355,7 +697,7 @@ TupleTableSlot *populate_edge_tts(
     elemTupleSlot->tts_isnull[edge_tuple_end_id] = false;
 
     elemTupleSlot->tts_values[edge_tuple_properties] =
-        AGTYPE_P_GET_DATUM(agtype_value_to_agtype(properties));
+        AGTYPE_P_GET_DATUM(properties);
     elemTupleSlot->tts_isnull[edge_tuple_properties] = properties_isnull;
 
     return elemTupleSlot;
@@ -0,0 +1,1042 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/skey.h"
+#include "access/stratnum.h"
+#include "catalog/pg_inherits.h"
+#include "commands/explain.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "lib/stringinfo.h"
+#include "nodes/execnodes.h"
+#include "nodes/extensible.h"
+#include "nodes/nodes.h"
+#include "nodes/plannodes.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+#include "catalog/ag_label.h"
+#include "executor/cypher_executor.h"
+#include "executor/cypher_utils.h"
+#include "utils/ag_cache.h"
+#include "utils/ag_func.h"
+#include "utils/agtype.h"
+#include "utils/graphid.h"
+
+/*
+ * The Cypher VLE node returns the paths of a variable length relationship,
+ * like -[:knows*1..5]->, from the vertex given by its start expression.
+ *
+ * The paths are found with an iterative depth-first traversal. The traversal
+ * keeps a level for every edge of the current path, each level holds the
+ * edges of the vertex the path reached at that depth, which are looked up in
+ * the start_id (or end_id) index of the tables of the label. A path is
+ * returned as soon as it is found, so the paths are streamed and the memory
+ * used is bounded by the edges of the vertices on the current path, instead
+ * of the number of paths.
+ *
+ * An edge is in a path only once (relationship uniqueness), the ids of the
+ * edges of the current path are kept in a hash table to check that.
+ *
+ * shortestPath() and allShortestPaths() know the vertex the paths end at, so
+ * they are found with a bidirectional breadth-first search instead. The
+ * search expands the side with the fewer vertices to visit next, one hop at a
+ * time, until the sides meet. The vertices each side reached are kept in a
+ * hash table, with the edges they were reached by, so the paths are built
+ * from the vertices where the sides met.
+ */
+
+typedef struct path_edge_entry
+{
+    graphid id; // hash key
+} path_edge_entry;
+
+// a vertex reached by a side of the bidirectional search
+typedef struct frontier_vertex_entry
+{
+    graphid id; // hash key
+    int depth;
+    // the cypher_vle_edges from the vertices of the depth before
+    List *edges;
+} frontier_vertex_entry;
+
+static void begin_cypher_vle(CustomScanState *node, EState *estate,
+                             int eflags);
+static TupleTableSlot *exec_cypher_vle(CustomScanState *node);
+static void end_cypher_vle(CustomScanState *node);
+static void rescan_cypher_vle(CustomScanState *node);
+static void explain_cypher_vle(CustomScanState *node, List *ancestors,
+                               ExplainState *es);
+
+static Datum get_const_arg(List *args, int n);
+static void begin_label_scan(cypher_vle_custom_scan_state *css,
+                             cypher_vle_scan *scan, int label,
+                             AttrNumber attnum, EState *estate);
+static TupleTableSlot *next_cypher_vle(ScanState *node);
+static bool recheck_cypher_vle(ScanState *node, TupleTableSlot *slot);
+static void start_traversal(cypher_vle_custom_scan_state *css);
+static void end_traversal(cypher_vle_custom_scan_state *css);
+static bool next_path(cypher_vle_custom_scan_state *css);
+static cypher_vle_level *get_level(cypher_vle_custom_scan_state *css,
+                                   int depth);
+static void load_level(cypher_vle_custom_scan_state *css, int depth,
+                       graphid vertex_id);
+static void rescan_edges(cypher_vle_scan *scan, graphid vertex_id);
+static HeapTuple get_next_edge_tuple(cypher_vle_scan *scan);
+static bool read_edge(cypher_vle_custom_scan_state *css,
+                      cypher_vle_scan *scan, HeapTuple tuple, Datum *values);
+static void make_vle_edge(cypher_vle_custom_scan_state *css,
+                          cypher_vle_scan *scan, Datum *values,
+                          cypher_vle_edge *edge);
+static void find_shortest_paths(cypher_vle_custom_scan_state *css);
+static void init_frontier(cypher_vle_frontier *frontier, bool forward,
+                          graphid vertex_id);
+static void expand_frontier(cypher_vle_custom_scan_state *css,
+                            cypher_vle_frontier *frontier);
+static List *get_frontier_paths(cypher_vle_custom_scan_state *css,
+                                cypher_vle_frontier *frontier,
+                                graphid vertex_id);
+static void store_path(cypher_vle_custom_scan_state *css);
+static void store_path_tuple(cypher_vle_custom_scan_state *css,
+                             graphid end_id, List *edges);
+
+const CustomExecMethods cypher_vle_exec_methods = {VLE_SCAN_STATE_NAME,
+                                                   begin_cypher_vle,
+                                                   exec_cypher_vle,
+                                                   end_cypher_vle,
+                                                   rescan_cypher_vle,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   NULL,
+                                                   explain_cypher_vle};
+
+// the edge the current path goes through at the given depth
+#define current_edge(css, d) \
+    (&(css)->levels[(d)].edges[(css)->levels[(d)].next - 1])
+
+/*
+ * Read the label and the bounds of the relationship, and open the tables of
+ * the label with the indexes the edges are looked up in. The start and end
+ * vertices and the property constraints are evaluated when the traversal
+ * starts, they can depend on the outer tuple of a nested loop.
+ */
+static void begin_cypher_vle(CustomScanState *node, EState *estate,
+                             int eflags)
+{
+    cypher_vle_custom_scan_state *css = (cypher_vle_custom_scan_state *)node;
+    List *args = css->cs->custom_exprs;
+    Oid graph_oid;
+    char *label_name;
+    label_cache_data *lcd;
+    List *rel_oids;
+    ListCell *lc;
+    HASHCTL hash_ctl;
+    int i;
+    int j;
+
+    Assert(list_length(args) == VLE_NUM_ARGS);
+
+    css->start_expr = ExecInitExpr(list_nth(args, VLE_ARG_VERTEX_ID),
+                                   &node->ss.ps);
+    css->end_expr = ExecInitExpr(list_nth(args, VLE_ARG_END_VERTEX_ID),
+                                 &node->ss.ps);
+    css->props_expr = ExecInitExpr(list_nth(args, VLE_ARG_PROPERTIES),
+                                   &node->ss.ps);
+
+    graph_oid = DatumGetObjectId(get_const_arg(args, VLE_ARG_GRAPH_OID));
+    label_name = TextDatumGetCString(get_const_arg(args, VLE_ARG_LABEL_NAME));
+    css->dir = DatumGetInt32(get_const_arg(args, VLE_ARG_DIRECTION));
+    css->min_hops = DatumGetInt32(get_const_arg(args, VLE_ARG_MIN_HOPS));
+    css->max_hops = DatumGetInt32(get_const_arg(args, VLE_ARG_MAX_HOPS));
+    css->path_kind = DatumGetInt32(get_const_arg(args, VLE_ARG_PATH_KIND));
+
+    lcd = search_label_name_graph_cache(label_name, graph_oid);
+    if (lcd == NULL)
+        ereport(ERROR, (errcode(ERRCODE_UNDEFINED_OBJECT),
+                        errmsg("label %s does not exists", label_name)));
+
+    // the edges of a label are in its table and in the ones inheriting it
+    rel_oids = find_all_inheritors(lcd->relation, AccessShareLock, NULL);
+
+    css->num_labels = list_length(rel_oids);
+    css->label_rels = palloc(sizeof(Relation) * css->num_labels);
+    css->label_names = palloc(sizeof(char *) * css->num_labels);
+
+    // the bidirectional search goes both ways on the edges
+    if (css->dir == CYPHER_REL_DIR_NONE ||
+        css->path_kind != CYPHER_PATH_DEFAULT)
+        css->num_scans = css->num_labels * 2;
+    else
+        css->num_scans = css->num_labels;
+    css->scans = palloc0(sizeof(cypher_vle_scan) * css->num_scans);
+
+    i = 0;
+    j = 0;
+    foreach (lc, rel_oids)
+    {
+        Oid relid = lfirst_oid(lc);
+
+        lcd = search_label_relation_cache(relid);
+        if (lcd == NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_UNDEFINED_OBJECT),
+                     errmsg("table %s is not a label", get_rel_name(relid))));
+
+        css->label_names[i] = pstrdup(NameStr(lcd->name));
+        css->label_rels[i] = heap_open(relid, AccessShareLock);
+
+        /*
+         * A path follows the edges that start at the vertex it reached when
+         * it goes right, the ones that end there when it goes left, and both
+         * when it has no direction.
+         */
+        if (css->dir != CYPHER_REL_DIR_LEFT ||
+            css->path_kind != CYPHER_PATH_DEFAULT)
+            begin_label_scan(css, &css->scans[j++], i,
+                             Anum_ag_label_edge_table_start_id, estate);
+        if (css->dir != CYPHER_REL_DIR_RIGHT ||
+            css->path_kind != CYPHER_PATH_DEFAULT)
+            begin_label_scan(css, &css->scans[j++], i,
+                             Anum_ag_label_edge_table_end_id, estate);
+        i++;
+    }
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(graphid);
+    hash_ctl.entrysize = sizeof(path_edge_entry);
+    hash_ctl.hcxt = estate->es_query_cxt;
+
+    css->path_edges = hash_create("cypher VLE path edge set", 64, &hash_ctl,
+                                  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    css->start_mcxt = AllocSetContextCreate(estate->es_query_cxt,
+                                            "cypher VLE start",
+                                            ALLOCSET_DEFAULT_SIZES);
+
+    css->num_levels = 0;
+    css->levels = NULL;
+    css->started = false;
+    css->depth = -1;
+    css->shortest_paths = NIL;
+    css->next_shortest_path = NULL;
+}
+
+// the arguments but the vertices and the properties are constants
+static Datum get_const_arg(List *args, int n)
+{
+    Const *c = list_nth(args, n);
+
+    if (!IsA(c, Const) || c->constisnull)
+        ereport(ERROR, (errmsg_internal("invalid argument %d of %s", n + 1,
+                                        VLE_FUNCTION_NAME)));
+
+    return c->constvalue;
+}
+
+/*
+ * Edge labels have indexes on their start_id and end_id columns, unless they
+ * were made when age.create_edge_indexes was off. The table is scanned for
+ * the edges of each vertex without one.
+ */
+static void begin_label_scan(cypher_vle_custom_scan_state *css,
+                             cypher_vle_scan *scan, int label,
+                             AttrNumber attnum, EState *estate)
+{
+    Relation rel = css->label_rels[label];
+    Oid index_oid;
+
+    scan->label = label;
+    scan->attnum = attnum;
+
+    /*
+     * The scans use the snapshot of the estate, so they see the command id
+     * changes of the clauses above, like the scans PostgreSQL makes.
+     */
+    index_oid = find_index_on_column(rel, attnum);
+    if (OidIsValid(index_oid))
+    {
+        scan->index_rel = index_open(index_oid, AccessShareLock);
+        scan->index_scan = index_beginscan(rel, scan->index_rel,
+                                           estate->es_snapshot, 1, 0);
+    }
+    else
+    {
+        scan->heap_scan = heap_beginscan(rel, estate->es_snapshot, 1, NULL);
+    }
+}
+
+static TupleTableSlot *exec_cypher_vle(CustomScanState *node)
+{
+    return ExecScan(&node->ss, next_cypher_vle, recheck_cypher_vle);
+}
+
+// Return the next path from the start vertex in the scan tuple slot.
+static TupleTableSlot *next_cypher_vle(ScanState *node)
+{
+    cypher_vle_custom_scan_state *css = (cypher_vle_custom_scan_state *)node;
+
+    if (!css->started)
+    {
+        start_traversal(css);
+
+        // the path without edges, when zero hops are allowed
+        if (css->path_kind == CYPHER_PATH_DEFAULT && css->depth == 0 &&
+            css->min_hops == 0)
+        {
+            store_path(css);
+            return node->ss_ScanTupleSlot;
+        }
+    }
+
+    // the shortest paths were all found when the traversal started
+    if (css->path_kind != CYPHER_PATH_DEFAULT)
+    {
+        ListCell *lc = css->next_shortest_path;
+
+        if (lc == NULL)
+            return ExecClearTuple(node->ss_ScanTupleSlot);
+
+        css->next_shortest_path = lnext(lc);
+        store_path_tuple(css, css->end_id, lfirst(lc));
+
+        return node->ss_ScanTupleSlot;
+    }
+
+    if (next_path(css))
+    {
+        store_path(css);
+        return node->ss_ScanTupleSlot;
+    }
+
+    return ExecClearTuple(node->ss_ScanTupleSlot);
+}
+
+/*
+ * Evaluate the start vertex and the property constraints, and load the edges
+ * of the start vertex. There are no paths when the start vertex is NULL.
+ *
+ * The shortest paths are all found here, between the start and the end
+ * vertex.
+ */
+static void start_traversal(cypher_vle_custom_scan_state *css)
+{
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    MemoryContext old_mcxt;
+    Datum start_id;
+    Datum end_id;
+    Datum props;
+    bool isnull;
+
+    css->started = true;
+    css->depth = -1;
+
+    MemoryContextReset(css->start_mcxt);
+    css->props = NULL;
+    css->shortest_paths = NIL;
+    css->next_shortest_path = NULL;
+
+    old_mcxt = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+    start_id = ExecEvalExpr(css->start_expr, econtext, &isnull);
+    if (isnull)
+    {
+        MemoryContextSwitchTo(old_mcxt);
+        return;
+    }
+    css->start_id = DATUM_GET_GRAPHID(start_id);
+
+    if (css->path_kind != CYPHER_PATH_DEFAULT)
+    {
+        end_id = ExecEvalExpr(css->end_expr, econtext, &isnull);
+        if (isnull)
+        {
+            MemoryContextSwitchTo(old_mcxt);
+            return;
+        }
+        css->end_id = DATUM_GET_GRAPHID(end_id);
+    }
+
+    props = ExecEvalExpr(css->props_expr, econtext, &isnull);
+    if (!isnull)
+    {
+        agtype *agt = DATUM_GET_AGTYPE_P(props);
+
+        MemoryContextSwitchTo(css->start_mcxt);
+        css->props = (agtype *)datumCopy(PointerGetDatum(agt), false, -1);
+    }
+
+    MemoryContextSwitchTo(old_mcxt);
+
+    if (css->path_kind != CYPHER_PATH_DEFAULT)
+    {
+        old_mcxt = MemoryContextSwitchTo(css->start_mcxt);
+
+        find_shortest_paths(css);
+        css->next_shortest_path = list_head(css->shortest_paths);
+
+        MemoryContextSwitchTo(old_mcxt);
+        return;
+    }
+
+    css->depth = 0;
+
+    if (css->max_hops != 0)
+    {
+        load_level(css, 0, css->start_id);
+    }
+    else
+    {
+        cypher_vle_level *level = get_level(css, 0);
+
+        level->num_edges = 0;
+        level->next = 0;
+    }
+}
+
+// forget the current path, the traversal starts again at the next call
+static void end_traversal(cypher_vle_custom_scan_state *css)
+{
+    int d;
+
+    for (d = 0; d < css->depth; d++)
+        hash_search(css->path_edges, &current_edge(css, d)->id, HASH_REMOVE,
+                    NULL);
+
+    css->started = false;
+    css->depth = -1;
+    css->next_shortest_path = NULL;
+}
+
+/*
+ * Extend the current path with the next edge of the vertex it reached. When
+ * the vertex has no more edges, or the path is as long as it can be, the
+ * path goes back to the vertex before. Returns false when all the paths from
+ * the start vertex were returned.
+ */
+static bool next_path(cypher_vle_custom_scan_state *css)
+{
+    while (css->depth >= 0)
+    {
+        cypher_vle_level *level = &css->levels[css->depth];
+        cypher_vle_edge *edge;
+        bool found;
+
+        if (level->next == level->num_edges)
+        {
+            css->depth--;
+            if (css->depth >= 0)
+                hash_search(css->path_edges, &current_edge(css, css->depth)->id,
+                            HASH_REMOVE, NULL);
+            continue;
+        }
+
+        edge = &level->edges[level->next++];
+
+        hash_search(css->path_edges, &edge->id, HASH_ENTER, &found);
+        if (found)
+            continue;
+
+        css->depth++;
+
+        if (css->max_hops < 0 || css->depth < css->max_hops)
+        {
+            load_level(css, css->depth, edge->next_vertex);
+        }
+        else
+        {
+            level = get_level(css, css->depth);
+            level->num_edges = 0;
+            level->next = 0;
+        }
+
+        if (css->depth >= css->min_hops)
+            return true;
+    }
+
+    return false;
+}
+
+// the levels are made as the paths get longer and reused after that
+static cypher_vle_level *get_level(cypher_vle_custom_scan_state *css,
+                                   int depth)
+{
+    if (depth >= css->num_levels)
+    {
+        MemoryContext query_mcxt = css->css.ss.ps.state->es_query_cxt;
+        int num_levels = Max(css->num_levels * 2, 8);
+        int i;
+
+        if (css->levels == NULL)
+            css->levels = MemoryContextAlloc(query_mcxt,
+                                             sizeof(cypher_vle_level) *
+                                                 num_levels);
+        else
+            css->levels = repalloc(css->levels,
+                                   sizeof(cypher_vle_level) * num_levels);
+
+        for (i = css->num_levels; i < num_levels; i++)
+        {
+            cypher_vle_level *level = &css->levels[i];
+
+            level->mcxt = AllocSetContextCreate(query_mcxt,
+                                                "cypher VLE level",
+                                                ALLOCSET_DEFAULT_SIZES);
+            level->edges = NULL;
+            level->num_edges = 0;
+            level->max_edges = 0;
+            level->next = 0;
+        }
+
+        css->num_levels = num_levels;
+    }
+
+    return &css->levels[depth];
+}
+
+// Replace the edges of the level with the edges of the given vertex.
+static void load_level(cypher_vle_custom_scan_state *css, int depth,
+                       graphid vertex_id)
+{
+    cypher_vle_level *level = get_level(css, depth);
+    MemoryContext old_mcxt;
+    int i;
+
+    MemoryContextReset(level->mcxt);
+    level->edges = NULL;
+    level->num_edges = 0;
+    level->max_edges = 0;
+    level->next = 0;
+
+    old_mcxt = MemoryContextSwitchTo(level->mcxt);
+
+    for (i = 0; i < css->num_scans; i++)
+    {
+        cypher_vle_scan *scan = &css->scans[i];
+        Datum values[Natts_ag_label_edge_table];
+        HeapTuple tuple;
+
+        rescan_edges(scan, vertex_id);
+
+        while ((tuple = get_next_edge_tuple(scan)) != NULL)
+        {
+            if (!read_edge(css, scan, tuple, values))
+                continue;
+
+            if (level->num_edges == level->max_edges)
+            {
+                level->max_edges = Max(level->max_edges * 2, 16);
+                if (level->edges == NULL)
+                    level->edges = palloc(sizeof(cypher_vle_edge) *
+                                          level->max_edges);
+                else
+                    level->edges = repalloc(level->edges,
+                                            sizeof(cypher_vle_edge) *
+                                                level->max_edges);
+            }
+
+            // the edge is built once here, the paths it is in point to it
+            make_vle_edge(css, scan, values,
+                          &level->edges[level->num_edges++]);
+        }
+    }
+
+    MemoryContextSwitchTo(old_mcxt);
+}
+
+// Look up the edges of the vertex in the table of the scan.
+static void rescan_edges(cypher_vle_scan *scan, graphid vertex_id)
+{
+    ScanKeyData scan_key;
+
+    if (scan->index_scan != NULL)
+    {
+        ScanKeyInit(&scan_key, 1, BTEqualStrategyNumber, F_GRAPHIDEQ,
+                    GRAPHID_GET_DATUM(vertex_id));
+        index_rescan(scan->index_scan, &scan_key, 1, NULL, 0);
+    }
+    else
+    {
+        ScanKeyInit(&scan_key, scan->attnum, BTEqualStrategyNumber,
+                    F_GRAPHIDEQ, GRAPHID_GET_DATUM(vertex_id));
+        heap_rescan(scan->heap_scan, &scan_key);
+    }
+}
+
+static HeapTuple get_next_edge_tuple(cypher_vle_scan *scan)
+{
+    if (scan->index_scan != NULL)
+        return index_getnext(scan->index_scan, ForwardScanDirection);
+    else
+        return heap_getnext(scan->heap_scan, ForwardScanDirection);
+}
+
+/*
+ * Read the columns of the edge into values, by attribute number. Returns
+ * false if the paths do not follow the edge, because it does not have the
+ * properties of the relationship.
+ */
+static bool read_edge(cypher_vle_custom_scan_state *css,
+                      cypher_vle_scan *scan, HeapTuple tuple, Datum *values)
+{
+    TupleDesc tupdesc = RelationGetDescr(css->label_rels[scan->label]);
+    bool isnull;
+    int i;
+
+    for (i = 0; i < Natts_ag_label_edge_table; i++)
+        values[i] = heap_getattr(tuple, i + 1, tupdesc, &isnull);
+
+    // without a direction, a loop is found by both of the scans of its table
+    if (css->dir == CYPHER_REL_DIR_NONE &&
+        scan->attnum == Anum_ag_label_edge_table_end_id &&
+        DATUM_GET_GRAPHID(values[edge_tuple_start_id]) ==
+            DATUM_GET_GRAPHID(values[edge_tuple_end_id]))
+        return false;
+
+    if (css->props != NULL &&
+        !entity_has_properties(DATUM_GET_AGTYPE_P(values[edge_tuple_properties]),
+                             css->props))
+        return false;
+
+    return true;
+}
+
+// Make the edge read by read_edge(), in the current memory context.
+static void make_vle_edge(cypher_vle_custom_scan_state *css,
+                          cypher_vle_scan *scan, Datum *values,
+                          cypher_vle_edge *edge)
+{
+    edge->id = DATUM_GET_GRAPHID(values[edge_tuple_id]);
+
+    if (scan->attnum == Anum_ag_label_edge_table_start_id)
+        edge->next_vertex = DATUM_GET_GRAPHID(values[edge_tuple_end_id]);
+    else
+        edge->next_vertex = DATUM_GET_GRAPHID(values[edge_tuple_start_id]);
+
+    edge->edge = DATUM_GET_AGTYPE_P(
+        make_edge(values[edge_tuple_id], values[edge_tuple_start_id],
+                  values[edge_tuple_end_id],
+                  CStringGetDatum(css->label_names[scan->label]),
+                  values[edge_tuple_properties]));
+}
+
+/*
+ * Find the shortest paths from the start vertex to the end vertex with a
+ * bidirectional breadth-first search. The first time the sides meet, after a
+ * side was expanded, every shortest path goes through one of the vertices
+ * the side just reached that the other side reached too.
+ */
+static void find_shortest_paths(cypher_vle_custom_scan_state *css)
+{
+    cypher_vle_frontier forward;
+    cypher_vle_frontier backward;
+    int i;
+
+    if (css->start_id == css->end_id)
+    {
+        // the path without edges
+        if (css->min_hops == 0)
+            css->shortest_paths = list_make1(NIL);
+        return;
+    }
+
+    init_frontier(&forward, true, css->start_id);
+    init_frontier(&backward, false, css->end_id);
+
+    for (;;)
+    {
+        cypher_vle_frontier *frontier;
+        cypher_vle_frontier *other;
+
+        if (css->max_hops >= 0 &&
+            forward.depth + backward.depth >= css->max_hops)
+            return;
+
+        // the side with the fewer vertices has the fewer edges to look up
+        if (forward.num_vertices <= backward.num_vertices)
+        {
+            frontier = &forward;
+            other = &backward;
+        }
+        else
+        {
+            frontier = &backward;
+            other = &forward;
+        }
+
+        // the side cannot go further, so the sides never meet
+        if (frontier->num_vertices == 0)
+            return;
+
+        expand_frontier(css, frontier);
+
+        for (i = 0; i < frontier->num_vertices; i++)
+        {
+            graphid vertex_id = frontier->vertices[i];
+            List *heads;
+            List *tails;
+            ListCell *lc1;
+            ListCell *lc2;
+
+            if (hash_search(other->visited, &vertex_id, HASH_FIND, NULL) ==
+                NULL)
+                continue;
+
+            heads = get_frontier_paths(css, &forward, vertex_id);
+            tails = get_frontier_paths(css, &backward, vertex_id);
+
+            foreach (lc1, heads)
+            {
+                foreach (lc2, tails)
+                {
+                    List *path = list_concat(list_copy(lfirst(lc1)),
+                                             list_copy(lfirst(lc2)));
+
+                    css->shortest_paths = lappend(css->shortest_paths, path);
+
+                    if (css->path_kind == CYPHER_PATH_SHORTEST)
+                        return;
+                }
+            }
+        }
+
+        if (css->shortest_paths != NIL)
+            return;
+    }
+}
+
+static void init_frontier(cypher_vle_frontier *frontier, bool forward,
+                          graphid vertex_id)
+{
+    frontier_vertex_entry *entry;
+    HASHCTL hash_ctl;
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(graphid);
+    hash_ctl.entrysize = sizeof(frontier_vertex_entry);
+    hash_ctl.hcxt = CurrentMemoryContext;
+
+    frontier->forward = forward;
+    frontier->visited = hash_create("cypher VLE frontier", 1024, &hash_ctl,
+                                    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    entry = hash_search(frontier->visited, &vertex_id, HASH_ENTER, NULL);
+    entry->depth = 0;
+    entry->edges = NIL;
+
+    frontier->vertices = palloc(sizeof(graphid));
+    frontier->vertices[0] = vertex_id;
+    frontier->num_vertices = 1;
+    frontier->depth = 0;
+}
+
+/*
+ * Visit the vertices one hop away from the vertices the side reached last. A
+ * vertex is remembered with the edges it is reached by from the vertices of
+ * the depth before, shortestPath() only needs the first one of them.
+ */
+static void expand_frontier(cypher_vle_custom_scan_state *css,
+                            cypher_vle_frontier *frontier)
+{
+    AttrNumber attnum;
+    graphid *vertices;
+    int num_vertices = 0;
+    int max_vertices = 64;
+    int i;
+    int j;
+
+    // the forward side goes like the paths, the other side the opposite way
+    if (css->dir == CYPHER_REL_DIR_NONE)
+        attnum = InvalidAttrNumber;
+    else if ((css->dir == CYPHER_REL_DIR_RIGHT) == frontier->forward)
+        attnum = Anum_ag_label_edge_table_start_id;
+    else
+        attnum = Anum_ag_label_edge_table_end_id;
+
+    vertices = palloc(sizeof(graphid) * max_vertices);
+
+    for (i = 0; i < frontier->num_vertices; i++)
+    {
+        for (j = 0; j < css->num_scans; j++)
+        {
+            cypher_vle_scan *scan = &css->scans[j];
+            Datum values[Natts_ag_label_edge_table];
+            HeapTuple tuple;
+
+            if (attnum != InvalidAttrNumber && scan->attnum != attnum)
+                continue;
+
+            rescan_edges(scan, frontier->vertices[i]);
+
+            while ((tuple = get_next_edge_tuple(scan)) != NULL)
+            {
+                frontier_vertex_entry *entry;
+                cypher_vle_edge *edge;
+                graphid next_vertex;
+                bool found;
+
+                if (!read_edge(css, scan, tuple, values))
+                    continue;
+
+                if (scan->attnum == Anum_ag_label_edge_table_start_id)
+                    next_vertex = DATUM_GET_GRAPHID(values[edge_tuple_end_id]);
+                else
+                    next_vertex =
+                        DATUM_GET_GRAPHID(values[edge_tuple_start_id]);
+
+                entry = hash_search(frontier->visited, &next_vertex,
+                                    HASH_ENTER, &found);
+                if (!found)
+                {
+                    entry->depth = frontier->depth + 1;
+                    entry->edges = NIL;
+
+                    if (num_vertices == max_vertices)
+                    {
+                        max_vertices *= 2;
+                        vertices = repalloc(vertices,
+                                            sizeof(graphid) * max_vertices);
+                    }
+                    vertices[num_vertices++] = next_vertex;
+                }
+                else if (entry->depth <= frontier->depth ||
+                         css->path_kind == CYPHER_PATH_SHORTEST)
+                {
+                    continue;
+                }
+
+                edge = palloc(sizeof(cypher_vle_edge));
+                make_vle_edge(css, scan, values, edge);
+                edge->next_vertex = frontier->vertices[i];
+
+                entry->edges = lappend(entry->edges, edge);
+            }
+        }
+    }
+
+    pfree(frontier->vertices);
+    frontier->vertices = vertices;
+    frontier->num_vertices = num_vertices;
+    frontier->depth++;
+}
+
+/*
+ * The paths, as lists of edges, between the vertex the side started at and
+ * the given vertex the side reached. They are in the order of the paths, so
+ * they start at the given vertex for the backward side.
+ */
+static List *get_frontier_paths(cypher_vle_custom_scan_state *css,
+                                cypher_vle_frontier *frontier,
+                                graphid vertex_id)
+{
+    frontier_vertex_entry *entry;
+    List *paths = NIL;
+    ListCell *lc;
+
+    entry = hash_search(frontier->visited, &vertex_id, HASH_FIND, NULL);
+    Assert(entry != NULL);
+
+    if (entry->depth == 0)
+        return list_make1(NIL);
+
+    foreach (lc, entry->edges)
+    {
+        cypher_vle_edge *edge = lfirst(lc);
+        List *edge_paths;
+        ListCell *lc2;
+
+        edge_paths = get_frontier_paths(css, frontier, edge->next_vertex);
+
+        foreach (lc2, edge_paths)
+        {
+            List *path = lfirst(lc2);
+
+            if (frontier->forward)
+                path = lappend(path, edge->edge);
+            else
+                path = lcons(edge->edge, path);
+
+            paths = lappend(paths, path);
+        }
+    }
+
+    return paths;
+}
+
+// Store the current path of the depth-first traversal.
+static void store_path(cypher_vle_custom_scan_state *css)
+{
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    MemoryContext old_mcxt;
+    List *edges = NIL;
+    graphid end_id;
+    int d;
+
+    old_mcxt = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+    for (d = 0; d < css->depth; d++)
+        edges = lappend(edges, current_edge(css, d)->edge);
+
+    MemoryContextSwitchTo(old_mcxt);
+
+    if (css->depth == 0)
+        end_id = css->start_id;
+    else
+        end_id = current_edge(css, css->depth - 1)->next_vertex;
+
+    store_path_tuple(css, end_id, edges);
+}
+
+/*
+ * The scan tuple is the start vertex, the vertex the path ends at, and the
+ * list of the edges of the path.
+ */
+static void store_path_tuple(cypher_vle_custom_scan_state *css,
+                             graphid end_id, List *edges)
+{
+    TupleTableSlot *slot = css->css.ss.ss_ScanTupleSlot;
+    ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
+    MemoryContext old_mcxt;
+    agtype_parse_state *parse_state = NULL;
+    agtype_value *result;
+    ListCell *lc;
+
+    ExecClearTuple(slot);
+
+    old_mcxt = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+    result = push_agtype_value(&parse_state, WAGT_BEGIN_ARRAY, NULL);
+
+    foreach (lc, edges)
+    {
+        agtype *edge = lfirst(lc);
+
+        result = push_agtype_value(
+            &parse_state, WAGT_ELEM,
+            get_ith_agtype_value_from_container(&edge->root, 0));
+    }
+
+    result = push_agtype_value(&parse_state, WAGT_END_ARRAY, NULL);
+
+    slot->tts_values[0] = GRAPHID_GET_DATUM(css->start_id);
+    slot->tts_isnull[0] = false;
+    slot->tts_values[1] = GRAPHID_GET_DATUM(end_id);
+    slot->tts_isnull[1] = false;
+    slot->tts_values[2] = AGTYPE_P_GET_DATUM(agtype_value_to_agtype(result));
+    slot->tts_isnull[2] = false;
+
+    MemoryContextSwitchTo(old_mcxt);
+
+    ExecStoreVirtualTuple(slot);
+}
+
+// the edges are not locked, there is nothing to recheck
+static bool recheck_cypher_vle(ScanState *node, TupleTableSlot *slot)
+{
+    return true;
+}
+
+static void end_cypher_vle(CustomScanState *node)
+{
+    cypher_vle_custom_scan_state *css = (cypher_vle_custom_scan_state *)node;
+    int i;
+
+    for (i = 0; i < css->num_scans; i++)
+    {
+        cypher_vle_scan *scan = &css->scans[i];
+
+        if (scan->index_scan != NULL)
+        {
+            index_endscan(scan->index_scan);
+            index_close(scan->index_rel, AccessShareLock);
+        }
+        else
+        {
+            heap_endscan(scan->heap_scan);
+        }
+    }
+
+    for (i = 0; i < css->num_labels; i++)
+        heap_close(css->label_rels[i], AccessShareLock);
+
+    for (i = 0; i < css->num_levels; i++)
+        MemoryContextDelete(css->levels[i].mcxt);
+
+    MemoryContextDelete(css->start_mcxt);
+    hash_destroy(css->path_edges);
+}
+
+// the start vertex is evaluated again, it may come from a new outer tuple
+static void rescan_cypher_vle(CustomScanState *node)
+{
+    cypher_vle_custom_scan_state *css = (cypher_vle_custom_scan_state *)node;
+
+    end_traversal(css);
+}
+
+static void explain_cypher_vle(CustomScanState *node, List *ancestors,
+                               ExplainState *es)
+{
+    cypher_vle_custom_scan_state *css = (cypher_vle_custom_scan_state *)node;
+    StringInfo hops = makeStringInfo();
+
+    if (css->dir == CYPHER_REL_DIR_RIGHT)
+        ExplainPropertyText("Direction", "outgoing", es);
+    else if (css->dir == CYPHER_REL_DIR_LEFT)
+        ExplainPropertyText("Direction", "incoming", es);
+    else
+        ExplainPropertyText("Direction", "both", es);
+
+    if (css->max_hops < 0)
+        appendStringInfo(hops, "%d..", css->min_hops);
+    else
+        appendStringInfo(hops, "%d..%d", css->min_hops, css->max_hops);
+
+    ExplainPropertyText("Hops", hops->data, es);
+
+    if (css->path_kind == CYPHER_PATH_SHORTEST)
+        ExplainPropertyText("Paths", "shortest", es);
+    else if (css->path_kind == CYPHER_PATH_ALL_SHORTEST)
+        ExplainPropertyText("Paths", "all shortest", es);
+}
+
+Node *create_cypher_vle_plan_state(CustomScan *cscan)
+{
+    cypher_vle_custom_scan_state *cypher_css =
+        palloc0(sizeof(cypher_vle_custom_scan_state));
+
+    cypher_css->cs = cscan;
+
+    cypher_css->css.ss.ps.type = T_CustomScanState;
+    cypher_css->css.methods = &cypher_vle_exec_methods;
+
+    return (Node *)cypher_css;
+}
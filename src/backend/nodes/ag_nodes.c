@@ -35,10 +35,13 @@ const char *node_names[] = {
     "cypher_return",
     "cypher_with",
     "cypher_match",
+    "cypher_unwind",
     "cypher_create",
     "cypher_set",
     "cypher_set_item",
     "cypher_delete",
+    "cypher_merge",
+    "cypher_create_index",
     "cypher_path",
     "cypher_node",
     "cypher_relationship",
@@ -56,7 +59,8 @@ const char *node_names[] = {
     "cypher_update_information",
     "cypher_update_item",
     "cypher_delete_information",
-    "cypher_delete_item"
+    "cypher_delete_item",
+    "cypher_merge_information"
 };
 
 /*
@@ -94,10 +98,13 @@ const ExtensibleNodeMethods node_methods[] = {
     DEFINE_NODE_METHODS(cypher_return),
     DEFINE_NODE_METHODS(cypher_with),
     DEFINE_NODE_METHODS(cypher_match),
+    DEFINE_NODE_METHODS(cypher_unwind),
     DEFINE_NODE_METHODS(cypher_create),
     DEFINE_NODE_METHODS(cypher_set),
     DEFINE_NODE_METHODS(cypher_set_item),
     DEFINE_NODE_METHODS(cypher_delete),
+    DEFINE_NODE_METHODS(cypher_merge),
+    DEFINE_NODE_METHODS(cypher_create_index),
     DEFINE_NODE_METHODS(cypher_path),
     DEFINE_NODE_METHODS(cypher_node),
     DEFINE_NODE_METHODS(cypher_relationship),
@@ -115,7 +122,8 @@ const ExtensibleNodeMethods node_methods[] = {
     DEFINE_NODE_METHODS_EXTENDED(cypher_update_information),
     DEFINE_NODE_METHODS_EXTENDED(cypher_update_item),
     DEFINE_NODE_METHODS_EXTENDED(cypher_delete_information),
-    DEFINE_NODE_METHODS_EXTENDED(cypher_delete_item)
+    DEFINE_NODE_METHODS_EXTENDED(cypher_delete_item),
+    DEFINE_NODE_METHODS_EXTENDED(cypher_merge_information)
 };
 
 static bool equal_ag_node(const ExtensibleNode *a, const ExtensibleNode *b)
@@ -123,6 +123,9 @@ void copy_cypher_update_information(ExtensibleNode *newnode, const ExtensibleNod
     COPY_SCALAR_FIELD(tuple_position);
     COPY_STRING_FIELD(graph_name);
     COPY_STRING_FIELD(clause_name);
+    COPY_NODE_FIELD(path_positions);
+    COPY_SCALAR_FIELD(merge_position);
+    COPY_SCALAR_FIELD(on_create);
 }
 
 // copy function for cypher_update_item
@@ -158,3 +161,15 @@ void copy_cypher_delete_item(ExtensibleNode *newnode, const ExtensibleNode *from
     COPY_NODE_FIELD(entity_position);
     COPY_STRING_FIELD(var_name);
 }
+
+// copy function for cypher_merge_information
+void copy_cypher_merge_information(ExtensibleNode *newnode, const ExtensibleNode *from)
+{
+    COPY_LOCALS(cypher_merge_information);
+
+    COPY_SCALAR_FIELD(flags);
+    COPY_SCALAR_FIELD(graph_oid);
+    COPY_SCALAR_FIELD(merge_function_attr);
+
+    COPY_NODE_FIELD(path);
+}
@@ -131,6 +131,14 @@ void out_cypher_match(StringInfo str, const ExtensibleNode *node)
     WRITE_NODE_FIELD(where);
 }
 
+// serialization function for the cypher_unwind ExtensibleNode.
+void out_cypher_unwind(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_unwind);
+
+    WRITE_NODE_FIELD(target);
+}
+
 // serialization function for the cypher_create ExtensibleNode.
 void out_cypher_create(StringInfo str, const ExtensibleNode *node)
 {
@@ -146,6 +154,7 @@ void out_cypher_set(StringInfo str, const ExtensibleNode *node)
 
     WRITE_NODE_FIELD(items);
     WRITE_BOOL_FIELD(is_remove);
+    WRITE_ENUM_FIELD(merge_action, cypher_merge_action);
 }
 
 // serialization function for the cypher_set_item ExtensibleNode.
@@ -167,12 +176,34 @@ void out_cypher_delete(StringInfo str, const ExtensibleNode *node)
     WRITE_NODE_FIELD(exprs);
 }
 
+// serialization function for the cypher_merge ExtensibleNode.
+void out_cypher_merge(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_merge);
+
+    WRITE_NODE_FIELD(path);
+    WRITE_NODE_FIELD(actions);
+    WRITE_LOCATION_FIELD(location);
+}
+
+// serialization function for the cypher_create_index ExtensibleNode.
+void out_cypher_create_index(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_create_index);
+
+    WRITE_STRING_FIELD(name);
+    WRITE_STRING_FIELD(label);
+    WRITE_STRING_FIELD(property);
+    WRITE_LOCATION_FIELD(location);
+}
+
 // serialization function for the cypher_path ExtensibleNode.
 void out_cypher_path(StringInfo str, const ExtensibleNode *node)
 {
     DEFINE_AG_NODE(cypher_path);
 
     WRITE_NODE_FIELD(path);
+    WRITE_ENUM_FIELD(kind, cypher_path_kind);
     WRITE_LOCATION_FIELD(location);
 }
 
@@ -323,6 +354,9 @@ void out_cypher_update_information(StringInfo str, const ExtensibleNode *node)
     WRITE_INT32_FIELD(tuple_position);
     WRITE_STRING_FIELD(graph_name);
     WRITE_STRING_FIELD(clause_name);
+    WRITE_NODE_FIELD(path_positions);
+    WRITE_INT32_FIELD(merge_position);
+    WRITE_BOOL_FIELD(on_create);
 }
 
 // serialization function for the cypher_update_item ExtensibleNode.
@@ -359,6 +393,17 @@ void out_cypher_delete_item(StringInfo str, const ExtensibleNode *node)
     WRITE_STRING_FIELD(var_name);
 }
 
+// serialization function for the cypher_merge_information ExtensibleNode.
+void out_cypher_merge_information(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_merge_information);
+
+    WRITE_INT32_FIELD(flags);
+    WRITE_OID_FIELD(graph_oid);
+    WRITE_INT32_FIELD(merge_function_attr);
+    WRITE_NODE_FIELD(path);
+}
+
 /*
  * Copied from Postgres
  *
@@ -229,6 +229,9 @@ void read_cypher_update_information(struct ExtensibleNode *node)
     READ_INT_FIELD(tuple_position);
     READ_STRING_FIELD(graph_name);
     READ_STRING_FIELD(clause_name);
+    READ_NODE_FIELD(path_positions);
+    READ_INT_FIELD(merge_position);
+    READ_BOOL_FIELD(on_create);
 }
 
 /*
@@ -273,3 +276,17 @@ void read_cypher_delete_item(struct ExtensibleNode *node)
     READ_NODE_FIELD(entity_position);
     READ_STRING_FIELD(var_name);
 }
+
+/*
+ * Deserialize a string representing the cypher_merge_information
+ * data structure.
+ */
+void read_cypher_merge_information(struct ExtensibleNode *node)
+{
+    READ_LOCALS(cypher_merge_information);
+
+    READ_INT_FIELD(flags);
+    READ_OID_FIELD(graph_oid);
+    READ_INT_FIELD(merge_function_attr);
+    READ_NODE_FIELD(path);
+}
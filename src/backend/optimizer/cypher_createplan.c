@@ -22,13 +22,17 @@
 #include "access/sysattr.h"
 #include "catalog/pg_type_d.h"
 #include "nodes/extensible.h"
+#include "nodes/makefuncs.h"
 #include "nodes/nodes.h"
 #include "nodes/pg_list.h"
 #include "nodes/plannodes.h"
 #include "nodes/relation.h"
+#include "optimizer/restrictinfo.h"
 
 #include "executor/cypher_executor.h"
 #include "optimizer/cypher_createplan.h"
+#include "utils/agtype.h"
+#include "utils/graphid.h"
 
 const CustomScanMethods cypher_create_plan_methods = {
     "Cypher Create", create_cypher_create_plan_state};
@@ -36,6 +40,12 @@ const CustomScanMethods cypher_set_plan_methods = {
     "Cypher Set", create_cypher_set_plan_state};
 const CustomScanMethods cypher_delete_plan_methods = {
     "Cypher Delete", create_cypher_delete_plan_state};
+const CustomScanMethods cypher_merge_plan_methods = {
+    "Cypher Merge", create_cypher_merge_plan_state};
+const CustomScanMethods cypher_expand_plan_methods = {
+    "Cypher Expand", create_cypher_expand_plan_state};
+const CustomScanMethods cypher_vle_plan_methods = {
+    "Cypher VLE", create_cypher_vle_plan_state};
 
 Plan *plan_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
                               CustomPath *best_path, List *tlist,
@@ -183,3 +193,191 @@ Plan *plan_cypher_delete_path(PlannerInfo *root, RelOptInfo *rel,
     return (Plan *)cs;
 }
 
+Plan *plan_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
+                             CustomPath *best_path, List *tlist,
+                             List *clauses, List *custom_plans)
+{
+    CustomScan *cs;
+    Plan *subplan = linitial(custom_plans);
+
+    cs = makeNode(CustomScan);
+
+    cs->scan.plan.startup_cost = best_path->path.startup_cost;
+    cs->scan.plan.total_cost = best_path->path.total_cost;
+
+    cs->scan.plan.plan_rows = best_path->path.rows;
+    cs->scan.plan.plan_width = 0;
+
+    cs->scan.plan.parallel_aware = best_path->path.parallel_aware;
+    cs->scan.plan.parallel_safe = best_path->path.parallel_safe;
+
+    cs->scan.plan.plan_node_id = 0; // Set later in set_plan_refs
+    cs->scan.plan.targetlist = tlist;
+    cs->scan.plan.qual = NIL;
+    cs->scan.plan.lefttree = NULL;
+    cs->scan.plan.righttree = NULL;
+    cs->scan.plan.initPlan = NIL;
+
+    cs->scan.plan.extParam = NULL;
+    cs->scan.plan.allParam = NULL;
+
+    cs->scan.scanrelid = 0;
+
+    cs->flags = best_path->flags;
+
+    cs->custom_plans = custom_plans;
+    cs->custom_exprs = NIL;
+    cs->custom_private = best_path->custom_private;
+    cs->custom_scan_tlist = subplan->targetlist;
+
+    cs->custom_relids = NULL;
+    cs->methods = &cypher_merge_plan_methods;
+
+    return (Plan *)cs;
+}
+
+/*
+ * Converts the Expand path to its CustomScan. The scan tuple of the node is
+ * the tuple of the outer plan followed by the columns of the edge, the quals,
+ * the target list and the id expressions are evaluated against it.
+ */
+Plan *plan_cypher_expand_path(PlannerInfo *root, RelOptInfo *rel,
+                              CustomPath *best_path, List *tlist,
+                              List *clauses, List *custom_plans)
+{
+    CustomScan *cs;
+    Plan *subplan = linitial(custom_plans);
+    List *custom_exprs = lsecond(best_path->custom_private);
+    List *quals = lthird(best_path->custom_private);
+    List *edge_vars = lfourth(best_path->custom_private);
+    List *scan_tlist = NIL;
+    List *qual = NIL;
+    AttrNumber resno = 1;
+    ListCell *lc;
+
+    foreach (lc, subplan->targetlist)
+    {
+        TargetEntry *te = lfirst(lc);
+
+        scan_tlist = lappend(scan_tlist,
+                             makeTargetEntry(copyObject(te->expr), resno++,
+                                             NULL, false));
+    }
+
+    foreach (lc, edge_vars)
+    {
+        scan_tlist = lappend(scan_tlist,
+                             makeTargetEntry(copyObject(lfirst(lc)), resno++,
+                                             NULL, false));
+    }
+
+    foreach (lc, quals)
+    {
+        RestrictInfo *rinfo = lfirst(lc);
+
+        qual = lappend(qual, rinfo->clause);
+    }
+
+    cs = makeNode(CustomScan);
+
+    cs->scan.plan.startup_cost = best_path->path.startup_cost;
+    cs->scan.plan.total_cost = best_path->path.total_cost;
+
+    cs->scan.plan.plan_rows = best_path->path.rows;
+    cs->scan.plan.plan_width = 0;
+
+    cs->scan.plan.parallel_aware = best_path->path.parallel_aware;
+    cs->scan.plan.parallel_safe = best_path->path.parallel_safe;
+
+    cs->scan.plan.plan_node_id = 0; // Set later in set_plan_refs
+    cs->scan.plan.targetlist = tlist;
+    cs->scan.plan.qual = qual;
+    cs->scan.plan.lefttree = NULL;
+    cs->scan.plan.righttree = NULL;
+    cs->scan.plan.initPlan = NIL;
+
+    cs->scan.plan.extParam = NULL;
+    cs->scan.plan.allParam = NULL;
+
+    cs->scan.scanrelid = 0;
+
+    cs->flags = best_path->flags;
+
+    cs->custom_plans = custom_plans;
+    // the ids of the outer tuple to look the edges up with
+    cs->custom_exprs = copyObject(custom_exprs);
+    // the label tables, their indexes, and the columns to look up
+    cs->custom_private = linitial(best_path->custom_private);
+    cs->custom_scan_tlist = scan_tlist;
+
+    cs->custom_relids = NULL;
+    cs->methods = &cypher_expand_plan_methods;
+
+    return (Plan *)cs;
+}
+
+/*
+ * Converts the VLE path to its CustomScan. The scan tuple of the node has
+ * the columns of the function of the relationship: the start vertex, the end
+ * vertex, and the edges of the path. The arguments of the function are
+ * evaluated by the node, PostgreSQL replaces the references to the outer
+ * relations in them with nested loop parameters.
+ */
+Plan *plan_cypher_vle_path(PlannerInfo *root, RelOptInfo *rel,
+                           CustomPath *best_path, List *tlist,
+                           List *clauses, List *custom_plans)
+{
+    CustomScan *cs;
+    List *scan_tlist;
+
+    scan_tlist = list_make3(
+        makeTargetEntry((Expr *)makeVar(rel->relid, 1, GRAPHIDOID, -1,
+                                        InvalidOid, 0),
+                        1, NULL, false),
+        makeTargetEntry((Expr *)makeVar(rel->relid, 2, GRAPHIDOID, -1,
+                                        InvalidOid, 0),
+                        2, NULL, false),
+        makeTargetEntry((Expr *)makeVar(rel->relid, 3, AGTYPEOID, -1,
+                                        InvalidOid, 0),
+                        3, NULL, false));
+
+    cs = makeNode(CustomScan);
+
+    cs->scan.plan.startup_cost = best_path->path.startup_cost;
+    cs->scan.plan.total_cost = best_path->path.total_cost;
+
+    cs->scan.plan.plan_rows = best_path->path.rows;
+    cs->scan.plan.plan_width = 0;
+
+    cs->scan.plan.parallel_aware = best_path->path.parallel_aware;
+    cs->scan.plan.parallel_safe = best_path->path.parallel_safe;
+
+    cs->scan.plan.plan_node_id = 0; // Set later in set_plan_refs
+    cs->scan.plan.targetlist = tlist;
+    cs->scan.plan.qual = extract_actual_clauses(clauses, false);
+    cs->scan.plan.lefttree = NULL;
+    cs->scan.plan.righttree = NULL;
+    cs->scan.plan.initPlan = NIL;
+
+    cs->scan.plan.extParam = NULL;
+    cs->scan.plan.allParam = NULL;
+
+    /*
+     * The rel is a function, there is no table for PostgreSQL to open, so
+     * the scan tuple is described by the custom_scan_tlist.
+     */
+    cs->scan.scanrelid = 0;
+
+    cs->flags = best_path->flags;
+
+    cs->custom_plans = custom_plans;
+    // the arguments of the function, see cypher_vle.c
+    cs->custom_exprs = copyObject(best_path->custom_private);
+    cs->custom_private = NIL;
+    cs->custom_scan_tlist = scan_tlist;
+
+    cs->custom_relids = NULL;
+    cs->methods = &cypher_vle_plan_methods;
+
+    return (Plan *)cs;
+}
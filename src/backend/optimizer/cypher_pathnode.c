@@ -23,6 +23,8 @@
 #include "nodes/nodes.h"
 #include "nodes/pg_list.h"
 #include "nodes/relation.h"
+#include "optimizer/cost.h"
+#include "optimizer/pathnode.h"
 
 #include "optimizer/cypher_createplan.h"
 #include "optimizer/cypher_pathnode.h"
@@ -33,6 +35,12 @@ const CustomPathMethods cypher_set_path_methods = {
     SET_PATH_NAME, plan_cypher_set_path, NULL};
 const CustomPathMethods cypher_delete_path_methods = {
     DELETE_PATH_NAME, plan_cypher_delete_path, NULL};
+const CustomPathMethods cypher_merge_path_methods = {
+    MERGE_PATH_NAME, plan_cypher_merge_path, NULL};
+const CustomPathMethods cypher_expand_path_methods = {
+    EXPAND_PATH_NAME, plan_cypher_expand_path, NULL};
+const CustomPathMethods cypher_vle_path_methods = {
+    VLE_PATH_NAME, plan_cypher_vle_path, NULL};
 
 
 CustomPath *create_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
@@ -150,3 +158,145 @@ CustomPath *create_cypher_delete_path(PlannerInfo *root, RelOptInfo *rel,
     return cp;
 }
 
+/*
+ * Creates a Merge Path. Makes the original path a child of the new path. We
+ * leave it to the caller to replace the pathlist of the rel.
+ */
+CustomPath *create_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
+                                     List *custom_private)
+{
+    CustomPath *cp;
+
+    cp = makeNode(CustomPath);
+
+    cp->path.pathtype = T_CustomScan;
+
+    cp->path.parent = rel;
+    cp->path.pathtarget = rel->reltarget;
+
+    cp->path.param_info = NULL;
+
+    // Do not allow parallel methods
+    cp->path.parallel_aware = false;
+    cp->path.parallel_safe = false;
+    cp->path.parallel_workers = 0;
+
+    cp->path.rows = 0;
+    cp->path.startup_cost = 0;
+    cp->path.total_cost = 0;
+
+    // No output ordering for MERGE
+    cp->path.pathkeys = NULL;
+
+    // Disable all custom flags for now
+    cp->flags = 0;
+
+    // Make the original paths the children of the new path
+    cp->custom_paths = rel->pathlist;
+    // Store the metadata Merge will need in the execution phase.
+    cp->custom_private = custom_private;
+    // Tells Postgres how to turn this path to the correct CustomScan
+    cp->methods = &cypher_merge_path_methods;
+
+    return cp;
+}
+
+/*
+ * Creates an Expand Path, a join of the outer path with an edge label table.
+ * The edges are looked up by the executor, so the outer path is the only
+ * child of the new path. The caller adds it to the join rel.
+ */
+CustomPath *create_cypher_expand_path(PlannerInfo *root, RelOptInfo *joinrel,
+                                      Path *outer_path, List *pathkeys,
+                                      Cost startup_cost, Cost total_cost,
+                                      List *custom_private)
+{
+    CustomPath *cp;
+
+    cp = makeNode(CustomPath);
+
+    cp->path.pathtype = T_CustomScan;
+
+    cp->path.parent = joinrel;
+    cp->path.pathtarget = joinrel->reltarget;
+
+    cp->path.param_info = NULL;
+
+    // Do not allow parallel methods
+    cp->path.parallel_aware = false;
+    cp->path.parallel_safe = false;
+    cp->path.parallel_workers = 0;
+
+    cp->path.rows = joinrel->rows;
+    cp->path.startup_cost = startup_cost;
+    cp->path.total_cost = total_cost;
+
+    // The edges of each outer tuple are returned together, in outer order
+    cp->path.pathkeys = pathkeys;
+
+    // Disable all custom flags for now
+    cp->flags = 0;
+
+    cp->custom_paths = list_make1(outer_path);
+    cp->custom_private = custom_private;
+    cp->methods = &cypher_expand_path_methods;
+
+    return cp;
+}
+
+/*
+ * Creates a VLE Path, a scan of the paths of a variable length relationship.
+ * The start vertex comes from the relations in required_outer, so the path
+ * is on the inner side of a nested loop, like a FunctionScan with a lateral
+ * reference.
+ */
+CustomPath *create_cypher_vle_path(PlannerInfo *root, RelOptInfo *rel,
+                                   Relids required_outer,
+                                   List *custom_private)
+{
+    CustomPath *cp;
+    Cost cost_per_path;
+
+    cp = makeNode(CustomPath);
+
+    cp->path.pathtype = T_CustomScan;
+
+    cp->path.parent = rel;
+    cp->path.pathtarget = rel->reltarget;
+
+    cp->path.param_info = get_baserel_parampathinfo(root, rel,
+                                                    required_outer);
+
+    // Do not allow parallel methods
+    cp->path.parallel_aware = false;
+    cp->path.parallel_safe = false;
+    cp->path.parallel_workers = 0;
+
+    if (cp->path.param_info)
+        cp->path.rows = cp->path.param_info->ppi_rows;
+    else
+        cp->path.rows = rel->rows;
+
+    /*
+     * Nothing is read before the first path is found, and every path ends
+     * with an edge that was looked up in an index.
+     */
+    cost_per_path = random_page_cost + cpu_index_tuple_cost + cpu_tuple_cost +
+                    rel->baserestrictcost.per_tuple;
+
+    cp->path.startup_cost = rel->baserestrictcost.startup;
+    cp->path.total_cost = cp->path.startup_cost +
+                          cp->path.rows * cost_per_path;
+
+    // The paths are returned in the order they are found
+    cp->path.pathkeys = NIL;
+
+    // Disable all custom flags for now
+    cp->flags = 0;
+
+    cp->custom_paths = NIL;
+    cp->custom_private = custom_private;
+    cp->methods = &cypher_vle_path_methods;
+
+    return cp;
+}
@@ -19,27 +19,44 @@
 
 #include "postgres.h"
 
+#include <math.h>
+
+#include "access/stratnum.h"
 #include "access/sysattr.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_am_d.h"
 #include "catalog/pg_type_d.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
 #include "nodes/parsenodes.h"
 #include "nodes/primnodes.h"
 #include "nodes/relation.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/var.h"
+#include "utils/lsyscache.h"
 
+#include "catalog/ag_label.h"
 #include "optimizer/cypher_pathnode.h"
 #include "optimizer/cypher_paths.h"
+#include "utils/ag_cache.h"
 #include "utils/ag_func.h"
+#include "utils/ag_guc.h"
+#include "utils/graphid.h"
 
 typedef enum cypher_clause_kind
 {
     CYPHER_CLAUSE_NONE,
     CYPHER_CLAUSE_CREATE,
     CYPHER_CLAUSE_SET,
-    CYPHER_CLAUSE_DELETE
+    CYPHER_CLAUSE_DELETE,
+    CYPHER_CLAUSE_MERGE
 } cypher_clause_kind;
 
 static set_rel_pathlist_hook_type prev_set_rel_pathlist_hook;
+static set_join_pathlist_hook_type prev_set_join_pathlist_hook;
 
 static void set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
                              RangeTblEntry *rte);
@@ -50,6 +67,23 @@ static void handle_cypher_set_clause(PlannerInfo *root, RelOptInfo *rel,
                                      Index rti, RangeTblEntry *rte);
 static void handle_cypher_delete_clause(PlannerInfo *root, RelOptInfo *rel,
                                         Index rti, RangeTblEntry *rte);
+static void handle_cypher_merge_clause(PlannerInfo *root, RelOptInfo *rel,
+                                       Index rti, RangeTblEntry *rte);
+static bool is_cypher_vle_rte(RangeTblEntry *rte);
+static void handle_cypher_vle(PlannerInfo *root, RelOptInfo *rel, Index rti,
+                              RangeTblEntry *rte);
+static void set_join_pathlist(PlannerInfo *root, RelOptInfo *joinrel,
+                              RelOptInfo *outerrel, RelOptInfo *innerrel,
+                              JoinType jointype, JoinPathExtraData *extra);
+static void add_cypher_expand_path(PlannerInfo *root, RelOptInfo *joinrel,
+                                   RelOptInfo *outerrel, RelOptInfo *innerrel,
+                                   JoinPathExtraData *extra);
+static bool is_edge_label_relation(RelOptInfo *rel, Oid relid);
+static AttrNumber match_edge_id_clause(RestrictInfo *rinfo,
+                                       RelOptInfo *outerrel,
+                                       RelOptInfo *innerrel, Expr **outer_expr);
+static IndexOptInfo *find_edge_id_index(RelOptInfo *rel, AttrNumber attnum,
+                                        Oid opno);
 
 void set_rel_pathlist_init(void)
 {
@@ -62,6 +96,25 @@ void set_rel_pathlist_fini(void)
     set_rel_pathlist_hook = prev_set_rel_pathlist_hook;
 }
 
+void set_join_pathlist_init(void)
+{
+    prev_set_join_pathlist_hook = set_join_pathlist_hook;
+    set_join_pathlist_hook = set_join_pathlist;
+}
+
+void set_join_pathlist_fini(void)
+{
+    set_join_pathlist_hook = prev_set_join_pathlist_hook;
+}
+
+/*
+ * The paths of the updating clauses replace every other path of their rel,
+ * including its partial paths. Their functions are PARALLEL UNSAFE, since
+ * writes are not allowed in parallel mode, so a query with an updating clause
+ * is never planned with parallelism and there are no partial paths to keep.
+ * Read-only queries are left alone and get parallel plans when the planner
+ * finds them cheaper.
+ */
 static void set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
                              RangeTblEntry *rte)
 {
@@ -79,11 +132,17 @@ static void set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
     case CYPHER_CLAUSE_DELETE:
         handle_cypher_delete_clause(root, rel, rti, rte);
         break;
+    case CYPHER_CLAUSE_MERGE:
+        handle_cypher_merge_clause(root, rel, rti, rte);
+        break;
     case CYPHER_CLAUSE_NONE:
         break;
     default:
         ereport(ERROR, (errmsg_internal("invalid cypher_clause_kind")));
     }
+
+    if (is_cypher_vle_rte(rte))
+        handle_cypher_vle(root, rel, rti, rte);
 }
 
 /*
@@ -119,6 +178,8 @@ static cypher_clause_kind get_cypher_clause_kind(RangeTblEntry *rte)
         return CYPHER_CLAUSE_SET;
     if (is_oid_ag_func(fe->funcid, DELETE_CLAUSE_FUNCTION_NAME))
         return CYPHER_CLAUSE_DELETE;
+    if (is_oid_ag_func(fe->funcid, MERGE_CLAUSE_FUNCTION_NAME))
+        return CYPHER_CLAUSE_MERGE;
     else
         return CYPHER_CLAUSE_NONE;
 }
@@ -199,3 +260,424 @@ static void handle_cypher_set_clause(PlannerInfo *root, RelOptInfo *rel,
 
     add_path(rel, (Path *)cp);
 }
+
+// replace all possible paths with our CustomPath
+static void handle_cypher_merge_clause(PlannerInfo *root, RelOptInfo *rel,
+                                       Index rti, RangeTblEntry *rte)
+{
+    TargetEntry *te;
+    FuncExpr *fe;
+    List *custom_private;
+    CustomPath *cp;
+
+    // Add the pattern to the CustomPath
+    te = (TargetEntry *)llast(rte->subquery->targetList);
+    fe = (FuncExpr *)te->expr;
+    // pass the const that holds the data structure to the path.
+    custom_private = fe->args;
+
+    cp = create_cypher_merge_path(root, rel, custom_private);
+
+    // Discard any pre-existing paths
+    rel->pathlist = NIL;
+    rel->partial_pathlist = NIL;
+
+    add_path(rel, (Path *)cp);
+}
+
+// whether the rte is the function of a variable length relationship
+static bool is_cypher_vle_rte(RangeTblEntry *rte)
+{
+    RangeTblFunction *rtfunc;
+    FuncExpr *fe;
+
+    if (rte->rtekind != RTE_FUNCTION || list_length(rte->functions) != 1)
+        return false;
+
+    rtfunc = linitial(rte->functions);
+    if (!IsA(rtfunc->funcexpr, FuncExpr))
+        return false;
+
+    fe = (FuncExpr *)rtfunc->funcexpr;
+
+    return is_oid_ag_func(fe->funcid, VLE_FUNCTION_NAME);
+}
+
+/*
+ * A variable length relationship of MATCH is a function in the FROM clause
+ * that takes the id of the vertex its paths start from, see
+ * transform_cypher_vle_edge(). The function only marks where the paths go,
+ * its FunctionScan path is replaced by a VLE path that finds the paths. Like
+ * the FunctionScan, the path is parameterized by the relations the start
+ * vertex comes from.
+ */
+static void handle_cypher_vle(PlannerInfo *root, RelOptInfo *rel, Index rti,
+                              RangeTblEntry *rte)
+{
+    RangeTblFunction *rtfunc = linitial(rte->functions);
+    FuncExpr *fe = (FuncExpr *)rtfunc->funcexpr;
+    CustomPath *cp;
+
+    // pass the arguments of the function to the path
+    cp = create_cypher_vle_path(root, rel, rel->lateral_relids, fe->args);
+
+    // Discard any pre-existing paths
+    rel->pathlist = NIL;
+    rel->partial_pathlist = NIL;
+
+    add_path(rel, (Path *)cp);
+}
+
+/*
+ * Offer an Expand path for the inner joins of a relation with an edge label
+ * table. The paths of the join planner are kept, the cheapest one wins.
+ */
+static void set_join_pathlist(PlannerInfo *root, RelOptInfo *joinrel,
+                              RelOptInfo *outerrel, RelOptInfo *innerrel,
+                              JoinType jointype, JoinPathExtraData *extra)
+{
+    if (prev_set_join_pathlist_hook)
+        prev_set_join_pathlist_hook(root, joinrel, outerrel, innerrel,
+                                    jointype, extra);
+
+    if (age_enable_expand && jointype == JOIN_INNER)
+        add_cypher_expand_path(root, joinrel, outerrel, innerrel, extra);
+}
+
+/*
+ * A MATCH pattern joins an edge to the vertex before it with a clause like
+ * e.start_id = a.id. When the inner relation of the join is an edge label
+ * table and one of the join clauses is such a clause, the join can be done
+ * by an Expand node: for each tuple of the outer relation, the edges of the
+ * vertex are looked up in the start_id (or end_id) index of every table of
+ * the label. The outer relation is read once and the edges are streamed, so
+ * long patterns are a pipeline of Expand nodes instead of a tree of hash
+ * tables.
+ */
+static void add_cypher_expand_path(PlannerInfo *root, RelOptInfo *joinrel,
+                                   RelOptInfo *outerrel, RelOptInfo *innerrel,
+                                   JoinPathExtraData *extra)
+{
+    Path *outer_path = outerrel->cheapest_total_path;
+    RangeTblEntry *rte;
+    RestrictInfo *key_rinfo = NULL;
+    RestrictInfo *into_rinfo = NULL;
+    Expr *key_expr = NULL;
+    Expr *into_expr = NULL;
+    AttrNumber key_attnum = InvalidAttrNumber;
+    AttrNumber into_attnum = InvalidAttrNumber;
+    AttrNumber attnum;
+    List *quals = NIL;
+    List *label_rels = NIL;
+    List *indexes = NIL;
+    List *rel_oids = NIL;
+    List *index_oids = NIL;
+    List *edge_vars = NIL;
+    List *custom_exprs;
+    List *custom_private;
+    char *var_name;
+    ListCell *lc;
+    ListCell *lc2;
+    Selectivity key_selectivity;
+    QualCost qual_cost;
+    double fetched_edges;
+    Cost startup_cost;
+    Cost run_cost;
+    CustomPath *cp;
+
+    if (innerrel->reloptkind != RELOPT_BASEREL ||
+        innerrel->rtekind != RTE_RELATION || IS_DUMMY_REL(innerrel))
+        return;
+
+    // the outer relation is read once, it cannot depend on another relation
+    if (outer_path == NULL || PATH_REQ_OUTER(outer_path) != NULL ||
+        !bms_is_empty(joinrel->lateral_relids) ||
+        root->placeholder_list != NIL)
+        return;
+
+    rte = planner_rt_fetch(innerrel->relid, root);
+    if (!is_edge_label_relation(innerrel, rte->relid))
+        return;
+
+    /*
+     * The first clause on start_id or end_id is used to look up the edges.
+     * If there is one on the other column too, both ends of the edge are
+     * already bound and the other end is checked before the edge is
+     * returned (expand into). The rest of the clauses are filters.
+     */
+    foreach (lc, extra->restrictlist)
+    {
+        RestrictInfo *rinfo = lfirst(lc);
+        Expr *expr;
+
+        attnum = match_edge_id_clause(rinfo, outerrel, innerrel, &expr);
+
+        if (attnum != InvalidAttrNumber && key_rinfo == NULL)
+        {
+            key_rinfo = rinfo;
+            key_expr = expr;
+            key_attnum = attnum;
+        }
+        else if (attnum != InvalidAttrNumber && into_rinfo == NULL &&
+                 attnum != key_attnum &&
+                 ((OpExpr *)rinfo->clause)->opno ==
+                     ((OpExpr *)key_rinfo->clause)->opno)
+        {
+            into_rinfo = rinfo;
+            into_expr = expr;
+            into_attnum = attnum;
+        }
+        else
+        {
+            quals = lappend(quals, rinfo);
+        }
+    }
+
+    if (key_rinfo == NULL)
+        return;
+
+    quals = list_concat(quals, list_copy(innerrel->baserestrictinfo));
+
+    // the scan tuple has the user columns of the edge and nothing else
+    foreach (lc, pull_var_clause((Node *)list_make2(quals,
+                                                    innerrel->reltarget->exprs),
+                                 PVC_RECURSE_PLACEHOLDERS))
+    {
+        Var *var = lfirst(lc);
+
+        if (var->varno == innerrel->relid &&
+            (var->varattno < 1 || var->varattno > innerrel->max_attr))
+            return;
+    }
+
+    if (rte->inh)
+    {
+        foreach (lc, root->append_rel_list)
+        {
+            AppendRelInfo *appinfo = lfirst(lc);
+            RelOptInfo *childrel;
+
+            if (appinfo->parent_relid != innerrel->relid)
+                continue;
+
+            childrel = root->simple_rel_array[appinfo->child_relid];
+            if (childrel == NULL || IS_DUMMY_REL(childrel))
+                continue;
+
+            // the tables of the label must have the columns of the parent
+            attnum = 1;
+            foreach (lc2, appinfo->translated_vars)
+            {
+                Var *var = lfirst(lc2);
+
+                if (var == NULL || !IsA(var, Var) || var->varattno != attnum)
+                    return;
+                attnum++;
+            }
+
+            label_rels = lappend(label_rels, childrel);
+        }
+    }
+    else
+    {
+        label_rels = list_make1(innerrel);
+    }
+
+    foreach (lc, label_rels)
+    {
+        RelOptInfo *label_rel = lfirst(lc);
+        IndexOptInfo *index;
+
+        index = find_edge_id_index(label_rel, key_attnum,
+                                   ((OpExpr *)key_rinfo->clause)->opno);
+        if (index == NULL)
+            return;
+
+        indexes = lappend(indexes, index);
+        rel_oids = lappend_oid(rel_oids,
+                               planner_rt_fetch(label_rel->relid, root)->relid);
+        index_oids = lappend_oid(index_oids, index->indexoid);
+    }
+
+    if (rel_oids == NIL)
+        return;
+
+    for (attnum = 1; attnum <= innerrel->max_attr; attnum++)
+    {
+        Oid typid;
+        int32 typmod;
+        Oid collid;
+
+        get_atttypetypmodcoll(rte->relid, attnum, &typid, &typmod, &collid);
+        if (!OidIsValid(typid))
+            return;
+
+        edge_vars = lappend(edge_vars, makeVar(innerrel->relid, attnum, typid,
+                                               typmod, collid, 0));
+    }
+
+    /*
+     * Every outer tuple costs a descent of the index of each table of the
+     * label, as in btcostestimate(). The heap pages of the edges are costed
+     * like the inner index scan of a nested loop, the same pages are likely
+     * to be read again for other outer tuples.
+     */
+    key_selectivity = clause_selectivity(root, (Node *)key_rinfo, 0,
+                                         JOIN_INNER, extra->sjinfo);
+    fetched_edges = clamp_row_est(outer_path->rows * innerrel->tuples *
+                                  key_selectivity);
+    cost_qual_eval(&qual_cost, quals, root);
+
+    startup_cost = outer_path->startup_cost + qual_cost.startup +
+                   joinrel->reltarget->cost.startup;
+    run_cost = outer_path->total_cost - outer_path->startup_cost;
+
+    forboth (lc, label_rels, lc2, indexes)
+    {
+        RelOptInfo *label_rel = lfirst(lc);
+        IndexOptInfo *index = lfirst(lc2);
+        double edges = fetched_edges;
+        double descent_cost;
+
+        if (innerrel->tuples > 0)
+            edges *= label_rel->tuples / innerrel->tuples;
+
+        descent_cost = (ceil(log(Max(index->tuples, 2.0)) / log(2.0)) +
+                        (Max(index->tree_height, 0) + 1) * 50.0) *
+                       cpu_operator_cost;
+
+        run_cost += outer_path->rows * descent_cost;
+        run_cost += index_pages_fetched(edges, label_rel->pages,
+                                        (double)index->pages, root) *
+                    random_page_cost;
+    }
+
+    run_cost += fetched_edges * (cpu_index_tuple_cost + cpu_tuple_cost +
+                                 qual_cost.per_tuple);
+    run_cost += joinrel->rows * joinrel->reltarget->cost.per_tuple;
+
+    custom_exprs = list_make1(key_expr);
+    if (into_rinfo != NULL)
+        custom_exprs = lappend(custom_exprs, into_expr);
+
+    // the name of the variable is needed by SET and DELETE, see cypher_utils.c
+    if (rte->alias != NULL)
+        var_name = rte->alias->aliasname;
+    else
+        var_name = "";
+
+    custom_private = list_make4(list_make5(rel_oids, index_oids,
+                                           makeInteger(key_attnum),
+                                           makeInteger(into_attnum),
+                                           makeString(pstrdup(var_name))),
+                                custom_exprs, quals, edge_vars);
+
+    cp = create_cypher_expand_path(root, joinrel, outer_path,
+                                   build_join_pathkeys(root, joinrel,
+                                                       JOIN_INNER,
+                                                       outer_path->pathkeys),
+                                   startup_cost, startup_cost + run_cost,
+                                   custom_private);
+
+    add_path(joinrel, (Path *)cp);
+}
+
+/*
+ * Whether the relation is the table of an edge label. The hook is called for
+ * every join of every query, so the columns are checked before the label
+ * cache is searched.
+ */
+static bool is_edge_label_relation(RelOptInfo *rel, Oid relid)
+{
+    label_cache_data *label;
+
+    if (rel->max_attr != Anum_ag_label_edge_table_properties ||
+        !OidIsValid(get_namespace_oid("ag_catalog", true)) ||
+        get_atttype(relid, Anum_ag_label_edge_table_start_id) != GRAPHIDOID)
+        return false;
+
+    label = search_label_relation_cache(relid);
+
+    return label != NULL && label->kind == LABEL_KIND_EDGE;
+}
+
+/*
+ * If the clause is an equality between the start_id or end_id column of the
+ * edge and an expression of the outer relation, return the column and set
+ * outer_expr to the expression.
+ */
+static AttrNumber match_edge_id_clause(RestrictInfo *rinfo,
+                                       RelOptInfo *outerrel,
+                                       RelOptInfo *innerrel, Expr **outer_expr)
+{
+    OpExpr *op;
+    Expr *edge_arg;
+    Var *var;
+
+    if (rinfo->pseudoconstant || rinfo->mergeopfamilies == NIL ||
+        !is_opclause(rinfo->clause) ||
+        list_length(((OpExpr *)rinfo->clause)->args) != 2)
+        return InvalidAttrNumber;
+
+    op = (OpExpr *)rinfo->clause;
+
+    if (bms_is_subset(rinfo->left_relids, outerrel->relids) &&
+        bms_equal(rinfo->right_relids, innerrel->relids))
+    {
+        *outer_expr = linitial(op->args);
+        edge_arg = lsecond(op->args);
+    }
+    else if (bms_is_subset(rinfo->right_relids, outerrel->relids) &&
+             bms_equal(rinfo->left_relids, innerrel->relids))
+    {
+        *outer_expr = lsecond(op->args);
+        edge_arg = linitial(op->args);
+    }
+    else
+    {
+        return InvalidAttrNumber;
+    }
+
+    // the expression is evaluated once per outer tuple
+    if (contain_volatile_functions((Node *)*outer_expr))
+        return InvalidAttrNumber;
+
+    if (!IsA(edge_arg, Var))
+        return InvalidAttrNumber;
+
+    var = (Var *)edge_arg;
+
+    if (var->varattno != Anum_ag_label_edge_table_start_id &&
+        var->varattno != Anum_ag_label_edge_table_end_id)
+        return InvalidAttrNumber;
+
+    // the ids are compared as graphids when the edges are read
+    if (exprType((Node *)*outer_expr) != var->vartype)
+        return InvalidAttrNumber;
+
+    return var->varattno;
+}
+
+/*
+ * Find a btree index of the label table whose first key column is the given
+ * column and whose operator family has the given equality operator. Partial
+ * indexes are skipped, see find_index_on_column().
+ */
+static IndexOptInfo *find_edge_id_index(RelOptInfo *rel, AttrNumber attnum,
+                                        Oid opno)
+{
+    ListCell *lc;
+
+    foreach (lc, rel->indexlist)
+    {
+        IndexOptInfo *index = lfirst(lc);
+
+        if (index->relam == BTREE_AM_OID && index->indpred == NIL &&
+            index->indexkeys[0] == attnum &&
+            get_op_opfamily_strategy(opno, index->opfamily[0]) ==
+                BTEqualStrategyNumber)
+            return index;
+    }
+
+    return NULL;
+}
@@ -20,6 +20,7 @@
 #include "postgres.h"
 
 #include "access/sysattr.h"
+#include "catalog/pg_collation.h"
 #include "catalog/pg_type_d.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
@@ -40,6 +41,7 @@
 #include "parser/parse_target.h"
 #include "parser/parsetree.h"
 #include "rewrite/rewriteHandler.h"
+#include "utils/builtins.h"
 #include "utils/typcache.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
@@ -73,11 +75,16 @@
  * Also, keep these here as nothing outside of this file needs to know these.
  */
 #define AGE_VARNAME_CREATE_CLAUSE AGE_DEFAULT_VARNAME_PREFIX"create_clause"
+#define AGE_VARNAME_CREATE_INDEX_CLAUSE AGE_DEFAULT_VARNAME_PREFIX"create_index_clause"
 #define AGE_VARNAME_CREATE_NULL_VALUE AGE_DEFAULT_VARNAME_PREFIX"create_null_value"
 #define AGE_VARNAME_DELETE_CLAUSE AGE_DEFAULT_VARNAME_PREFIX"delete_clause"
 #define AGE_VARNAME_ID AGE_DEFAULT_VARNAME_PREFIX"id"
+#define AGE_VARNAME_MERGE_CLAUSE AGE_DEFAULT_VARNAME_PREFIX"merge_clause"
 #define AGE_VARNAME_SET_CLAUSE AGE_DEFAULT_VARNAME_PREFIX"set_clause"
 
+// the column of the variable length relationship function with the edges
+#define AG_VLE_COLNAME_EDGES "edges"
+
 enum transform_entity_type
 {
     ENT_VERTEX = 0x0,
@@ -147,6 +154,8 @@ typedef struct
 #define INCLUDE_NODE_IN_JOIN_TREE(path, node) \
     (path->var_name || node->name || node->props)
 
+#define IS_VARLEN_REL(rel) (((cypher_relationship *)(rel))->varlen != NULL)
+
 typedef Query *(*transform_method)(cypher_parsestate *cpstate,
                                    cypher_clause *clause);
 
@@ -177,11 +186,26 @@ static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
                                       cypher_path *path);
 static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
                                     List *pattern);
+static void add_entity_column_targets(cypher_parsestate *cpstate,
+                                      Query *query);
 static List *transform_match_path(cypher_parsestate *cpstate, Query *query,
                                   cypher_path *path);
 static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
                                    cypher_relationship *rel,
                                    List **target_list);
+static void transform_edge_label(cypher_parsestate *cpstate,
+                                 cypher_relationship *rel);
+static List *transform_match_shortest_path_entities(cypher_parsestate *cpstate,
+                                                   Query *query,
+                                                   cypher_path *path);
+static Expr *transform_cypher_vle_edge(cypher_parsestate *cpstate,
+                                       cypher_relationship *rel,
+                                       transform_entity *prev_node,
+                                       transform_entity *next_node,
+                                       cypher_path_kind kind,
+                                       List **target_list);
+static Node *make_vertex_id_arg(cypher_parsestate *cpstate,
+                                transform_entity *entity);
 static Expr *transform_cypher_node(cypher_parsestate *cpstate,
                                    cypher_node *node, List **target_list,
                                    bool output_node);
@@ -189,18 +213,19 @@ static Node *make_vertex_expr(cypher_parsestate *cpstate, RangeTblEntry *rte,
                               char *label);
 static Node *make_edge_expr(cypher_parsestate *cpstate, RangeTblEntry *rte,
                             char *label);
-static FuncCall *make_qual(cypher_parsestate *cpstate,
-                           transform_entity *entity, char *name);
+static Node *make_qual(cypher_parsestate *cpstate,
+                       transform_entity *entity, char *name);
+static Node *make_agtype_qual(Node *qual);
 static TargetEntry *
 transform_match_create_path_variable(cypher_parsestate *cpstate,
                                      cypher_path *path, List *entities);
 static List *make_path_join_quals(cypher_parsestate *cpstate, List *entities);
 static List *make_directed_edge_join_conditions(
     cypher_parsestate *cpstate, transform_entity *prev_entity,
-    transform_entity *next_entity, FuncCall *prev_qual, FuncCall *next_qual,
+    transform_entity *next_entity, Node *prev_qual, Node *next_qual,
     char *prev_node_label, char *next_node_label);
 static List *join_to_entity(cypher_parsestate *cpstate,
-                            transform_entity *entity, FuncCall *qual,
+                            transform_entity *entity, Node *qual,
                             enum transform_entity_join_side side);
 static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
                                           transform_entity *prev_edge,
@@ -212,7 +237,7 @@ static List *make_edge_quals(cypher_parsestate *cpstate,
                              transform_entity *edge,
                              enum transform_entity_join_side side);
 static A_Expr *filter_vertices_on_label_id(cypher_parsestate *cpstate,
-                                           FuncCall *id_field, char *label);
+                                           Node *id_field, char *label);
 static transform_entity *
 make_transform_entity(cypher_parsestate *cpstate,
                       enum transform_entity_type type, Node *node, Expr *expr);
@@ -221,11 +246,15 @@ static Node *create_property_constraint_function(cypher_parsestate *cpstate,
                                                  transform_entity *entity,
                                                  Node *property_constraints);
 static TargetEntry *findTarget(List *targetList, char *resname);
+// unwind clause
+static Query *transform_cypher_unwind(cypher_parsestate *cpstate,
+                                      cypher_clause *clause);
 // create clause
 static Query *transform_cypher_create(cypher_parsestate *cpstate,
                                       cypher_clause *clause);
 static List *transform_cypher_create_pattern(cypher_parsestate *cpstate,
                                              Query *query, List *pattern);
+static bool has_delete_clause(cypher_clause *clause);
 static cypher_create_path *
 transform_cypher_create_path(cypher_parsestate *cpstate, List **target_list,
                              cypher_path *cp);
@@ -252,6 +281,11 @@ static TargetEntry *placeholder_target_entry(cypher_parsestate *cpstate,
                                              char *name);
 static Query *transform_cypher_sub_pattern(cypher_parsestate *cpstate,
                                            cypher_clause *clause);
+// merge clause
+static Query *transform_cypher_merge(cypher_parsestate *cpstate,
+                                     cypher_clause *clause);
+static void check_cypher_merge_path(cypher_parsestate *cpstate,
+                                    cypher_path *path);
 // set and remove clause
 static Query *transform_cypher_set(cypher_parsestate *cpstate,
                                    cypher_clause *clause);
@@ -261,12 +295,17 @@ static cypher_update_information *transform_cypher_set_item_list(cypher_parsesta
 static cypher_update_information *transform_cypher_remove_item_list(cypher_parsestate *cpstate,
                                                                     List *remove_item_list,
                                                                     Query *query);
+static List *get_path_positions(List *rtable, List *target_list);
+static bool expr_may_hold_path(List *rtable, Expr *expr);
 // delete
 static Query *transform_cypher_delete(cypher_parsestate *cpstate,
                                       cypher_clause *clause);
 static List *transform_cypher_delete_item_list(cypher_parsestate *cpstate,
                                                List *delete_item_list,
                                                Query *query);
+// create index
+static Query *transform_cypher_create_index(cypher_parsestate *cpstate,
+                                            cypher_clause *clause);
 // transform
 #define PREV_CYPHER_CLAUSE_ALIAS "_"
 #define transform_prev_cypher_clause(cpstate, prev_clause) \
@@ -317,12 +356,18 @@ Query *transform_cypher_clause(cypher_parsestate *cpstate,
         return transform_cypher_with(cpstate, clause);
     else if (is_ag_node(self, cypher_match))
         return transform_cypher_match(cpstate, clause);
+    else if (is_ag_node(self, cypher_unwind))
+        result = transform_cypher_unwind(cpstate, clause);
     else if (is_ag_node(self, cypher_create))
         result = transform_cypher_create(cpstate, clause);
     else if (is_ag_node(self, cypher_set))
         return transform_cypher_set(cpstate, clause);
+    else if (is_ag_node(self, cypher_merge))
+        return transform_cypher_merge(cpstate, clause);
     else if (is_ag_node(self, cypher_delete))
         return transform_cypher_delete(cpstate, clause);
+    else if (is_ag_node(self, cypher_create_index))
+        result = transform_cypher_create_index(cpstate, clause);
     else if (is_ag_node(self, cypher_sub_pattern))
         result = transform_cypher_sub_pattern(cpstate, clause);
     else
@@ -467,6 +512,91 @@ static List *transform_cypher_delete_item_list(cypher_parsestate *cpstate,
     return items;
 }
 
+/*
+ * Transform the CREATE INDEX clause into a call to the set returning function
+ * that creates the index when the query is executed. The function returns no
+ * rows, like the other updating clauses do when they end the query.
+ */
+static Query *transform_cypher_create_index(cypher_parsestate *cpstate,
+                                            cypher_clause *clause)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    cypher_create_index *self = (cypher_create_index *)clause->self;
+    label_cache_data *lcd;
+    NameData *graph_name;
+    NameData *label_name;
+    Const *index_name;
+    Const *property_name;
+    FuncExpr *func_expr;
+    Oid func_oid;
+    Query *query;
+    TargetEntry *tle;
+
+    if (clause->prev || clause->next)
+    {
+        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                        errmsg("CREATE INDEX cannot be combined with other clauses"),
+                        parser_errposition(pstate, self->location)));
+    }
+
+    lcd = search_label_name_graph_cache(self->label, cpstate->graph_oid);
+    if (lcd == NULL)
+    {
+        ereport(ERROR, (errcode(ERRCODE_UNDEFINED_TABLE),
+                        errmsg("label %s does not exists", self->label),
+                        parser_errposition(pstate, self->location)));
+    }
+
+    graph_name = palloc(sizeof(NameData));
+    namestrcpy(graph_name, cpstate->graph_name);
+    label_name = palloc(sizeof(NameData));
+    namestrcpy(label_name, self->label);
+
+    property_name = makeConst(TEXTOID, -1, InvalidOid, -1,
+                              CStringGetTextDatum(self->property), false,
+                              false);
+
+    if (self->name)
+    {
+        NameData *name = palloc(sizeof(NameData));
+
+        namestrcpy(name, self->name);
+        index_name = makeConst(NAMEOID, -1, InvalidOid, NAMEDATALEN,
+                               NameGetDatum(name), false, false);
+    }
+    else
+    {
+        index_name = makeNullConst(NAMEOID, -1, InvalidOid);
+    }
+
+    func_oid = get_ag_func_oid(CREATE_INDEX_CLAUSE_FUNCTION_NAME, 4, NAMEOID,
+                               NAMEOID, TEXTOID, NAMEOID);
+
+    func_expr = makeFuncExpr(
+        func_oid, AGTYPEOID,
+        list_make4(makeConst(NAMEOID, -1, InvalidOid, NAMEDATALEN,
+                             NameGetDatum(graph_name), false, false),
+                   makeConst(NAMEOID, -1, InvalidOid, NAMEDATALEN,
+                             NameGetDatum(label_name), false, false),
+                   property_name, index_name),
+        InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+    func_expr->funcretset = true;
+    func_expr->location = self->location;
+
+    query = makeNode(Query);
+    query->commandType = CMD_SELECT;
+
+    tle = makeTargetEntry((Expr *)func_expr, pstate->p_next_resno++,
+                          AGE_VARNAME_CREATE_INDEX_CLAUSE, false);
+    query->targetList = list_make1(tle);
+
+    query->rtable = pstate->p_rtable;
+    query->jointree = makeFromExpr(pstate->p_joinlist, NULL);
+    query->hasTargetSRFs = true;
+
+    return query;
+}
+
 static Query *transform_cypher_set(cypher_parsestate *cpstate,
                                    cypher_clause *clause)
 {
@@ -509,25 +639,26 @@ static Query *transform_cypher_set(cypher_parsestate *cpstate,
 
     func_set_oid = get_ag_func_oid("_cypher_set_clause", 1, INTERNALOID);
 
-    if (list_length(self->items) != 1)
-        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-            errmsg("%s clause does not yet support updating more than one property", clause_name),
-            parser_errposition(pstate, self->location)));
-
     if (self->is_remove == true)
         set_items_target_list = transform_cypher_remove_item_list(cpstate, self->items, query);
     else
         set_items_target_list = transform_cypher_set_item_list(cpstate, self->items, query);
 
-    if (list_length(self->items) != 1)
-        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-            errmsg("%s clause does not yet support updating more than one property",
-                    set_items_target_list->clause_name),
-            parser_errposition(pstate, self->location)));
-
     set_items_target_list->clause_name = clause_name;
     set_items_target_list->graph_name = cpstate->graph_name;
 
+    // the action only updates the rows MERGE created or matched the path of
+    if (self->merge_action != CYPHER_MERGE_ACTION_NONE)
+    {
+        set_items_target_list->merge_position =
+            get_target_entry_resno(query->targetList,
+                                   AGE_VARNAME_MERGE_CLAUSE);
+        set_items_target_list->on_create =
+            self->merge_action == CYPHER_MERGE_ACTION_ON_CREATE;
+    }
+    set_items_target_list->path_positions = get_path_positions(pstate->p_rtable,
+                                                               query->targetList);
+
     if (!clause->next)
         set_items_target_list->flags |= CYPHER_CLAUSE_FLAG_TERMINAL;
 
@@ -561,6 +692,90 @@ static Query *transform_cypher_set(cypher_parsestate *cpstate,
     return query;
 }
 
+/*
+ * Returns the positions of the columns of the target list that can hold a
+ * path. When an entity is updated, only these columns are searched for paths
+ * that contain it.
+ */
+static List *get_path_positions(List *rtable, List *target_list)
+{
+    List *positions = NIL;
+    ListCell *lc;
+
+    foreach (lc, target_list)
+    {
+        TargetEntry *te = lfirst(lc);
+
+        if (expr_may_hold_path(rtable, te->expr))
+            positions = lappend_int(positions, te->resno);
+    }
+
+    return positions;
+}
+
+/*
+ * Returns whether an expression can evaluate to a path. Variables of the
+ * previous clauses are followed into their subqueries. Only the expressions
+ * that are known to build something else, like the vertices and edges of a
+ * MATCH, are ruled out.
+ */
+static bool expr_may_hold_path(List *rtable, Expr *expr)
+{
+    check_stack_depth();
+
+    if (exprType((Node *)expr) != AGTYPEOID)
+        return false;
+
+    // the placeholders of CREATE are filled in at execution, maybe with paths
+    if (IsA(expr, Const))
+        return ((Const *)expr)->constisnull;
+
+    if (IsA(expr, Var))
+    {
+        Var *var = (Var *)expr;
+        RangeTblEntry *rte;
+        TargetEntry *te;
+
+        if (var->varlevelsup != 0)
+            return true;
+
+        rte = rt_fetch(var->varno, rtable);
+
+        // the columns of the label tables are ids and property maps
+        if (rte->rtekind == RTE_RELATION)
+            return false;
+
+        if (rte->rtekind != RTE_SUBQUERY)
+            return true;
+
+        te = get_tle_by_resno(rte->subquery->targetList, var->varattno);
+        if (te == NULL)
+            return true;
+
+        return expr_may_hold_path(rte->subquery->rtable, te->expr);
+    }
+
+    if (IsA(expr, FuncExpr))
+    {
+        FuncExpr *fexpr = (FuncExpr *)expr;
+
+        if (fexpr->funcid == get_ag_func_oid("agtype_volatile_wrapper", 1,
+                                             AGTYPEOID))
+            return expr_may_hold_path(rtable, linitial(fexpr->args));
+
+        if (fexpr->funcid == get_ag_func_oid("_agtype_build_vertex", 3,
+                                             GRAPHIDOID, CSTRINGOID,
+                                             AGTYPEOID) ||
+            fexpr->funcid == get_ag_func_oid("_agtype_build_edge", 5,
+                                             GRAPHIDOID, GRAPHIDOID,
+                                             GRAPHIDOID, CSTRINGOID,
+                                             AGTYPEOID))
+            return false;
+    }
+
+    return true;
+}
+
 cypher_update_information *transform_cypher_remove_item_list(
     cypher_parsestate *cpstate, List *remove_item_list, Query *query)
 {
@@ -1215,6 +1430,10 @@ static Query *transform_cypher_match_pattern(cypher_parsestate *cpstate,
 
     transform_match_pattern(cpstate, query, self->pattern);
 
+    // the columns are only used by a WHERE clause or the next clause
+    if (self->where || clause->next)
+        add_entity_column_targets(cpstate, query);
+
     markTargetListOrigins(pstate, query->targetList);
 
     assign_query_collations(pstate, query);
@@ -1359,6 +1578,78 @@ static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
     query->jointree = makeFromExpr(cpstate->pstate.p_joinlist, (Node *)expr);
 }
 
+/*
+ * Expose the columns of the label tables that the vertices and edges in the
+ * target list are built from, through junk target entries appended to the
+ * target list. transform_entity_column_access() refers to them, so that once
+ * the planner pulls up this query, expressions on the variables become
+ * expressions on the columns of the label tables. Junk target entries are not
+ * part of the column names of the query, so they are not passed on by the
+ * clauses that expand its variables.
+ */
+static void add_entity_column_targets(cypher_parsestate *cpstate,
+                                      Query *query)
+{
+    // the columns of the arguments of the build functions, NULL for the label
+    static char *vertex_colnames[] = {AG_VERTEX_COLNAME_ID, NULL,
+                                      AG_VERTEX_COLNAME_PROPERTIES};
+    static char *edge_colnames[] = {AG_EDGE_COLNAME_ID,
+                                    AG_EDGE_COLNAME_START_ID,
+                                    AG_EDGE_COLNAME_END_ID, NULL,
+                                    AG_EDGE_COLNAME_PROPERTIES};
+    ParseState *pstate = (ParseState *)cpstate;
+    List *target_list = list_copy(query->targetList);
+    Oid vertex_func_oid;
+    Oid edge_func_oid;
+    ListCell *lt;
+
+    vertex_func_oid = get_ag_func_oid("_agtype_build_vertex", 3, GRAPHIDOID,
+                                      CSTRINGOID, AGTYPEOID);
+    edge_func_oid = get_ag_func_oid("_agtype_build_edge", 5, GRAPHIDOID,
+                                    GRAPHIDOID, GRAPHIDOID, CSTRINGOID,
+                                    AGTYPEOID);
+
+    foreach (lt, target_list)
+    {
+        TargetEntry *te = lfirst(lt);
+        FuncExpr *fexpr;
+        char **colnames;
+        ListCell *la;
+        int i = 0;
+
+        if (te->resjunk || !IsA(te->expr, FuncExpr))
+            continue;
+
+        fexpr = (FuncExpr *)te->expr;
+        if (fexpr->funcid == vertex_func_oid)
+            colnames = vertex_colnames;
+        else if (fexpr->funcid == edge_func_oid)
+            colnames = edge_colnames;
+        else
+            continue;
+
+        foreach (la, fexpr->args)
+        {
+            Node *col = lfirst(la);
+            char *colname = colnames[i++];
+            TargetEntry *junk_te;
+
+            if (colname == NULL || !IsA(col, Var) ||
+                ((Var *)col)->varlevelsup != 0)
+                continue;
+
+            junk_te = makeTargetEntry(
+                (Expr *)copyObject(col), pstate->p_next_resno++,
+                psprintf("%s%s_%d", AGE_DEFAULT_VARNAME_PREFIX, colname,
+                         te->resno),
+                true);
+            query->targetList = lappend(query->targetList, junk_te);
+        }
+    }
+
+    list_free(target_list);
+}
+
 static char *get_next_default_alias(cypher_parsestate *cpstate)
 {
     int base_length;
@@ -1380,7 +1671,8 @@ static char *get_next_default_alias(cypher_parsestate *cpstate)
 
 /*
  * Creates a FuncCall node that will prevent an edge from being joined
- * to twice.
+ * to twice. The edges of a variable length relationship are passed as the
+ * list of its path, so they are not reused by the other relationships.
  */
 static FuncCall *prevent_duplicate_edges(cypher_parsestate *cpstate,
                                          List *entities)
@@ -1399,17 +1691,28 @@ static FuncCall *prevent_duplicate_edges(cypher_parsestate *cpstate,
     foreach (lc, entities)
     {
         transform_entity *entity = lfirst(lc);
-        FuncCall *edge;
+        Node *edge;
 
-        // skip vertices
         if (entity->type != ENT_EDGE)
             continue;
 
-        edge = make_qual(cpstate, entity, AG_EDGE_COLNAME_ID);
+        /*
+         * The traversal makes sure the edges of a path are unique, they are
+         * only checked against the other relationships here.
+         */
+        if (entity->entity.rel->varlen != NULL)
+            edge = (Node *)copyObject(entity->expr);
+        else
+            edge = make_agtype_qual(make_qual(cpstate, entity,
+                                              AG_EDGE_COLNAME_ID));
 
         edges = lappend(edges, edge);
     }
 
+    // a single relationship is always unique
+    if (list_length(edges) < 2)
+        return NULL;
+
     return makeFuncCall(qualified_function_name, edges, -1);
 }
 
@@ -1421,7 +1724,7 @@ static FuncCall *prevent_duplicate_edges(cypher_parsestate *cpstate,
  */
 static List *make_directed_edge_join_conditions(
     cypher_parsestate *cpstate, transform_entity *prev_entity,
-    transform_entity *next_entity, FuncCall *prev_qual, FuncCall *next_qual,
+    transform_entity *next_entity, Node *prev_qual, Node *next_qual,
     char *prev_node_filter, char *next_node_filter)
 {
     List *quals = NIL;
@@ -1477,6 +1780,23 @@ static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
     transform_entity *next_entity;
     transform_entity *prev_entity;
 
+    /*
+     * The paths of a variable length relationship start from the previous
+     * node already, see transform_cypher_vle_edge(). Join the next node to
+     * the vertex they end at.
+     */
+    if (entity->entity.rel->varlen != NULL)
+    {
+        ColumnRef *end_id = makeNode(ColumnRef);
+
+        end_id->fields = list_make2(makeString(entity->entity.rel->name),
+                                    makeString(AG_EDGE_COLNAME_END_ID));
+        end_id->location = -1;
+
+        return join_to_entity(cpstate, next_node, (Node *)end_id,
+                              JOIN_SIDE_RIGHT);
+    }
+
     /*
      *  If the previous node is not in the join tree, set the previous
      *  label filter.
@@ -1517,10 +1837,10 @@ static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
     {
     case CYPHER_REL_DIR_RIGHT:
     {
-        FuncCall *prev_qual = make_qual(cpstate, entity,
-                                        AG_EDGE_COLNAME_START_ID);
-        FuncCall *next_qual = make_qual(cpstate, entity,
-                                        AG_EDGE_COLNAME_END_ID);
+        Node *prev_qual = make_qual(cpstate, entity,
+                                    AG_EDGE_COLNAME_START_ID);
+        Node *next_qual = make_qual(cpstate, entity,
+                                    AG_EDGE_COLNAME_END_ID);
 
         return make_directed_edge_join_conditions(
             cpstate, prev_entity, next_node, prev_qual, next_qual,
@@ -1528,10 +1848,10 @@ static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
     }
     case CYPHER_REL_DIR_LEFT:
     {
-        FuncCall *prev_qual = make_qual(cpstate, entity,
-                                        AG_EDGE_COLNAME_END_ID);
-        FuncCall *next_qual = make_qual(cpstate, entity,
-                                        AG_EDGE_COLNAME_START_ID);
+        Node *prev_qual = make_qual(cpstate, entity,
+                                    AG_EDGE_COLNAME_END_ID);
+        Node *next_qual = make_qual(cpstate, entity,
+                                    AG_EDGE_COLNAME_START_ID);
 
         return make_directed_edge_join_conditions(
             cpstate, prev_entity, next_node, prev_qual, next_qual,
@@ -1543,10 +1863,10 @@ static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
          * For undirected relationships, we can use the left directed
          * relationship OR'd by the right directed relationship.
          */
-        FuncCall *start_id_expr = make_qual(cpstate, entity,
-                                            AG_EDGE_COLNAME_START_ID);
-        FuncCall *end_id_expr = make_qual(cpstate, entity,
-                                          AG_EDGE_COLNAME_END_ID);
+        Node *start_id_expr = make_qual(cpstate, entity,
+                                        AG_EDGE_COLNAME_START_ID);
+        Node *end_id_expr = make_qual(cpstate, entity,
+                                      AG_EDGE_COLNAME_END_ID);
         List *first_join_quals = NIL, *second_join_quals = NIL;
         Expr *first_qual, *second_qual;
         Expr *or_qual;
@@ -1579,7 +1899,7 @@ static List *make_join_condition_for_edge(cypher_parsestate *cpstate,
  * passed entity is a directed edge.
  */
 static List *join_to_entity(cypher_parsestate *cpstate,
-                            transform_entity *entity, FuncCall *qual,
+                            transform_entity *entity, Node *qual,
                             enum transform_entity_join_side side)
 {
     A_Expr *expr;
@@ -1587,10 +1907,20 @@ static List *join_to_entity(cypher_parsestate *cpstate,
 
     if (entity->type == ENT_VERTEX)
     {
-        FuncCall *id_qual = make_qual(cpstate, entity, AG_EDGE_COLNAME_ID);
+        Node *id_qual = make_qual(cpstate, entity, AG_EDGE_COLNAME_ID);
+
+        /*
+         * When both entities come from label tables, compare the graphid
+         * columns directly, so the planner can use their indexes and
+         * operator classes for the join. Otherwise, compare them as agtype.
+         */
+        if (!IsA(qual, ColumnRef) || !IsA(id_qual, ColumnRef))
+        {
+            qual = make_agtype_qual(qual);
+            id_qual = make_agtype_qual(id_qual);
+        }
 
-        expr = makeSimpleA_Expr(AEXPR_OP, "=", (Node *)qual, (Node *)id_qual,
-                                -1);
+        expr = makeSimpleA_Expr(AEXPR_OP, "=", qual, id_qual, -1);
 
         quals = lappend(quals, expr);
     }
@@ -1598,12 +1928,22 @@ static List *join_to_entity(cypher_parsestate *cpstate,
     {
         List *edge_quals = make_edge_quals(cpstate, entity, side);
 
+        // see above, both edges must come from label tables
+        if (!IsA(qual, ColumnRef) || !IsA(linitial(edge_quals), ColumnRef))
+        {
+            ListCell *lc;
+
+            qual = make_agtype_qual(qual);
+            foreach (lc, edge_quals)
+                lfirst(lc) = make_agtype_qual(lfirst(lc));
+        }
+
         if (list_length(edge_quals) > 1)
-            expr = makeSimpleA_Expr(AEXPR_IN, "=", (Node *)qual,
-                                    (Node *)edge_quals, -1);
+            expr = makeSimpleA_Expr(AEXPR_IN, "=", qual, (Node *)edge_quals,
+                                    -1);
         else
-            expr = makeSimpleA_Expr(AEXPR_OP, "=", (Node *)qual,
-                                    linitial(edge_quals), -1);
+            expr = makeSimpleA_Expr(AEXPR_OP, "=", qual, linitial(edge_quals),
+                                    -1);
 
         quals = lappend(quals, expr);
     }
@@ -1680,13 +2020,13 @@ static List *make_edge_quals(cypher_parsestate *cpstate,
  * that removes all labels that do not have the same label_id
  */
 static A_Expr *filter_vertices_on_label_id(cypher_parsestate *cpstate,
-                                           FuncCall *id_field, char *label)
+                                           Node *id_field, char *label)
 {
     label_cache_data *lcd = search_label_name_graph_cache(label,
                                                           cpstate->graph_oid);
     A_Const *n;
-    FuncCall *fc, *conversion_fc;
-    Value *ag_catalog, *extract_label_id, *agtype_to_graphid;
+    FuncCall *fc;
+    Value *ag_catalog, *extract_label_id;
     int32 label_id = lcd->id;
 
     n = makeNode(A_Const);
@@ -1696,13 +2036,19 @@ static A_Expr *filter_vertices_on_label_id(cypher_parsestate *cpstate,
 
     ag_catalog = makeString("ag_catalog");
     extract_label_id = makeString("_extract_label_id");
-    agtype_to_graphid = makeString("agtype_to_graphid");
 
-    conversion_fc = makeFuncCall(list_make2(ag_catalog, agtype_to_graphid),
-                                 list_make1(id_field), -1);
+    // graphid columns are used as they are, agtype ids must be converted
+    if (!IsA(id_field, ColumnRef))
+    {
+        Value *agtype_to_graphid = makeString("agtype_to_graphid");
+
+        id_field = (Node *)makeFuncCall(list_make2(ag_catalog,
+                                                   agtype_to_graphid),
+                                        list_make1(id_field), -1);
+    }
 
     fc = makeFuncCall(list_make2(ag_catalog, extract_label_id),
-                      list_make1(conversion_fc), -1);
+                      list_make1(id_field), -1);
 
     return makeSimpleA_Expr(AEXPR_OP, "=", (Node *)fc, (Node *)n, -1);
 }
@@ -1756,10 +2102,11 @@ static transform_entity *find_variable(cypher_parsestate *cpstate, char *name)
 }
 
 /*
- * Create a function to handle property constraints on an edge/vertex.
+ * Create a qual to handle property constraints on an edge/vertex.
  * Since the property constraints might be a parameter, we cannot split
- * the property map into indvidual quals, this will be slightly inefficient,
- * but necessary to cover all possible situations.
+ * the property map into indvidual quals. Instead, the constraints are
+ * checked with the containment operator (properties @> constraints), which
+ * lets the planner use a GIN index on the properties column.
  */
 static Node *create_property_constraint_function(cypher_parsestate *cpstate,
                                                  transform_entity *entity,
@@ -1768,8 +2115,6 @@ static Node *create_property_constraint_function(cypher_parsestate *cpstate,
     ParseState *pstate = (ParseState *)cpstate;
     char *entity_name;
     ColumnRef *cr;
-    FuncExpr *fexpr;
-    Oid func_oid;
     Node *prop_expr, *const_expr;
     RangeTblEntry *rte;
 
@@ -1797,13 +2142,10 @@ static Node *create_property_constraint_function(cypher_parsestate *cpstate,
     const_expr = transform_cypher_expr(cpstate, property_constraints,
                                        EXPR_KIND_WHERE);
 
-    func_oid = get_ag_func_oid("_property_constraint_check", 2, AGTYPEOID,
-                               AGTYPEOID);
-
-    fexpr = makeFuncExpr(func_oid, BOOLOID, list_make2(prop_expr, const_expr),
-                         InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
-
-    return (Node *)fexpr;
+    return (Node *)make_op(pstate,
+                           list_make2(makeString("ag_catalog"),
+                                      makeString("@>")),
+                           prop_expr, const_expr, pstate->p_last_srf, -1);
 }
 
 
@@ -1841,7 +2183,8 @@ static List *transform_match_path(cypher_parsestate *cpstate, Query *query,
     if (list_length(entities) > 3)
     {
         duplicate_edge_qual = prevent_duplicate_edges(cpstate, entities);
-        qual = lappend(qual, duplicate_edge_qual);
+        if (duplicate_edge_qual != NULL)
+            qual = lappend(qual, duplicate_edge_qual);
     }
 
     return qual;
@@ -1857,6 +2200,9 @@ static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
     ListCell *lc;
     List *entities = NIL;
 
+    if (path->kind != CYPHER_PATH_DEFAULT)
+        return transform_match_shortest_path_entities(cpstate, query, path);
+
     /*
      * Iterate through every node in the path, construct the expr node
      * that is needed for the remaining steps
@@ -1869,10 +2215,20 @@ static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
         if (i % 2 == 0)
         {
             cypher_node *node = lfirst(lc);
+            bool output_node = INCLUDE_NODE_IN_JOIN_TREE(path, node);
 
-            expr =
-                transform_cypher_node(cpstate, node, &query->targetList,
-                                      INCLUDE_NODE_IN_JOIN_TREE(path, node));
+            /*
+             * The paths of a variable length relationship start from the
+             * vertex before it and are joined to the vertex after it, so both
+             * must be in the join tree.
+             */
+            if (!output_node && i > 0)
+                output_node = IS_VARLEN_REL(list_nth(path->path, i - 1));
+            if (!output_node && lnext(lc) != NULL)
+                output_node = IS_VARLEN_REL(lfirst(lnext(lc)));
+
+            expr = transform_cypher_node(cpstate, node, &query->targetList,
+                                         output_node);
 
             entity = make_transform_entity(cpstate, ENT_VERTEX, (Node *)node,
                                            expr);
@@ -1891,14 +2247,20 @@ static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
         {
             cypher_relationship *rel = lfirst(lc);
 
-            expr = transform_cypher_edge(cpstate, rel, &query->targetList);
+            if (rel->varlen != NULL)
+                expr = transform_cypher_vle_edge(cpstate, rel, llast(entities),
+                                                 NULL, CYPHER_PATH_DEFAULT,
+                                                 &query->targetList);
+            else
+                expr = transform_cypher_edge(cpstate, rel, &query->targetList);
 
             entity = make_transform_entity(cpstate, ENT_EDGE, (Node *)rel,
                                            expr);
 
             cpstate->entities = lappend(cpstate->entities, entity);
 
-            if (rel->props)
+            // the traversal checks the properties of every edge of the paths
+            if (rel->props && rel->varlen == NULL)
             {
                 Node *n = create_property_constraint_function(cpstate, entity, rel->props);
                 cpstate->property_constraint_quals = lappend(cpstate->property_constraint_quals, n);
@@ -1913,6 +2275,95 @@ static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
     return entities;
 }
 
+/*
+ * shortestPath() and allShortestPaths() have a single relationship, which is
+ * variable length unless it is a single hop. Both of its vertices are
+ * transformed first, so the VLE node can search from both ends of the paths.
+ */
+static List *transform_match_shortest_path_entities(cypher_parsestate *cpstate,
+                                                   Query *query,
+                                                   cypher_path *path)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    char *func_name;
+    cypher_node *nodes[2];
+    transform_entity *node_entities[2];
+    cypher_relationship *rel;
+    transform_entity *rel_entity;
+    A_Indices *range;
+    Expr *expr;
+    int i;
+
+    if (path->kind == CYPHER_PATH_SHORTEST)
+        func_name = "shortestPath()";
+    else
+        func_name = "allShortestPaths()";
+
+    if (list_length(path->path) != 3)
+        ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                 errmsg("%s requires a pattern with a single relationship",
+                        func_name),
+                 parser_errposition(pstate, path->location)));
+
+    nodes[0] = linitial(path->path);
+    rel = lsecond(path->path);
+    nodes[1] = lthird(path->path);
+
+    // a single hop is the same as *1..1
+    if (rel->varlen == NULL)
+    {
+        A_Const *hops = makeNode(A_Const);
+
+        hops->val.type = T_Integer;
+        hops->val.val.ival = 1;
+        hops->location = -1;
+
+        range = makeNode(A_Indices);
+        range->lidx = (Node *)hops;
+        range->uidx = copyObject(hops);
+
+        rel->varlen = (Node *)range;
+    }
+
+    range = (A_Indices *)rel->varlen;
+    if (((A_Const *)range->lidx)->val.val.ival > 1)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("%s does not support a minimal length greater than 1",
+                        func_name),
+                 parser_errposition(pstate, rel->location)));
+
+    for (i = 0; i < 2; i++)
+    {
+        expr = transform_cypher_node(cpstate, nodes[i], &query->targetList,
+                                     true);
+
+        node_entities[i] = make_transform_entity(cpstate, ENT_VERTEX,
+                                                 (Node *)nodes[i], expr);
+
+        cpstate->entities = lappend(cpstate->entities, node_entities[i]);
+
+        if (nodes[i]->props)
+        {
+            Node *n = create_property_constraint_function(cpstate,
+                                                          node_entities[i],
+                                                          nodes[i]->props);
+            cpstate->property_constraint_quals = lappend(cpstate->property_constraint_quals, n);
+        }
+    }
+
+    expr = transform_cypher_vle_edge(cpstate, rel, node_entities[0],
+                                     node_entities[1], path->kind,
+                                     &query->targetList);
+
+    rel_entity = make_transform_entity(cpstate, ENT_EDGE, (Node *)rel, expr);
+
+    cpstate->entities = lappend(cpstate->entities, rel_entity);
+
+    return list_make3(node_entities[0], rel_entity, node_entities[1]);
+}
+
 /*
  * Iterate through the list of entities setup the join conditions. Joins
  * are driven through edges. To correctly setup the joins, we must
@@ -2006,6 +2457,13 @@ transform_match_create_path_variable(cypher_parsestate *cpstate,
     {
         transform_entity *entity = lfirst(lc);
 
+        if (entity->type == ENT_EDGE && entity->entity.rel->varlen != NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("variable length relationships are not supported in path variables"),
+                     parser_errposition(pstate,
+                                        entity->entity.rel->location)));
+
         entity_exprs = lappend(entity_exprs, entity->expr);
     }
 
@@ -2066,14 +2524,17 @@ static char *get_accessor_function_name(enum transform_entity_type type,
 /*
  * For the given entity and column name, construct an expression that will access
  * the column or get the access function if the entity is a variable.
+ *
+ * The column of a label table is returned as a graphid ColumnRef, while the
+ * access function returns agtype. Use make_agtype_qual() when the two need to
+ * be compared.
  */
-static FuncCall *make_qual(cypher_parsestate *cpstate,
-                           transform_entity *entity, char *col_name)
+static Node *make_qual(cypher_parsestate *cpstate,
+                       transform_entity *entity, char *col_name)
 {
-    List *qualified_name, *args;
-
     if (IsA(entity->expr, Var))
     {
+        List *qualified_name;
         char *function_name;
 
         function_name = get_accessor_function_name(entity->type, col_name);
@@ -2081,17 +2542,14 @@ static FuncCall *make_qual(cypher_parsestate *cpstate,
         qualified_name = list_make2(makeString("ag_catalog"),
                                     makeString(function_name));
 
-        args = list_make1(entity->expr);
+        return (Node *)makeFuncCall(qualified_name, list_make1(entity->expr),
+                                    -1);
     }
     else
     {
         char *entity_name;
         ColumnRef *cr = makeNode(ColumnRef);
 
-        // cast graphid to agtype
-        qualified_name = list_make2(makeString("ag_catalog"),
-                                    makeString("graphid_to_agtype"));
-
         if (entity->type == ENT_EDGE)
             entity_name = entity->entity.node->name;
         else if (entity->type == ENT_VERTEX)
@@ -2101,34 +2559,30 @@ static FuncCall *make_qual(cypher_parsestate *cpstate,
                             errmsg("unknown entity type")));
 
         cr->fields = list_make2(makeString(entity_name), makeString(col_name));
+        cr->location = -1;
 
-        args = list_make1(cr);
+        return (Node *)cr;
     }
+}
+
+// casts a graphid column created by make_qual() to agtype
+static Node *make_agtype_qual(Node *qual)
+{
+    List *qualified_name;
+
+    if (!IsA(qual, ColumnRef))
+        return qual;
+
+    qualified_name = list_make2(makeString("ag_catalog"),
+                                makeString("graphid_to_agtype"));
 
-    return makeFuncCall(qualified_name, args, -1);
+    return (Node *)makeFuncCall(qualified_name, list_make1(qual), -1);
 }
 
-static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
-                                   cypher_relationship *rel,
-                                   List **target_list)
+static void transform_edge_label(cypher_parsestate *cpstate,
+                                 cypher_relationship *rel)
 {
     ParseState *pstate = (ParseState *)cpstate;
-    char *schema_name;
-    char *rel_name;
-    RangeVar *label_range_var;
-    Alias *alias;
-    RangeTblEntry *rte;
-    int resno;
-    TargetEntry *te;
-    Expr *expr;
-
-    if (rel->varlen != NULL)
-    {
-        ereport(ERROR,
-                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-                 errmsg("variable length relationships are not supported"),
-                 parser_errposition(pstate, rel->location)));
-    }
 
     if (!rel->label)
         rel->label = AG_DEFAULT_LABEL_EDGE;
@@ -2154,6 +2608,23 @@ static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
                      errmsg("label %s is for vertices, not edges", rel->label),
                      parser_errposition(pstate, rel->location)));
     }
+}
+
+static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
+                                   cypher_relationship *rel,
+                                   List **target_list)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    char *schema_name;
+    char *rel_name;
+    RangeVar *label_range_var;
+    Alias *alias;
+    RangeTblEntry *rte;
+    int resno;
+    TargetEntry *te;
+    Expr *expr;
+
+    transform_edge_label(cpstate, rel);
 
     if (rel->name != NULL)
     {
@@ -2175,6 +2646,7 @@ static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
              */
             if (entity != NULL &&
                 (entity->type != ENT_EDGE ||
+                 entity->entity.rel->varlen != NULL ||
                  !IS_DEFAULT_LABEL_EDGE(rel->label) ||
                  rel->props))
                 ereport(ERROR,
@@ -2225,6 +2697,158 @@ static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
     return expr;
 }
 
+/*
+ * A variable length relationship is transformed into a function in the FROM
+ * clause that takes the id of the vertex before it, the paths from the vertex
+ * are found by the Cypher VLE node the planner replaces the function with.
+ * The function returns the start and end vertex of each path, and the list of
+ * its edges, which is the value of the variable of the relationship.
+ *
+ *     (a)-[r:knows*1..3]->(b)
+ *
+ * becomes
+ *
+ *     FROM a, _cypher_vle(a.id, graph, 'knows', right, 1, 3, NULL) AS r, b
+ *     WHERE b.id = r.end_id
+ *
+ * The property constraints of the relationship are checked on every edge by
+ * the traversal.
+ */
+static Expr *transform_cypher_vle_edge(cypher_parsestate *cpstate,
+                                       cypher_relationship *rel,
+                                       transform_entity *prev_node,
+                                       transform_entity *next_node,
+                                       cypher_path_kind kind,
+                                       List **target_list)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    A_Indices *range = (A_Indices *)rel->varlen;
+    Node *vertex_id;
+    Node *end_vertex_id;
+    Node *props;
+    List *args;
+    Oid func_oid;
+    FuncExpr *func_expr;
+    RangeFunction *range_func;
+    RangeTblEntry *rte;
+    int min_hops;
+    int max_hops;
+    int resno;
+    TargetEntry *te;
+    Expr *expr;
+
+    transform_edge_label(cpstate, rel);
+
+    if (rel->name != NULL)
+    {
+        if (findTarget(*target_list, rel->name) != NULL ||
+            colNameToVar(pstate, rel->name, false, rel->location) != NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("variable %s already exists", rel->name),
+                     parser_errposition(pstate, rel->location)));
+
+        // see transform_cypher_edge()
+        if (pstate->p_expr_kind == EXPR_KIND_WHERE)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("variable %s does not exist", rel->name),
+                     parser_errposition(pstate, rel->location)));
+    }
+    else
+    {
+        rel->name = get_next_default_alias(cpstate);
+    }
+
+    // the grammar makes sure there is a lower bound, the upper one is optional
+    min_hops = ((A_Const *)range->lidx)->val.val.ival;
+    if (range->uidx != NULL)
+        max_hops = ((A_Const *)range->uidx)->val.val.ival;
+    else
+        max_hops = -1;
+
+    // the paths start from the vertex before the relationship
+    vertex_id = make_vertex_id_arg(cpstate, prev_node);
+
+    // the shortest paths end at the vertex after it, see the VLE node
+    if (next_node != NULL)
+        end_vertex_id = make_vertex_id_arg(cpstate, next_node);
+    else
+        end_vertex_id = (Node *)makeNullConst(GRAPHIDOID, -1, InvalidOid);
+
+    if (rel->props)
+        props = transform_cypher_expr(cpstate, rel->props,
+                                      EXPR_KIND_FROM_FUNCTION);
+    else
+        props = (Node *)makeNullConst(AGTYPEOID, -1, InvalidOid);
+
+    args = list_make5(vertex_id, end_vertex_id,
+                      makeConst(OIDOID, -1, InvalidOid, sizeof(Oid),
+                                ObjectIdGetDatum(cpstate->graph_oid), false,
+                                true),
+                      makeConst(TEXTOID, -1, DEFAULT_COLLATION_OID, -1,
+                                CStringGetTextDatum(rel->label), false, false),
+                      makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+                                Int32GetDatum(rel->dir), false, true));
+    args = lappend(args, makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+                                   Int32GetDatum(min_hops), false, true));
+    args = lappend(args, makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+                                   Int32GetDatum(max_hops), false, true));
+    args = lappend(args, props);
+    args = lappend(args, makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+                                   Int32GetDatum(kind), false, true));
+
+    func_oid = get_ag_func_oid(VLE_FUNCTION_NAME, VLE_NUM_ARGS, GRAPHIDOID,
+                               GRAPHIDOID, OIDOID, TEXTOID, INT4OID, INT4OID,
+                               INT4OID, AGTYPEOID, INT4OID);
+
+    func_expr = makeFuncExpr(func_oid, RECORDOID, args, InvalidOid,
+                             InvalidOid, COERCE_EXPLICIT_CALL);
+    func_expr->funcretset = true;
+    func_expr->location = rel->location;
+
+    range_func = makeNode(RangeFunction);
+    range_func->lateral = true;
+    range_func->ordinality = false;
+    range_func->is_rowsfrom = false;
+    range_func->functions = NIL;
+    range_func->alias = makeAlias(rel->name, NIL);
+    range_func->coldeflist = NIL;
+
+    rte = addRangeTableEntryForFunction(pstate, list_make1(VLE_FUNCTION_NAME),
+                                        list_make1(func_expr),
+                                        list_make1(NIL), range_func, true,
+                                        true);
+    // see transform_cypher_edge()
+    addRTEtoQuery(pstate, rte, true, true, false);
+
+    expr = (Expr *)scanRTEForColumn(pstate, rte, AG_VLE_COLNAME_EDGES, -1, 0,
+                                    NULL);
+
+    resno = pstate->p_next_resno++;
+
+    te = makeTargetEntry(expr, resno, rel->name, false);
+    *target_list = lappend(*target_list, te);
+
+    return expr;
+}
+
+// the graphid of the vertex, as an argument of the VLE function
+static Node *make_vertex_id_arg(cypher_parsestate *cpstate,
+                                transform_entity *entity)
+{
+    Node *vertex_id = make_qual(cpstate, entity, AG_VERTEX_COLNAME_ID);
+
+    if (!IsA(vertex_id, ColumnRef))
+        vertex_id = (Node *)makeFuncCall(
+            list_make2(makeString("ag_catalog"),
+                       makeString("agtype_to_graphid")),
+            list_make1(vertex_id), -1);
+
+    return transformExpr((ParseState *)cpstate, vertex_id,
+                         EXPR_KIND_FROM_FUNCTION);
+}
+
 static Expr *transform_cypher_node(cypher_parsestate *cpstate,
                                    cypher_node *node, List **target_list,
                                    bool output_node)
@@ -2429,6 +3053,74 @@ static Node *make_vertex_expr(cypher_parsestate *cpstate, RangeTblEntry *rte,
     return (Node *)func_expr;
 }
 
+/*
+ * Transform the UNWIND clause. The list is expanded by age_unnest(), a
+ * set-returning function in the target list, so the rows are produced one
+ * at a time for the clauses that follow.
+ */
+static Query *transform_cypher_unwind(cypher_parsestate *cpstate,
+                                      cypher_clause *clause)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    cypher_unwind *self = (cypher_unwind *)clause->self;
+    Query *query;
+    Node *expr;
+    FuncExpr *unnest;
+    Oid func_unnest_oid;
+    TargetEntry *tle;
+
+    query = makeNode(Query);
+    query->commandType = CMD_SELECT;
+    query->targetList = NIL;
+
+    if (clause->prev)
+    {
+        RangeTblEntry *rte;
+        int rtindex;
+
+        rte = transform_prev_cypher_clause(cpstate, clause->prev);
+        rtindex = list_length(pstate->p_rtable);
+        Assert(rtindex == 1); // rte is the first RangeTblEntry in pstate
+        query->targetList = expandRelAttrs(pstate, rte, rtindex, 0, -1);
+    }
+
+    if (variable_exists(cpstate, self->target->name))
+        ereport(ERROR,
+                (errcode(ERRCODE_DUPLICATE_ALIAS),
+                 errmsg("variable %s already exists", self->target->name),
+                 parser_errposition(pstate, self->target->location)));
+
+    expr = transform_cypher_expr(cpstate, self->target->val,
+                                 EXPR_KIND_SELECT_TARGET);
+
+    if (exprType(expr) != AGTYPEOID)
+        ereport(ERROR,
+                (errcode(ERRCODE_DATATYPE_MISMATCH),
+                 errmsg("UNWIND expects an agtype list"),
+                 parser_errposition(pstate, self->target->location)));
+
+    func_unnest_oid = get_ag_func_oid("age_unnest", 1, AGTYPEOID);
+
+    unnest = makeFuncExpr(func_unnest_oid, AGTYPEOID, list_make1(expr),
+                          InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+    unnest->funcretset = true;
+    unnest->location = self->target->location;
+
+    tle = makeTargetEntry((Expr *)unnest, pstate->p_next_resno++,
+                          self->target->name, false);
+    query->targetList = lappend(query->targetList, tle);
+
+    markTargetListOrigins(pstate, query->targetList);
+
+    query->rtable = pstate->p_rtable;
+    query->jointree = makeFromExpr(pstate->p_joinlist, NULL);
+    query->hasTargetSRFs = pstate->p_hasTargetSRFs = true;
+
+    assign_query_collations(pstate, query);
+
+    return query;
+}
+
 static Query *transform_cypher_create(cypher_parsestate *cpstate,
                                       cypher_clause *clause)
 {
@@ -2463,6 +3155,9 @@ static Query *transform_cypher_create(cypher_parsestate *cpstate,
         query->targetList = expandRelAttrs(pstate, rte, rtindex, 0, -1);
 
         target_nodes->flags |= CYPHER_CLAUSE_FLAG_PREVIOUS_CLAUSE;
+
+        if (has_delete_clause(clause->prev))
+            target_nodes->flags |= CYPHER_CLAUSE_FLAG_PREVIOUS_DELETE;
     }
 
     func_create_oid = get_ag_func_oid(CREATE_CLAUSE_FUNCTION_NAME, 1, INTERNALOID);
@@ -2522,6 +3217,216 @@ static Query *transform_cypher_create(cypher_parsestate *cpstate,
     return query;
 }
 
+/*
+ * Transform the MERGE clause. Its path is transformed like the one of a
+ * CREATE clause, the executor matches it and creates it when there is no
+ * match, see cypher_merge.c.
+ *
+ * The ON CREATE SET and ON MATCH SET actions are transformed as SET clauses
+ * following MERGE, that only update the rows MERGE created or matched the
+ * path of.
+ */
+static Query *transform_cypher_merge(cypher_parsestate *cpstate,
+                                     cypher_clause *clause)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    cypher_merge *self = (cypher_merge *)clause->self;
+    cypher_merge_information *merge_information;
+    Const *pattern_const;
+    Expr *func_expr;
+    Oid func_merge_oid;
+    Query *query;
+    TargetEntry *tle;
+    StringInfo str;
+
+    if (self->actions != NIL)
+    {
+        cypher_merge *merge = make_ag_node(cypher_merge);
+        cypher_clause *prev;
+        cypher_clause *action_clause = NULL;
+        ListCell *lc;
+
+        merge->path = self->path;
+        merge->actions = NIL;
+        merge->location = self->location;
+
+        prev = palloc(sizeof(cypher_clause));
+        prev->self = (Node *)merge;
+        prev->prev = clause->prev;
+
+        foreach (lc, self->actions)
+        {
+            action_clause = palloc(sizeof(cypher_clause));
+            action_clause->self = lfirst(lc);
+            action_clause->prev = prev;
+            prev->next = action_clause;
+
+            prev = action_clause;
+        }
+        action_clause->next = clause->next;
+
+        return transform_cypher_set(cpstate, action_clause);
+    }
+
+    merge_information = make_ag_node(cypher_merge_information);
+    merge_information->flags = CYPHER_CLAUSE_FLAG_NONE;
+    merge_information->graph_oid = cpstate->graph_oid;
+
+    query = makeNode(Query);
+    query->commandType = CMD_SELECT;
+    query->targetList = NIL;
+
+    if (clause->prev)
+    {
+        RangeTblEntry *rte;
+        int rtindex;
+
+        rte = transform_prev_cypher_clause(cpstate, clause->prev);
+        rtindex = list_length(pstate->p_rtable);
+        Assert(rtindex == 1); // rte is the first RangeTblEntry in pstate
+        query->targetList = expandRelAttrs(pstate, rte, rtindex, 0, -1);
+
+        merge_information->flags |= CYPHER_CLAUSE_FLAG_PREVIOUS_CLAUSE;
+
+        if (has_delete_clause(clause->prev))
+            merge_information->flags |= CYPHER_CLAUSE_FLAG_PREVIOUS_DELETE;
+    }
+
+    if (!clause->next)
+        merge_information->flags |= CYPHER_CLAUSE_FLAG_TERMINAL;
+
+    check_cypher_merge_path(cpstate, (cypher_path *)self->path);
+
+    merge_information->path = transform_cypher_create_path(
+        cpstate, &query->targetList, (cypher_path *)self->path);
+
+    func_merge_oid = get_ag_func_oid(MERGE_CLAUSE_FUNCTION_NAME, 1,
+                                     INTERNALOID);
+
+    /*
+     * Serialize the cypher_merge_information data structure, see
+     * transform_cypher_create(). The attribute number of the function is
+     * known before the target entry is made.
+     */
+    merge_information->merge_function_attr = pstate->p_next_resno++;
+
+    str = makeStringInfo();
+    outNode(str, merge_information);
+
+    pattern_const = makeConst(INTERNALOID, -1, InvalidOid, str->len,
+                              PointerGetDatum(str->data), false, false);
+
+    func_expr = (Expr *)makeFuncExpr(func_merge_oid, AGTYPEOID,
+                                     list_make1(pattern_const), InvalidOid,
+                                     InvalidOid, COERCE_EXPLICIT_CALL);
+
+    // Create the target entry
+    tle = makeTargetEntry(func_expr, merge_information->merge_function_attr,
+                          AGE_VARNAME_MERGE_CLAUSE, false);
+    query->targetList = lappend(query->targetList, tle);
+
+    query->rtable = pstate->p_rtable;
+    query->jointree = makeFromExpr(pstate->p_joinlist, NULL);
+
+    query->querySource = QSRC_ORIGINAL;
+    query->canSetTag = true;
+
+    return query;
+}
+
+/*
+ * The path of a MERGE clause is one that CREATE could create. The variables
+ * already bound, by the previous clauses or earlier in the path, are matched
+ * as they are.
+ */
+static void check_cypher_merge_path(cypher_parsestate *cpstate,
+                                    cypher_path *path)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    List *names = NIL;
+    ListCell *lc;
+
+    if (path->kind != CYPHER_PATH_DEFAULT)
+        ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                 errmsg("shortestPath() and allShortestPaths() are not supported in MERGE"),
+                 parser_errposition(pstate, path->location)));
+
+    foreach (lc, path->path)
+    {
+        if (is_ag_node(lfirst(lc), cypher_node))
+        {
+            cypher_node *node = lfirst(lc);
+            bool bound;
+
+            if (node->props != NULL && is_ag_node(node->props, cypher_param))
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("properties in a MERGE clause as a parameter is not supported"),
+                         parser_errposition(pstate, node->location)));
+
+            if (node->name == NULL)
+                continue;
+
+            bound = find_variable(cpstate, node->name) != NULL ||
+                    list_member(names, makeString(node->name));
+
+            if (bound && (node->label != NULL || node->props != NULL))
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("variable %s already exists, it cannot have a label or properties in MERGE",
+                                node->name),
+                         parser_errposition(pstate, node->location)));
+
+            names = lappend(names, makeString(node->name));
+        }
+        else
+        {
+            cypher_relationship *rel = lfirst(lc);
+
+            if (rel->varlen != NULL)
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("variable length relationships are not supported in MERGE"),
+                         parser_errposition(pstate, rel->location)));
+
+            if (rel->dir == CYPHER_REL_DIR_NONE)
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("only directed relationships are allowed in MERGE"),
+                         parser_errposition(pstate, rel->location)));
+
+            if (rel->label == NULL)
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("relationships must specify a label in MERGE"),
+                         parser_errposition(pstate, rel->location)));
+
+            if (rel->props != NULL && is_ag_node(rel->props, cypher_param))
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("properties in a MERGE clause as a parameter is not supported"),
+                         parser_errposition(pstate, rel->location)));
+        }
+    }
+}
+
+/*
+ * Returns true if the given clause or one of the clauses before it is a
+ * DELETE clause. Otherwise, the entities bound by the previous clauses cannot
+ * be gone as far as the current command is concerned.
+ */
+static bool has_delete_clause(cypher_clause *clause)
+{
+    for (; clause != NULL; clause = clause->prev)
+    {
+        if (is_ag_node(clause->self, cypher_delete))
+            return true;
+    }
+
+    return false;
+}
+
 static List *transform_cypher_create_pattern(cypher_parsestate *cpstate,
                                              Query *query, List *pattern)
 {
@@ -2553,6 +3458,12 @@ transform_cypher_create_path(cypher_parsestate *cpstate, List **target_list,
 
     ccp->path_attr_num = InvalidAttrNumber;
 
+    if (path->kind != CYPHER_PATH_DEFAULT)
+        ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                 errmsg("shortestPath() and allShortestPaths() are not supported in CREATE"),
+                 parser_errposition(pstate, path->location)));
+
     foreach (lc, path->path)
     {
         if (is_ag_node(lfirst(lc), cypher_node))
@@ -2642,6 +3553,12 @@ transform_create_cypher_edge(cypher_parsestate *cpstate, List **target_list,
     char *alias;
     AttrNumber resno;
 
+    if (edge->varlen != NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("variable length relationships are not supported in CREATE"),
+                 parser_errposition(pstate, edge->location)));
+
     rel->type = LABEL_KIND_EDGE;
     rel->flags = CYPHER_TARGET_NODE_FLAG_INSERT;
     rel->label_name = edge->label;
@@ -35,6 +35,7 @@
 #include "parser/parse_node.h"
 #include "parser/parse_oper.h"
 #include "parser/parse_relation.h"
+#include "parser/parsetree.h"
 #include "utils/builtins.h"
 #include "utils/int8.h"
 #include "utils/lsyscache.h"
@@ -46,6 +47,7 @@
 #include "parser/cypher_parse_node.h"
 #include "utils/ag_func.h"
 #include "utils/agtype.h"
+#include "utils/graphid.h"
 
 /* names of typecast functions */
 #define FUNC_AGTYPE_TYPECAST_EDGE "agtype_typecast_edge"
@@ -63,7 +65,15 @@ static Node *transform_A_Const(cypher_parsestate *cpstate, A_Const *ac);
 static Node *transform_ColumnRef(cypher_parsestate *cpstate, ColumnRef *cref);
 static Node *transform_A_Indirection(cypher_parsestate *cpstate,
                                      A_Indirection *a_ind);
+static Node *transform_entity_column_access(cypher_parsestate *cpstate,
+                                            Var *var, char *colname);
 static Node *transform_AEXPR_OP(cypher_parsestate *cpstate, A_Expr *a);
+static Node *transform_entity_id_comparison(cypher_parsestate *cpstate,
+                                            A_Expr *a, Node *lexpr,
+                                            Node *rexpr);
+static char *get_entity_id_colname(Node *expr);
+static Node *make_graphid_value(cypher_parsestate *cpstate, Node *expr,
+                                bool is_equality);
 static Node *transform_BoolExpr(cypher_parsestate *cpstate, BoolExpr *expr);
 static Node *transform_cypher_bool_const(cypher_parsestate *cpstate,
                                          cypher_bool_const *bc);
@@ -281,11 +291,169 @@ static Node *transform_AEXPR_OP(cypher_parsestate *cpstate, A_Expr *a)
     Node *last_srf = pstate->p_last_srf;
     Node *lexpr = transform_cypher_expr_recurse(cpstate, a->lexpr);
     Node *rexpr = transform_cypher_expr_recurse(cpstate, a->rexpr);
+    Node *id_cmp;
+
+    id_cmp = transform_entity_id_comparison(cpstate, a, lexpr, rexpr);
+    if (id_cmp)
+        return id_cmp;
 
     return (Node *)make_op(pstate, a->name, lexpr, rexpr, last_srf,
                            a->location);
 }
 
+/*
+ * If one side of the comparison is id(), start_id() or end_id() of a vertex
+ * or an edge that comes from a label table, and the other side is an integer
+ * constant or, for an equality, a parameter, compare the graphid column of
+ * the label table instead. The comparison can then use the primary key (or
+ * the edge indexes) of the label table, and the label tables whose id range
+ * cannot satisfy it are excluded by the planner. Otherwise, return NULL.
+ */
+static Node *transform_entity_id_comparison(cypher_parsestate *cpstate,
+                                            A_Expr *a, Node *lexpr,
+                                            Node *rexpr)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    char *opname;
+    char *colname;
+    Node *col;
+    Node *value;
+    bool is_equality;
+    List *qualified_opname;
+
+    if (list_length(a->name) != 1)
+        return NULL;
+
+    opname = strVal(linitial(a->name));
+    if (strcmp(opname, "=") != 0 && strcmp(opname, "<>") != 0 &&
+        strcmp(opname, "<") != 0 && strcmp(opname, "<=") != 0 &&
+        strcmp(opname, ">") != 0 && strcmp(opname, ">=") != 0)
+        return NULL;
+
+    /*
+     * Check the value before exposing the column so that the subquery is left
+     * untouched if the comparison cannot be rewritten.
+     */
+    is_equality = (strcmp(opname, "=") == 0);
+    colname = get_entity_id_colname(lexpr);
+    if (colname && (value = make_graphid_value(cpstate, rexpr, is_equality)))
+    {
+        col = transform_entity_column_access(
+            cpstate, (Var *)linitial(((FuncExpr *)lexpr)->args), colname);
+        if (!col)
+            return NULL;
+
+        lexpr = col;
+        rexpr = value;
+    }
+    else if ((colname = get_entity_id_colname(rexpr)) &&
+             (value = make_graphid_value(cpstate, lexpr, is_equality)))
+    {
+        col = transform_entity_column_access(
+            cpstate, (Var *)linitial(((FuncExpr *)rexpr)->args), colname);
+        if (!col)
+            return NULL;
+
+        lexpr = value;
+        rexpr = col;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    // the graphid operators live in ag_catalog
+    qualified_opname = list_make2(makeString("ag_catalog"),
+                                  makeString(opname));
+
+    return (Node *)make_op(pstate, qualified_opname, lexpr, rexpr,
+                           pstate->p_last_srf, a->location);
+}
+
+/*
+ * If the given expression is id(), start_id() or end_id() of a variable,
+ * return the name of the graphid column that it reads. Otherwise, return
+ * NULL.
+ */
+static char *get_entity_id_colname(Node *expr)
+{
+    FuncExpr *fexpr;
+
+    if (!IsA(expr, FuncExpr))
+        return NULL;
+
+    fexpr = (FuncExpr *)expr;
+    if (list_length(fexpr->args) != 1 || !IsA(linitial(fexpr->args), Var))
+        return NULL;
+
+    if (fexpr->funcid == get_ag_func_oid(AG_ACCESS_FUNCTION_ID, 1, AGTYPEOID))
+        return AG_VERTEX_COLNAME_ID;
+    if (fexpr->funcid == get_ag_func_oid(AG_EDGE_ACCESS_FUNCTION_START_ID, 1,
+                                         AGTYPEOID))
+        return AG_EDGE_COLNAME_START_ID;
+    if (fexpr->funcid == get_ag_func_oid(AG_EDGE_ACCESS_FUNCTION_END_ID, 1,
+                                         AGTYPEOID))
+        return AG_EDGE_COLNAME_END_ID;
+
+    return NULL;
+}
+
+/*
+ * Convert an integer constant to a graphid constant. For an equality, also
+ * convert a parameter to a graphid at execution time; the conversion gives
+ * NULL for a value that is not equal to any integer, so that such a value
+ * matches nothing, as it would without the conversion. The other operators
+ * order values of different types, so they cannot be rewritten for a
+ * parameter of unknown type. Return NULL for anything else.
+ */
+static Node *make_graphid_value(cypher_parsestate *cpstate, Node *expr,
+                                bool is_equality)
+{
+    if (IsA(expr, Const))
+    {
+        Const *c = (Const *)expr;
+        agtype *agt;
+        agtype_value *agtv;
+        Const *result;
+
+        if (c->consttype != AGTYPEOID || c->constisnull)
+            return NULL;
+
+        agt = DATUM_GET_AGTYPE_P(c->constvalue);
+        if (!AGT_ROOT_IS_SCALAR(agt))
+            return NULL;
+
+        agtv = get_ith_agtype_value_from_container(&agt->root, 0);
+        if (agtv->type != AGTV_INTEGER)
+            return NULL;
+
+        result = makeConst(GRAPHIDOID, -1, InvalidOid, sizeof(graphid),
+                           GRAPHID_GET_DATUM(agtv->val.int_value), false,
+                           FLOAT8PASSBYVAL);
+        result->location = c->location;
+
+        return (Node *)result;
+    }
+
+    // a parameter is agtype_access_operator(params, key)
+    if (is_equality && cpstate->params && IsA(expr, FuncExpr) &&
+        equal(linitial(((FuncExpr *)expr)->args), cpstate->params))
+    {
+        Oid func_oid;
+        FuncExpr *result;
+
+        func_oid = get_ag_func_oid("_agtype_to_graphid_or_null", 1,
+                                   AGTYPEOID);
+        result = makeFuncExpr(func_oid, GRAPHIDOID, list_make1(expr),
+                              InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+        result->location = exprLocation(expr);
+
+        return (Node *)result;
+    }
+
+    return NULL;
+}
+
 static Node *transform_AEXPR_IN(cypher_parsestate *cpstate, A_Expr *a)
 {
     Oid func_in_oid;
@@ -519,6 +687,17 @@ static Node *transform_A_Indirection(cypher_parsestate *cpstate,
     ind_arg_expr = transform_cypher_expr_recurse(cpstate, a_ind->arg);
     location = exprLocation(ind_arg_expr);
 
+    // a property access on a vertex or edge only needs its properties
+    if (IsA(linitial(a_ind->indirection), String) && IsA(ind_arg_expr, Var))
+    {
+        Node *props;
+
+        props = transform_entity_column_access(cpstate, (Var *)ind_arg_expr,
+                                               AG_VERTEX_COLNAME_PROPERTIES);
+        if (props)
+            ind_arg_expr = props;
+    }
+
     args = lappend(args, ind_arg_expr);
     foreach (lc, a_ind->indirection)
     {
@@ -608,6 +787,96 @@ static Node *transform_A_Indirection(cypher_parsestate *cpstate,
     return (Node *)func_expr;
 }
 
+/*
+ * If the given variable is a vertex or an edge that the subquery of the
+ * previous clause builds from a label table, return a Var referencing the
+ * junk target entry through which that subquery exposes the given column of
+ * the label table, see add_entity_column_targets(). Otherwise, return NULL.
+ *
+ * Once the planner pulls up the subquery, expressions on the variable become
+ * expressions on the columns of the label table. For example, a property
+ * access becomes agtype_access_operator(properties, key), which is what the
+ * CREATE INDEX clause indexes, and id() becomes the primary key column. It
+ * also saves building the vertex or edge only to read a part of it.
+ */
+static Node *transform_entity_column_access(cypher_parsestate *cpstate,
+                                            Var *var, char *colname)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    RangeTblEntry *rte;
+    Query *subquery;
+    TargetEntry *te;
+    FuncExpr *fexpr;
+    Node *col;
+    ListCell *lc;
+
+    if (var->varlevelsup != 0)
+        return NULL;
+
+    rte = rt_fetch(var->varno, pstate->p_rtable);
+    if (rte->rtekind != RTE_SUBQUERY)
+        return NULL;
+
+    // the planner cannot pull up the subquery in these cases
+    subquery = rte->subquery;
+    if (subquery->hasAggs || subquery->hasWindowFuncs ||
+        subquery->hasTargetSRFs || subquery->groupClause ||
+        subquery->groupingSets || subquery->havingQual ||
+        subquery->distinctClause || subquery->setOperations)
+        return NULL;
+
+    te = get_tle_by_resno(subquery->targetList, var->varattno);
+    if (te == NULL || !IsA(te->expr, FuncExpr))
+        return NULL;
+
+    // the arguments of the build functions are the columns of the label table
+    fexpr = (FuncExpr *)te->expr;
+    if (fexpr->funcid == get_ag_func_oid("_agtype_build_vertex", 3, GRAPHIDOID,
+                                         CSTRINGOID, AGTYPEOID))
+    {
+        if (strcmp(colname, AG_VERTEX_COLNAME_ID) == 0)
+            col = linitial(fexpr->args);
+        else if (strcmp(colname, AG_VERTEX_COLNAME_PROPERTIES) == 0)
+            col = lthird(fexpr->args);
+        else
+            return NULL;
+    }
+    else if (fexpr->funcid == get_ag_func_oid("_agtype_build_edge", 5,
+                                              GRAPHIDOID, GRAPHIDOID,
+                                              GRAPHIDOID, CSTRINGOID,
+                                              AGTYPEOID))
+    {
+        if (strcmp(colname, AG_EDGE_COLNAME_ID) == 0)
+            col = linitial(fexpr->args);
+        else if (strcmp(colname, AG_EDGE_COLNAME_START_ID) == 0)
+            col = lsecond(fexpr->args);
+        else if (strcmp(colname, AG_EDGE_COLNAME_END_ID) == 0)
+            col = lthird(fexpr->args);
+        else if (strcmp(colname, AG_EDGE_COLNAME_PROPERTIES) == 0)
+            col = llast(fexpr->args);
+        else
+            return NULL;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (!IsA(col, Var) || ((Var *)col)->varlevelsup != 0)
+        return NULL;
+
+    foreach (lc, subquery->targetList)
+    {
+        te = lfirst(lc);
+
+        if (te->resjunk && equal(te->expr, col))
+            return (Node *)makeVar(var->varno, te->resno, exprType(col),
+                                   exprTypmod(col), exprCollation(col), 0);
+    }
+
+    return NULL;
+}
+
 static Node *transform_cypher_string_match(cypher_parsestate *cpstate,
                                            cypher_string_match *csm_node)
 {
@@ -77,20 +77,21 @@
 %token NOT_EQ LT_EQ GT_EQ DOT_DOT TYPECAST PLUS_EQ EQ_TILDE
 
 /* keywords in alphabetical order */
-%token <keyword> ANALYZE AND AS ASC ASCENDING
+%token <keyword> ALLSHORTESTPATHS ANALYZE AND AS ASC ASCENDING
                  BY
                  CASE COALESCE CONTAINS CREATE
                  DELETE DESC DESCENDING DETACH DISTINCT
                  ELSE END_P ENDS EXISTS EXPLAIN
                  FALSE_P
-                 IN IS
+                 IN INDEX IS
                  LIMIT
-                 MATCH
+                 MATCH MERGE
                  NOT NULL_P
-                 OR ORDER
+                 ON OR ORDER
                  REMOVE RETURN
-                 SET SKIP STARTS
+                 SET SHORTESTPATH SKIP STARTS
                  THEN TRUE_P
+                 UNWIND
                  VERBOSE
                  WHEN WHERE WITH
 
@@ -107,9 +108,17 @@
 /* MATCH clause */
 %type <node> match cypher_varlen_opt cypher_range_opt cypher_range_idx
              cypher_range_idx_opt
+
+/* UNWIND clause */
+%type <node> unwind
 %type <integer> Iconst
 /* CREATE clause */
-%type <node> create
+%type <node> create create_index
+
+/* MERGE clause */
+%type <node> merge
+%type <list> merge_action_list_opt merge_action_list
+%type <node> merge_action
 
 /* SET and REMOVE clause */
 %type <node> set set_item remove remove_item
@@ -327,6 +336,7 @@ reading_clause_list:
 
 reading_clause:
     match
+    | unwind
     ;
 
 updating_clause_list_0:
@@ -350,6 +360,8 @@ updating_clause_list_1:
 
 updating_clause:
     create
+    | create_index
+    | merge
     | set
     | remove
     | delete
@@ -675,6 +687,29 @@ match:
         }
     ;
 
+/*
+ * UNWIND clause
+ */
+
+unwind:
+    UNWIND expr AS var_name
+        {
+            ResTarget *res;
+            cypher_unwind *n;
+
+            res = makeNode(ResTarget);
+            res->name = $4;
+            res->indirection = NIL;
+            res->val = $2;
+            res->location = @2;
+
+            n = make_ag_node(cypher_unwind);
+            n->target = res;
+
+            $$ = (Node *)n;
+        }
+    ;
+
 /*
  * CREATE clause
  */
@@ -691,6 +726,89 @@ create:
         }
     ;
 
+/*
+ * MERGE clause
+ */
+
+merge:
+    MERGE path merge_action_list_opt
+        {
+            cypher_merge *n;
+
+            n = make_ag_node(cypher_merge);
+            n->path = $2;
+            n->actions = $3;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    ;
+
+merge_action_list_opt:
+    /* empty */
+        {
+            $$ = NIL;
+        }
+    | merge_action_list
+    ;
+
+merge_action_list:
+    merge_action
+        {
+            $$ = list_make1($1);
+        }
+    | merge_action_list merge_action
+        {
+            $$ = lappend($1, $2);
+        }
+    ;
+
+merge_action:
+    ON CREATE SET set_item_list
+        {
+            cypher_set *n;
+
+            n = make_ag_node(cypher_set);
+            n->items = $4;
+            n->is_remove = false;
+            n->merge_action = CYPHER_MERGE_ACTION_ON_CREATE;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | ON MATCH SET set_item_list
+        {
+            cypher_set *n;
+
+            n = make_ag_node(cypher_set);
+            n->items = $4;
+            n->is_remove = false;
+            n->merge_action = CYPHER_MERGE_ACTION_ON_MATCH;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    ;
+
+/*
+ * CREATE INDEX clause
+ */
+
+create_index:
+    CREATE INDEX var_name_opt ON ':' label_name '(' property_key_name ')'
+        {
+            cypher_create_index *n;
+
+            n = make_ag_node(cypher_create_index);
+            n->name = $3;
+            n->label = $6;
+            n->property = $8;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    ;
+
 /*
  * SET and REMOVE clause
  */
@@ -869,6 +987,31 @@ anonymous_path:
             n = make_ag_node(cypher_path);
             n->path = $1;
             n->var_name = NULL;
+            n->kind = CYPHER_PATH_DEFAULT;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | SHORTESTPATH '(' simple_path ')'
+        {
+            cypher_path *n;
+
+            n = make_ag_node(cypher_path);
+            n->path = $3;
+            n->var_name = NULL;
+            n->kind = CYPHER_PATH_SHORTEST;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | ALLSHORTESTPATHS '(' simple_path ')'
+        {
+            cypher_path *n;
+
+            n = make_ag_node(cypher_path);
+            n->path = $3;
+            n->var_name = NULL;
+            n->kind = CYPHER_PATH_ALL_SHORTEST;
             n->location = @1;
 
             $$ = (Node *)n;
@@ -1566,7 +1709,8 @@ reserved_keyword:
  */
 
 safe_keywords:
-    AND
+    ALLSHORTESTPATHS { $$ = pnstrdup($1, 16); }
+    | AND
     | AS         { $$ = pnstrdup($1, 2); }
     | ASC        { $$ = pnstrdup($1, 3); }
     | ASCENDING  { $$ = pnstrdup($1, 9); }
@@ -1584,18 +1728,23 @@ safe_keywords:
     | ENDS       { $$ = pnstrdup($1, 4); }
     | EXISTS     { $$ = pnstrdup($1, 6); }
     | IN         { $$ = pnstrdup($1, 2); }
+    | INDEX      { $$ = pnstrdup($1, 5); }
     | IS         { $$ = pnstrdup($1, 2); }
     | LIMIT      { $$ = pnstrdup($1, 6); }
     | MATCH      { $$ = pnstrdup($1, 6); }
+    | MERGE      { $$ = pnstrdup($1, 5); }
     | NOT        { $$ = pnstrdup($1, 3); }
+    | ON         { $$ = pnstrdup($1, 2); }
     | OR         { $$ = pnstrdup($1, 2); }
     | ORDER      { $$ = pnstrdup($1, 5); }
     | REMOVE     { $$ = pnstrdup($1, 6); }
     | RETURN     { $$ = pnstrdup($1, 6); }
     | SET        { $$ = pnstrdup($1, 3); }
+    | SHORTESTPATH { $$ = pnstrdup($1, 12); }
     | SKIP       { $$ = pnstrdup($1, 4); }
     | STARTS     { $$ = pnstrdup($1, 6); }
     | THEN       { $$ = pnstrdup($1, 4); }
+    | UNWIND     { $$ = pnstrdup($1, 6); }
     | WHEN       { $$ = pnstrdup($1, 4); }
     | WHERE      { $$ = pnstrdup($1, 5); }
     | WITH       { $$ = pnstrdup($1, 4); }
@@ -34,6 +34,7 @@
  * locate entries.
  */
 const ScanKeyword cypher_keywords[] = {
+    {"allshortestpaths", ALLSHORTESTPATHS, RESERVED_KEYWORD},
     {"analyze", ANALYZE, RESERVED_KEYWORD},
     {"and", AND, RESERVED_KEYWORD},
     {"as", AS, RESERVED_KEYWORD},
@@ -56,20 +57,25 @@ const ScanKeyword cypher_keywords[] = {
     {"explain", EXPLAIN, RESERVED_KEYWORD},
     {"false", FALSE_P, RESERVED_KEYWORD},
     {"in", IN, RESERVED_KEYWORD},
+    {"index", INDEX, RESERVED_KEYWORD},
     {"is", IS, RESERVED_KEYWORD},
     {"limit", LIMIT, RESERVED_KEYWORD},
     {"match", MATCH, RESERVED_KEYWORD},
+    {"merge", MERGE, RESERVED_KEYWORD},
     {"not", NOT, RESERVED_KEYWORD},
     {"null", NULL_P, RESERVED_KEYWORD},
+    {"on", ON, RESERVED_KEYWORD},
     {"or", OR, RESERVED_KEYWORD},
     {"order", ORDER, RESERVED_KEYWORD},
     {"remove", REMOVE, RESERVED_KEYWORD},
     {"return", RETURN, RESERVED_KEYWORD},
     {"set", SET, RESERVED_KEYWORD},
+    {"shortestpath", SHORTESTPATH, RESERVED_KEYWORD},
     {"skip", SKIP, RESERVED_KEYWORD},
     {"starts", STARTS, RESERVED_KEYWORD},
     {"then", THEN, RESERVED_KEYWORD},
     {"true", TRUE_P, RESERVED_KEYWORD},
+    {"unwind", UNWIND, RESERVED_KEYWORD},
     {"verbose", VERBOSE, RESERVED_KEYWORD},
     {"when", WHEN, RESERVED_KEYWORD},
     {"where", WHERE, RESERVED_KEYWORD},
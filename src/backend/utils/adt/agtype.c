@@ -27,6 +27,7 @@
 
 #include <math.h>
 
+#include "access/genam.h"
 #include "access/htup_details.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_type.h"
@@ -39,6 +40,7 @@
 #include "parser/parse_coerce.h"
 #include "nodes/pg_list.h"
 #include "utils/builtins.h"
+#include "utils/datum.h"
 #include "utils/fmgroids.h"
 #include "utils/int8.h"
 #include "utils/lsyscache.h"
@@ -48,6 +50,7 @@
 
 #include "utils/agtype.h"
 #include "utils/agtype_parser.h"
+#include "utils/ag_cache.h"
 #include "utils/ag_float8_supp.h"
 #include "catalog/ag_graph.h"
 #include "catalog/ag_label.h"
@@ -137,14 +140,17 @@ static bool is_object_vertex(agtype_value *agtv);
 static bool is_object_edge(agtype_value *agtv);
 static bool is_array_path(agtype_value *agtv);
 /* helper functions */
-static uint64 get_edge_uniqueness_value(Datum d, Oid type, bool is_null,
-                                        int index);
+static void get_edge_uniqueness_values(Datum d, Oid type, bool is_null,
+                                       int index, uint64 **ids, int *num_ids,
+                                       int *max_ids);
 /* graph entity retrieval */
-static Datum get_vertex(const char *graph, const char *vertex_label,
-                         int64 graphid);
+static Datum get_vertex(Oid graph_oid, graphid id);
+static Datum get_vertex_cached(FunctionCallInfo fcinfo, const char *graph_name,
+                               graphid id);
+static Datum get_edge_vertex(FunctionCallInfo fcinfo, char *id_key,
+                             char *func_name);
 static Datum column_get_datum(TupleDesc tupdesc, HeapTuple tuple, int column,
                         const char *attname, Oid typid, bool isnull);
-static char *get_label_name(const char *graph_name, int64 graph_id);
 static float8 get_float_compatible_arg(Datum arg, Oid type, char *funcname,
                                        bool *is_null);
 static Numeric get_numeric_compatible_arg(Datum arg, Oid type, char *funcname,
@@ -2884,22 +2890,17 @@ Datum agtype_string_match_contains(PG_FUNCTION_ARGS)
 #define LEFT_ROTATE(n, i) ((n << i) | (n >> (64 - i)))
 #define RIGHT_ROTATE(n, i)  ((n >> i) | (n << (64 - i)))
 
-//Hashing Function for Hash Indexes
-PG_FUNCTION_INFO_V1(agtype_hash_cmp);
-
-Datum agtype_hash_cmp(PG_FUNCTION_ARGS)
+/*
+ * Computes the 64-bit hash value of an agtype. The salt is mixed into the
+ * seed, so a salt of 0 gives the same value as agtype_hash_cmp().
+ */
+static uint64 agtype_hash_value(agtype *agt, uint64 salt)
 {
     uint64 hash = 0;
-    agtype *agt;
     agtype_iterator *it;
     agtype_iterator_token tok;
     agtype_value *r;
-    uint64 seed = 0xF0F0F0F0;
-
-    if (PG_ARGISNULL(0))
-        PG_RETURN_INT16(0);
-
-    agt = AG_GET_ARG_AGTYPE_P(0);
+    uint64 seed = 0xF0F0F0F0 ^ salt;
 
     r = palloc(sizeof(agtype_value));
 
@@ -2920,7 +2921,36 @@ Datum agtype_hash_cmp(PG_FUNCTION_ARGS)
         seed = LEFT_ROTATE(seed, 1);
     }
 
-    PG_RETURN_INT16(hash);
+    pfree(r);
+
+    return hash;
+}
+
+//Hashing Function for Hash Indexes
+PG_FUNCTION_INFO_V1(agtype_hash_cmp);
+
+Datum agtype_hash_cmp(PG_FUNCTION_ARGS)
+{
+    uint64 hash;
+
+    if (PG_ARGISNULL(0))
+        PG_RETURN_INT32(0);
+
+    hash = agtype_hash_value(AG_GET_ARG_AGTYPE_P(0), 0);
+
+    PG_RETURN_INT32((int32)hash);
+}
+
+// Extended Hashing Function for Hash Indexes
+PG_FUNCTION_INFO_V1(agtype_hash_extended);
+
+Datum agtype_hash_extended(PG_FUNCTION_ARGS)
+{
+    uint64 hash;
+
+    hash = agtype_hash_value(AG_GET_ARG_AGTYPE_P(0), PG_GETARG_INT64(1));
+
+    PG_RETURN_INT64((int64)hash);
 }
 
 // Comparision function for btree Indexes
@@ -3414,11 +3444,18 @@ Datum agtype_typecast_path(PG_FUNCTION_ARGS)
     PG_RETURN_POINTER(agtype_value_to_agtype(path.res));
 }
 
-static uint64 get_edge_uniqueness_value(Datum d, Oid type, bool is_null,
-                                        int index)
+/*
+ * Appends the edge ids of an argument of _ag_enforce_edge_uniqueness to ids.
+ * An argument is either the id of an edge, or the list of the edges of a
+ * variable length relationship.
+ */
+static void get_edge_uniqueness_values(Datum d, Oid type, bool is_null,
+                                       int index, uint64 **ids, int *num_ids,
+                                       int *max_ids)
 {
     agtype *agt;
-    agtype_value *v;
+    uint32 count;
+    uint32 i;
 
     if (is_null)
         ereport(
@@ -3438,25 +3475,49 @@ static uint64 get_edge_uniqueness_value(Datum d, Oid type, bool is_null,
 
     agt = DATUM_GET_AGTYPE_P(d);
 
-    if (!AGT_ROOT_IS_SCALAR(agt))
+    if (!AGT_ROOT_IS_ARRAY(agt))
         ereport(
             ERROR,
             (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
              errmsg(
-                 "agtype parameter %i in _ag_enforce_edge_uniqueness must resolve to an integer",
+                 "agtype parameter %i in _ag_enforce_edge_uniqueness must resolve to an integer or a list of edges",
                  index)));
 
-    v = get_ith_agtype_value_from_container(&agt->root, 0);
+    count = AGT_ROOT_COUNT(agt);
 
-    if (v->type != AGTV_INTEGER)
-        ereport(
-            ERROR,
-            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-             errmsg(
-                 "agtype parameter %i in _ag_enforce_edge_uniqueness must resolve to an integer",
-                 index)));
+    if (*num_ids + count > *max_ids)
+    {
+        *max_ids = Max(*max_ids * 2, *num_ids + count);
+        if (*ids == NULL)
+            *ids = palloc(sizeof(uint64) * *max_ids);
+        else
+            *ids = repalloc(*ids, sizeof(uint64) * *max_ids);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        agtype_value *v = get_ith_agtype_value_from_container(&agt->root, i);
 
-    return v->val.int_value;
+        if (AGT_ROOT_IS_SCALAR(agt) && v->type == AGTV_INTEGER)
+        {
+            (*ids)[(*num_ids)++] = v->val.int_value;
+        }
+        else if (!AGT_ROOT_IS_SCALAR(agt) && v->type == AGTV_EDGE)
+        {
+            agtype_value *id = get_agtype_value_object_value(v, "id");
+
+            (*ids)[(*num_ids)++] = id->val.int_value;
+        }
+        else
+        {
+            ereport(
+                ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg(
+                     "agtype parameter %i in _ag_enforce_edge_uniqueness must resolve to an integer or a list of edges",
+                     index)));
+        }
+    }
 }
 
 PG_FUNCTION_INFO_V1(_ag_enforce_edge_uniqueness);
@@ -3467,26 +3528,27 @@ Datum _ag_enforce_edge_uniqueness(PG_FUNCTION_ARGS)
     Datum *args;
     bool *nulls;
     Oid *types;
+    uint64 *ids = NULL;
+    int num_ids = 0;
+    int max_ids = 0;
     int i, j;
 
     nargs = extract_variadic_args(fcinfo, 0, true, &args, &types, &nulls);
 
     for (i = 0; i < nargs; i++)
-    {
-        uint64 id_1 = get_edge_uniqueness_value(args[i], types[i],
-                                                nulls[i], i);
+        get_edge_uniqueness_values(args[i], types[i], nulls[i], i, &ids,
+                                   &num_ids, &max_ids);
 
-        for (j = i + 1; j < nargs; j++)
+    for (i = 0; i < num_ids; i++)
+    {
+        for (j = i + 1; j < num_ids; j++)
         {
-            uint64 id_2 = get_edge_uniqueness_value(args[j], types[j],
-                                                    nulls[j], j);
-
-            if (id_1 == id_2)
-                return false;
+            if (ids[i] == ids[j])
+                PG_RETURN_BOOL(false);
         }
     }
 
-    return true;
+    PG_RETURN_BOOL(true);
 }
 
 /* helper function to retrieve a value, given a key, from an agtype_value */
@@ -3700,199 +3762,194 @@ static Datum column_get_datum(TupleDesc tupdesc, HeapTuple tuple, int column,
 }
 
 /*
- * Function to retrieve a label name, given the graph name and graphid. The
- * function returns a pointer to a duplicated string that needs to be freed
- * when you are finished using it.
+ * Fetch the vertex with the given graphid. The label table is found through
+ * the label cache, and the vertex through the primary key of the table.
  */
-static char *get_label_name(const char *graph_name, int64 graphid)
+static Datum get_vertex(Oid graph_oid, graphid id)
 {
-    ScanKeyData scan_keys[2];
-    Relation ag_label;
-    SysScanDesc scan_desc;
+    label_cache_data *label;
+    ScanKeyData scan_keys[1];
+    Relation graph_vertex_label;
+    Oid pk_index_oid;
     HeapTuple tuple;
     TupleDesc tupdesc;
-    char *result = NULL;
-
-    Oid graphoid = get_graph_oid(graph_name);
-
-    /* scankey for first match in ag_label, column 2, graphoid, BTEQ, OidEQ */
-    ScanKeyInit(&scan_keys[0], Anum_ag_label_graph, BTEqualStrategyNumber,
-                F_OIDEQ, ObjectIdGetDatum(graphoid));
-    /* scankey for second match in ag_label, column 3, label id, BTEQ, Int4EQ */
-    ScanKeyInit(&scan_keys[1], Anum_ag_label_id, BTEqualStrategyNumber,
-                F_INT4EQ, Int32GetDatum(get_graphid_label_id(graphid)));
-
-    ag_label = heap_open(ag_relation_id("ag_label", "table"), RowExclusiveLock);
-    scan_desc = systable_beginscan(ag_label,
-                                   ag_relation_id("ag_label_graph_id_index",
-                                                  "index"), true, NULL, 2,
-                                   scan_keys);
+    Datum vertex_id, properties, result;
+    Snapshot snapshot = GetActiveSnapshot();
+    Relation pk_index = NULL;
+    IndexScanDesc index_scan_desc = NULL;
+    HeapScanDesc heap_scan_desc = NULL;
 
-    tuple = systable_getnext(scan_desc);
-    if (!HeapTupleIsValid(tuple))
+    label = search_label_graph_id_cache(graph_oid, get_graphid_label_id(id));
+    if (!label)
     {
         ereport(ERROR,
-                (errcode(ERRCODE_UNDEFINED_SCHEMA),
-                 errmsg("graphid %lu does not exist", graphid)));
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("graphid " INT64_FORMAT " does not exist", id)));
     }
 
-    /* get the tupdesc - we don't need to release this one */
-    tupdesc = RelationGetDescr(ag_label);
+    graph_vertex_label = heap_open(label->relation, AccessShareLock);
 
+    /* get the tupdesc - we don't need to release this one */
+    tupdesc = RelationGetDescr(graph_vertex_label);
     /* bail if the number of columns differs */
-    if (tupdesc->natts != 5)
+    if (tupdesc->natts != 2)
         ereport(ERROR,
                 (errcode(ERRCODE_UNDEFINED_TABLE),
-                 errmsg("Invalid number of attributes for ag_catalog.ag_label")));
-
-    /* get the label name */
-    result = NameStr(*DatumGetName(column_get_datum(tupdesc, tuple, 0, "name",
-                                                    NAMEOID, true)));
-    /* duplicate it */
-    result = strdup(result);
-
-    /* end the scan and close the relation */
-    systable_endscan(scan_desc);
-    heap_close(ag_label, RowExclusiveLock);
-
-    return result;
-}
-
-static Datum get_vertex(const char *graph, const char *vertex_label,
-                         int64 graphid)
-{
-    ScanKeyData scan_keys[1];
-    Relation graph_vertex_label;
-    HeapScanDesc scan_desc;
-    HeapTuple tuple;
-    TupleDesc tupdesc;
-    Datum id, properties, result;
-
-    /* get the specific graph namespace (schema) */
-    Oid graph_namespace_oid = get_namespace_oid(graph, false);
-    /* get the specific vertex label table (schema.vertex_label) */
-    Oid vertex_label_table_oid = get_relname_relid(vertex_label,
-                                                 graph_namespace_oid);
-    /* get the active snapshot */
-    Snapshot snapshot = GetActiveSnapshot();
+                 errmsg("Invalid number of attributes for %s",
+                        NameStr(label->name))));
 
     /* initialize the scan key */
-    ScanKeyInit(&scan_keys[0], 1, BTEqualStrategyNumber, F_OIDEQ,
-                Int64GetDatum(graphid));
+    ScanKeyInit(&scan_keys[0], Anum_ag_label_vertex_table_id,
+                BTEqualStrategyNumber, F_GRAPHIDEQ, GRAPHID_GET_DATUM(id));
 
-    /* open the relation (table), begin the scan, and get the tuple  */
-    graph_vertex_label = heap_open(vertex_label_table_oid, RowExclusiveLock);
-    scan_desc = heap_beginscan(graph_vertex_label, snapshot, 1, scan_keys);
-    tuple = heap_getnext(scan_desc, ForwardScanDirection);
+    /*
+     * The id column of every label table is the primary key. Fall back to a
+     * scan of the table if it is missing.
+     */
+    pk_index_oid = RelationGetPrimaryKeyIndex(graph_vertex_label);
+    if (OidIsValid(pk_index_oid))
+    {
+        pk_index = index_open(pk_index_oid, AccessShareLock);
+        index_scan_desc = index_beginscan(graph_vertex_label, pk_index,
+                                          snapshot, 1, 0);
+        index_rescan(index_scan_desc, scan_keys, 1, NULL, 0);
+        tuple = index_getnext(index_scan_desc, ForwardScanDirection);
+    }
+    else
+    {
+        heap_scan_desc = heap_beginscan(graph_vertex_label, snapshot, 1,
+                                        scan_keys);
+        tuple = heap_getnext(heap_scan_desc, ForwardScanDirection);
+    }
 
     /* bail if the tuple isn't valid */
     if (!HeapTupleIsValid(tuple))
     {
         ereport(ERROR,
                 (errcode(ERRCODE_UNDEFINED_TABLE),
-                 errmsg("graphid %lu does not exist", graphid)));
+                 errmsg("graphid " INT64_FORMAT " does not exist", id)));
     }
 
-    /* get the tupdesc - we don't need to release this one */
-    tupdesc = RelationGetDescr(graph_vertex_label);
-    /* bail if the number of columns differs */
-    if (tupdesc->natts != 2)
-        ereport(ERROR,
-                (errcode(ERRCODE_UNDEFINED_TABLE),
-                 errmsg("Invalid number of attributes for %s.%s", graph,
-                        vertex_label )));
-
     /* get the id */
-    id = column_get_datum(tupdesc, tuple, 0, "id", GRAPHIDOID, true);
+    vertex_id = column_get_datum(tupdesc, tuple, 0, "id", GRAPHIDOID, true);
     /* get the properties */
     properties = column_get_datum(tupdesc, tuple, 1, "properties",
                                   AGTYPEOID, true);
     /* reconstruct the vertex */
-    result = DirectFunctionCall3(_agtype_build_vertex, id,
-                                 CStringGetDatum(vertex_label), properties);
+    result = DirectFunctionCall3(_agtype_build_vertex, vertex_id,
+                                 CStringGetDatum(NameStr(label->name)),
+                                 properties);
+
     /* end the scan and close the relation */
-    heap_endscan(scan_desc);
-    heap_close(graph_vertex_label, RowExclusiveLock);
+    if (index_scan_desc)
+    {
+        index_endscan(index_scan_desc);
+        index_close(pk_index, AccessShareLock);
+    }
+    else
+    {
+        heap_endscan(heap_scan_desc);
+    }
+    heap_close(graph_vertex_label, AccessShareLock);
+
     /* return the vertex datum */
     return result;
 }
 
-PG_FUNCTION_INFO_V1(age_startnode);
+/*
+ * startNode() and endNode() keep the vertices they fetched last in a small
+ * direct-mapped cache, so that edges sharing a vertex don't fetch it again.
+ * The cache lives in fn_extra for the duration of the query, and is flushed
+ * whenever the command id changes, since the clauses of the query may have
+ * modified the vertices by then.
+ */
+#define VERTEX_CACHE_SIZE 64
 
-Datum age_startnode(PG_FUNCTION_ARGS)
+typedef struct vertex_cache_entry
 {
-    agtype *agt_arg = NULL;
-    agtype_value *agtv_object = NULL;
-    agtype_value *agtv_value = NULL;
-    char *graph_name = NULL;
-    char *label_name = NULL;
-    graphid graph_id;
-    Datum result;
+    graphid id;
+    Datum vertex;
+} vertex_cache_entry;
 
-    /* we need the graph name */
-    Assert(PG_ARGISNULL(0) == false);
+typedef struct vertex_cache
+{
+    Oid graph_oid;
+    CommandId cid;
+    vertex_cache_entry entries[VERTEX_CACHE_SIZE];
+} vertex_cache;
 
-    /* check for null */
-    if (PG_ARGISNULL(1))
-        PG_RETURN_NULL();
+static Datum get_vertex_cached(FunctionCallInfo fcinfo, const char *graph_name,
+                               graphid id)
+{
+    vertex_cache *cache = fcinfo->flinfo->fn_extra;
+    CommandId cid = GetActiveSnapshot()->curcid;
+    vertex_cache_entry *entry;
+    MemoryContext old_mctx;
 
-    /* get the graph name */
-    agt_arg = AG_GET_ARG_AGTYPE_P(0);
-    /* it must be a scalar and must be a string */
-    Assert(AGT_ROOT_IS_SCALAR(agt_arg));
-    agtv_object = get_ith_agtype_value_from_container(&agt_arg->root, 0);
-    Assert(agtv_object->type == AGTV_STRING);
-    graph_name = strndup(agtv_object->val.string.val,
-                         agtv_object->val.string.len);
+    if (cache == NULL)
+    {
+        graph_cache_data *graph;
 
-    /* get the edge */
-    agt_arg = AG_GET_ARG_AGTYPE_P(1);
-    /* check for a scalar object */
-    if (!AGT_ROOT_IS_SCALAR(agt_arg))
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                        errmsg("startNode() argument must resolve to a scalar value")));
-    /* get the object */
-    agtv_object = get_ith_agtype_value_from_container(&agt_arg->root, 0);
+        graph = search_graph_name_cache(graph_name);
+        if (!graph)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                     errmsg("graph \"%s\" does not exist", graph_name)));
+        }
 
-    /* is it an agtype null, return null if it is */
-    if (agtv_object->type == AGTV_NULL)
-            PG_RETURN_NULL();
+        cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+                                       sizeof(vertex_cache));
+        cache->graph_oid = graph->oid;
+        cache->cid = cid;
+        fcinfo->flinfo->fn_extra = cache;
+    }
+    else if (cache->cid != cid)
+    {
+        int i;
 
-    /* check for proper agtype */
-    if (agtv_object->type != AGTV_EDGE)
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                        errmsg("startNode() argument must be an edge or null")));
+        for (i = 0; i < VERTEX_CACHE_SIZE; i++)
+        {
+            if (cache->entries[i].vertex != (Datum)0)
+                pfree(DatumGetPointer(cache->entries[i].vertex));
+        }
+        MemSet(cache->entries, 0, sizeof(cache->entries));
+        cache->cid = cid;
+    }
 
-    /* get the graphid for start_id */
-    agtv_value = get_agtype_value_object_value(agtv_object, "start_id");
-    /* it must not be null and must be an integer */
-    Assert(agtv_value != NULL);
-    Assert(agtv_value->type = AGTV_INTEGER);
-    graph_id = agtv_value->val.int_value;
+    entry = &cache->entries[(uint64)id % VERTEX_CACHE_SIZE];
+    if (entry->vertex == (Datum)0 || entry->id != id)
+    {
+        Datum vertex = get_vertex(cache->graph_oid, id);
 
-    /* get the label */
-    label_name = get_label_name(graph_name, graph_id);
-    /* it must not be null and must be a string */
-    Assert(label_name != NULL);
+        if (entry->vertex != (Datum)0)
+            pfree(DatumGetPointer(entry->vertex));
 
-    result = get_vertex(graph_name, label_name, graph_id);
+        old_mctx = MemoryContextSwitchTo(fcinfo->flinfo->fn_mcxt);
+        entry->vertex = datumCopy(vertex, false, -1);
+        MemoryContextSwitchTo(old_mctx);
+        entry->id = id;
 
-    free(label_name);
+        return vertex;
+    }
 
-    return result;
+    /* the caller owns the result, so hand out a copy of the cached vertex */
+    return datumCopy(entry->vertex, false, -1);
 }
 
-PG_FUNCTION_INFO_V1(age_endnode);
-
-Datum age_endnode(PG_FUNCTION_ARGS)
+/*
+ * Common code of startNode() and endNode(). The first argument is the graph
+ * name, the second one is the edge, and id_key is the key of the id of the
+ * vertex to return in the edge.
+ */
+static Datum get_edge_vertex(FunctionCallInfo fcinfo, char *id_key,
+                             char *func_name)
 {
     agtype *agt_arg = NULL;
     agtype_value *agtv_object = NULL;
     agtype_value *agtv_value = NULL;
     char *graph_name = NULL;
-    char *label_name = NULL;
     graphid graph_id;
-    Datum result;
 
     /* we need the graph name */
     Assert(PG_ARGISNULL(0) == false);
@@ -3907,15 +3964,16 @@ Datum age_endnode(PG_FUNCTION_ARGS)
     Assert(AGT_ROOT_IS_SCALAR(agt_arg));
     agtv_object = get_ith_agtype_value_from_container(&agt_arg->root, 0);
     Assert(agtv_object->type == AGTV_STRING);
-    graph_name = strndup(agtv_object->val.string.val,
-                         agtv_object->val.string.len);
+    graph_name = pnstrdup(agtv_object->val.string.val,
+                          agtv_object->val.string.len);
 
     /* get the edge */
     agt_arg = AG_GET_ARG_AGTYPE_P(1);
     /* check for a scalar object */
     if (!AGT_ROOT_IS_SCALAR(agt_arg))
         ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                        errmsg("endNode() argument must resolve to a scalar value")));
+                        errmsg("%s() argument must resolve to a scalar value",
+                               func_name)));
     /* get the object */
     agtv_object = get_ith_agtype_value_from_container(&agt_arg->root, 0);
 
@@ -3926,25 +3984,31 @@ Datum age_endnode(PG_FUNCTION_ARGS)
     /* check for proper agtype */
     if (agtv_object->type != AGTV_EDGE)
         ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                        errmsg("endNode() argument must be an edge or null")));
+                        errmsg("%s() argument must be an edge or null",
+                               func_name)));
 
-    /* get the graphid for the end_id */
-    agtv_value = get_agtype_value_object_value(agtv_object, "end_id");
+    /* get the graphid of the vertex */
+    agtv_value = get_agtype_value_object_value(agtv_object, id_key);
     /* it must not be null and must be an integer */
     Assert(agtv_value != NULL);
     Assert(agtv_value->type = AGTV_INTEGER);
     graph_id = agtv_value->val.int_value;
 
-    /* get the label */
-    label_name = get_label_name(graph_name, graph_id);
-    /* it must not be null and must be a string */
-    Assert(label_name != NULL);
+    return get_vertex_cached(fcinfo, graph_name, graph_id);
+}
 
-    result = get_vertex(graph_name, label_name, graph_id);
+PG_FUNCTION_INFO_V1(age_startnode);
+
+Datum age_startnode(PG_FUNCTION_ARGS)
+{
+    return get_edge_vertex(fcinfo, "start_id", "startNode");
+}
 
-    free(label_name);
+PG_FUNCTION_INFO_V1(age_endnode);
 
-    return result;
+Datum age_endnode(PG_FUNCTION_ARGS)
+{
+    return get_edge_vertex(fcinfo, "end_id", "endNode");
 }
 
 PG_FUNCTION_INFO_V1(age_head);
@@ -4607,13 +4671,73 @@ Datum agtype_to_graphid(PG_FUNCTION_ARGS)
     agtype *agtype_in = AG_GET_ARG_AGTYPE_P(0);
     agtype_value agtv;
 
-    if (!agtype_extract_scalar(&agtype_in->root, &agtv) ||
-        agtv.type != AGTV_INTEGER)
+    if (!agtype_extract_scalar(&agtype_in->root, &agtv))
+        cannot_cast_agtype_value(agtv.type, "graphid");
+
+    /* an agtype null is a NULL graphid */
+    if (agtv.type == AGTV_NULL)
+        PG_RETURN_NULL();
+
+    if (agtv.type != AGTV_INTEGER)
         cannot_cast_agtype_value(agtv.type, "graphid");
 
     PG_FREE_IF_COPY(agtype_in, 0);
 
-    PG_RETURN_INT16(agtv.val.int_value);
+    AG_RETURN_GRAPHID(agtv.val.int_value);
+}
+
+PG_FUNCTION_INFO_V1(_agtype_to_graphid_or_null);
+
+/*
+ * Convert an agtype to the graphid that is equal to it, as an id compared to
+ * a parameter is. Unlike agtype_to_graphid(), return NULL rather than raising
+ * an error for a value that no graphid is equal to.
+ */
+Datum _agtype_to_graphid_or_null(PG_FUNCTION_ARGS)
+{
+    agtype *agtype_in = AG_GET_ARG_AGTYPE_P(0);
+    agtype_value agtv;
+    float8 f;
+
+    if (!agtype_extract_scalar(&agtype_in->root, &agtv))
+        PG_RETURN_NULL();
+
+    switch (agtv.type)
+    {
+    case AGTV_INTEGER:
+        AG_RETURN_GRAPHID(agtv.val.int_value);
+    case AGTV_FLOAT:
+        f = agtv.val.float_value;
+
+        if (isnan(f) || f != floor(f) || f < (float8)PG_INT64_MIN ||
+            f >= -((float8)PG_INT64_MIN))
+            PG_RETURN_NULL();
+
+        AG_RETURN_GRAPHID((int64)f);
+    case AGTV_NUMERIC:
+    {
+        Datum num = NumericGetDatum(agtv.val.numeric);
+        Datum trunc;
+
+        if (numeric_is_nan(agtv.val.numeric))
+            PG_RETURN_NULL();
+
+        // only an integral numeric is equal to an integer
+        trunc = DirectFunctionCall2(numeric_trunc, num, Int32GetDatum(0));
+        if (!DatumGetBool(DirectFunctionCall2(numeric_eq, num, trunc)))
+            PG_RETURN_NULL();
+
+        f = DatumGetFloat8(DirectFunctionCall1(numeric_float8_no_overflow,
+                                               num));
+        if (f < (float8)PG_INT64_MIN || f >= -((float8)PG_INT64_MIN))
+            PG_RETURN_NULL();
+
+        AG_RETURN_GRAPHID(DatumGetInt64(DirectFunctionCall1(numeric_int8,
+                                                            num)));
+    }
+    default:
+        PG_RETURN_NULL();
+    }
 }
 
 PG_FUNCTION_INFO_V1(age_type);
@@ -7313,99 +7437,6 @@ Datum age_timestamp(PG_FUNCTION_ARGS)
     PG_RETURN_POINTER(agtype_value_to_agtype(&agtv_result));
 }
 
-agtype_value *alter_property_value(agtype_value *properties, char *var_name, agtype *new_v, bool remove_property)
-{
-    agtype_iterator *it;
-    agtype_iterator_token tok = WAGT_DONE;
-    agtype_parse_state *parse_state = NULL;
-    agtype_value *r;
-    agtype *prop_agtype;
-    agtype_value *parsed_agtype_value = NULL;
-    bool found;
-
-    if (properties == NULL)
-        return NULL;
-
-    if (properties->type != AGTV_OBJECT)
-        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-                        errmsg("can only update objects")));
-
-    r = palloc(sizeof(agtype_value));
-
-    prop_agtype = agtype_value_to_agtype(properties);
-    it = agtype_iterator_init(&prop_agtype->root);
-    tok = agtype_iterator_next(&it, r, true);
-
-    parsed_agtype_value = push_agtype_value(&parse_state, tok, tok < WAGT_BEGIN_ARRAY ? r : NULL);
-
-    if (new_v == NULL)
-        remove_property = true;
-
-    found = false;
-    while (true)
-    {
-        char *str;
-
-        tok = agtype_iterator_next(&it, r, true);
-
-        if (tok == WAGT_DONE || tok == WAGT_END_OBJECT)
-            break;
-
-        str = pnstrdup(r->val.string.val, r->val.string.len);
-        if (strcmp(str, var_name))
-        {
-            parsed_agtype_value = push_agtype_value(
-                &parse_state, tok, tok < WAGT_BEGIN_ARRAY ? r : NULL);
-
-            tok = agtype_iterator_next(&it, r, true);
-
-            parsed_agtype_value = push_agtype_value(&parse_state, tok, r);
-        }
-        else
-        {
-            agtype_value *new_agtype_value_v;
-
-            if(remove_property)
-            {
-                tok = agtype_iterator_next(&it, r, true);
-                continue;
-            }
-
-            parsed_agtype_value = push_agtype_value(
-                &parse_state, tok, tok < WAGT_BEGIN_ARRAY ? r : NULL);
-
-            new_agtype_value_v = get_ith_agtype_value_from_container(&new_v->root, 0);
-
-            tok = agtype_iterator_next(&it, r, true);
-
-            parsed_agtype_value = push_agtype_value(&parse_state, tok, new_agtype_value_v);
-            found = true;
-        }
-    }
-
-    /*
-     * If we have not found the property and we aren't trying to remove it,
-     * add the key/value pair now.
-     */
-    if (!found && !remove_property)
-    {
-        agtype_value *new_agtype_value_v;
-
-        parsed_agtype_value = push_agtype_value(
-            &parse_state, WAGT_KEY, string_to_agtype_value(var_name));
-
-        new_agtype_value_v = get_ith_agtype_value_from_container(&new_v->root, 0);
-
-        tok = agtype_iterator_next(&it, r, true);
-
-        parsed_agtype_value = push_agtype_value(&parse_state, WAGT_VALUE, new_agtype_value_v);
-    }
-
-    parsed_agtype_value = push_agtype_value(&parse_state, WAGT_END_OBJECT, NULL);
-
-    return parsed_agtype_value;
-}
-
 /*
  * Helper function to extract 1 datum from a variadic "any" and convert, if
  * possible, to an agtype, if it isn't already.
@@ -8104,3 +8135,193 @@ Datum age_collect_aggfinalfn(PG_FUNCTION_ARGS)
     /* return the agtype array */
     PG_RETURN_POINTER(agtype_value_to_agtype(castate->res));
 }
+
+/*
+ * collect() can be aggregated partially in parallel workers. The states of
+ * the workers are passed to the leader as agtype arrays, and the leader
+ * appends the elements of each array to its own state.
+ */
+static agtype_in_state *make_collect_state(void)
+{
+    agtype_in_state *castate;
+
+    castate = palloc0(sizeof(agtype_in_state));
+    castate->res = push_agtype_value(&castate->parse_state, WAGT_BEGIN_ARRAY,
+                                     NULL);
+
+    return castate;
+}
+
+/*
+ * Append an element to the array of the state. Only scalars can be pushed as
+ * they are, so nested lists and maps are serialized and pushed as binary.
+ */
+static void push_collect_element(agtype_in_state *castate,
+                                 agtype_value *elem)
+{
+    if (elem->type == AGTV_ARRAY || elem->type == AGTV_OBJECT)
+    {
+        agtype *agt = agtype_value_to_agtype(elem);
+        agtype_value binary;
+
+        binary.type = AGTV_BINARY;
+        binary.val.binary.data = &agt->root;
+        binary.val.binary.len = VARSIZE(agt) - VARHDRSZ;
+
+        castate->res = push_agtype_value(&castate->parse_state, WAGT_ELEM,
+                                         &binary);
+    }
+    else
+    {
+        castate->res = push_agtype_value(&castate->parse_state, WAGT_ELEM,
+                                         elem);
+    }
+}
+
+PG_FUNCTION_INFO_V1(age_collect_aggcombinefn);
+
+Datum age_collect_aggcombinefn(PG_FUNCTION_ARGS)
+{
+    agtype_in_state *castate1;
+    agtype_in_state *castate2;
+    agtype_value *array;
+    MemoryContext old_mcxt;
+    int i;
+
+    /* verify we are in an aggregate context */
+    Assert(AggCheckCallContext(fcinfo, NULL) == AGG_CONTEXT_AGGREGATE);
+
+    if (PG_ARGISNULL(1))
+    {
+        if (PG_ARGISNULL(0))
+            PG_RETURN_NULL();
+        PG_RETURN_POINTER(PG_GETARG_POINTER(0));
+    }
+
+    castate2 = (agtype_in_state *) PG_GETARG_POINTER(1);
+
+    /* switch to the correct aggregate context */
+    old_mcxt = MemoryContextSwitchTo(fcinfo->flinfo->fn_mcxt);
+
+    if (PG_ARGISNULL(0))
+        castate1 = make_collect_state();
+    else
+        castate1 = (agtype_in_state *) PG_GETARG_POINTER(0);
+
+    /* append the elements collected so far by the second state */
+    array = &castate2->parse_state->cont_val;
+    for (i = 0; i < array->val.array.num_elems; i++)
+        push_collect_element(castate1, &array->val.array.elems[i]);
+
+    /* restore the old context */
+    MemoryContextSwitchTo(old_mcxt);
+
+    PG_RETURN_POINTER(castate1);
+}
+
+PG_FUNCTION_INFO_V1(age_collect_aggserialfn);
+
+Datum age_collect_aggserialfn(PG_FUNCTION_ARGS)
+{
+    agtype_in_state *castate;
+    agtype_value array;
+
+    castate = (agtype_in_state *) PG_GETARG_POINTER(0);
+
+    /* the array is still open, so serialize a closed copy of it */
+    array = castate->parse_state->cont_val;
+    array.val.array.raw_scalar = false;
+
+    PG_RETURN_BYTEA_P((bytea *)agtype_value_to_agtype(&array));
+}
+
+PG_FUNCTION_INFO_V1(age_collect_aggdeserialfn);
+
+Datum age_collect_aggdeserialfn(PG_FUNCTION_ARGS)
+{
+    agtype *agt_arg;
+    agtype_in_state *castate;
+    MemoryContext old_mcxt;
+    uint32 count;
+    uint32 i;
+
+    /* switch to the correct aggregate context */
+    old_mcxt = MemoryContextSwitchTo(fcinfo->flinfo->fn_mcxt);
+
+    /*
+     * The scalar elements of the state point into the array, so it is copied
+     * into the aggregate context instead of being read from the input.
+     */
+    agt_arg = (agtype *) PG_GETARG_BYTEA_P_COPY(0);
+
+    castate = make_collect_state();
+
+    count = AGT_ROOT_COUNT(agt_arg);
+    for (i = 0; i < count; i++)
+    {
+        push_collect_element(
+            castate, get_ith_agtype_value_from_container(&agt_arg->root, i));
+    }
+
+    /* restore the old context */
+    MemoryContextSwitchTo(old_mcxt);
+
+    PG_RETURN_POINTER(castate);
+}
+
+PG_FUNCTION_INFO_V1(age_unnest);
+
+/*
+ * Returns the elements of an agtype list one at a time, for UNWIND. The list
+ * is detoasted once for all the calls, and each element is only built when
+ * it is returned. A value that is not a list is returned as is, and null
+ * returns no rows.
+ */
+Datum age_unnest(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    agtype *agt;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext old_mcxt;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        old_mcxt = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        agt = AG_GET_ARG_AGTYPE_P(0);
+
+        if (!AGT_ROOT_IS_SCALAR(agt) && AGT_ROOT_IS_ARRAY(agt))
+            funcctx->max_calls = AGT_ROOT_COUNT(agt);
+        else if (AGT_ROOT_IS_SCALAR(agt) &&
+                 get_ith_agtype_value_from_container(&agt->root, 0)->type ==
+                     AGTV_NULL)
+            funcctx->max_calls = 0;
+        else
+            funcctx->max_calls = 1;
+
+        funcctx->user_fctx = agt;
+
+        MemoryContextSwitchTo(old_mcxt);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    agt = (agtype *)funcctx->user_fctx;
+
+    if (funcctx->call_cntr < funcctx->max_calls)
+    {
+        agtype_value *elem;
+
+        if (AGT_ROOT_IS_SCALAR(agt) || !AGT_ROOT_IS_ARRAY(agt))
+            SRF_RETURN_NEXT(funcctx, AGTYPE_P_GET_DATUM(agt));
+
+        elem = get_ith_agtype_value_from_container(&agt->root,
+                                                   funcctx->call_cntr);
+
+        SRF_RETURN_NEXT(funcctx,
+                        AGTYPE_P_GET_DATUM(agtype_value_to_agtype(elem)));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
@@ -180,3 +180,97 @@ static void ag_deserialize_composite(char *base, enum agtype_value_type type,
     result->type = type;
     result->val = parsed_agtype_value->val;
 }
+
+/*
+ * Returns the data of the extended type held by a scalar agtype, which starts
+ * with its AGT_HEADER, or NULL if the scalar is not one of our types.
+ */
+static char *get_extended_scalar_data(agtype *agt)
+{
+    if (!AGT_ROOT_IS_SCALAR(agt) || !AGTE_IS_AGTYPE(agt->root.children[0]))
+        return NULL;
+
+    /* the data of the scalar starts, aligned, right after its agtentry */
+    return (char *)&agt->root.children[1];
+}
+
+/*
+ * Returns the object container of the vertex or edge held by a scalar agtype,
+ * and its type in *type, so that its fields can be looked up without
+ * deserializing it. Returns NULL if the agtype is not a vertex or an edge.
+ */
+agtype_container *ag_get_entity_container(agtype *agt,
+                                          enum agtype_value_type *type)
+{
+    char *base = get_extended_scalar_data(agt);
+    AGT_HEADER_TYPE agt_header;
+
+    if (base == NULL)
+        return NULL;
+
+    agt_header = *((AGT_HEADER_TYPE *)base);
+
+    if (agt_header == AGT_HEADER_VERTEX)
+        *type = AGTV_VERTEX;
+    else if (agt_header == AGT_HEADER_EDGE)
+        *type = AGTV_EDGE;
+    else
+        return NULL;
+
+    return (agtype_container *)(base + AGT_HEADER_SIZE);
+}
+
+/*
+ * Returns whether the path held by a scalar agtype contains the vertex or edge
+ * with the given id. The ids are compared in the serialized path, without
+ * deserializing its vertices and edges. Returns false if the agtype is not a
+ * path.
+ */
+bool ag_path_contains_entity(agtype *agt, graphid id)
+{
+    char *base = get_extended_scalar_data(agt);
+    agtype_container *path;
+    char *base_addr;
+    agtype_value key;
+    uint32 offset = 0;
+    int count;
+    int i;
+
+    if (base == NULL || *((AGT_HEADER_TYPE *)base) != AGT_HEADER_PATH)
+        return false;
+
+    path = (agtype_container *)(base + AGT_HEADER_SIZE);
+    count = AGTYPE_CONTAINER_SIZE(path);
+    base_addr = (char *)&path->children[count];
+
+    key.type = AGTV_STRING;
+    key.val.string.val = "id";
+    key.val.string.len = 2;
+
+    for (i = 0; i < count; i++)
+    {
+        agtentry entry = path->children[i];
+
+        if (AGTE_IS_AGTYPE(entry))
+        {
+            char *elem = base_addr + INTALIGN(offset);
+            AGT_HEADER_TYPE agt_header = *((AGT_HEADER_TYPE *)elem);
+
+            if (agt_header == AGT_HEADER_VERTEX || agt_header == AGT_HEADER_EDGE)
+            {
+                agtype_value *elem_id;
+
+                elem_id = find_agtype_value_from_container(
+                    (agtype_container *)(elem + AGT_HEADER_SIZE), AGT_FOBJECT,
+                    &key);
+
+                if (elem_id != NULL && elem_id->val.int_value == id)
+                    return true;
+            }
+        }
+
+        AGTE_ADVANCE_OFFSET(offset, entry);
+    }
+
+    return false;
+}
@@ -0,0 +1,506 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * GIN support functions for agtype.
+ *
+ * agtype_ops_gin indexes the keys and the scalar values of an agtype, while
+ * agtype_path_ops_gin indexes a hash of each scalar value together with the
+ * keys leading to it. Both support the containment operator (@>), which is
+ * what property constraints in MATCH patterns are transformed into.
+ */
+
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/gin.h"
+#include "access/hash.h"
+#include "catalog/pg_collation.h"
+#include "utils/builtins.h"
+#include "utils/varlena.h"
+
+#include "utils/agtype.h"
+
+typedef struct path_hash_stack
+{
+    uint32 hash;
+    struct path_hash_stack *parent;
+} path_hash_stack;
+
+static Datum make_text_key(char flag, const char *str, int len);
+static Datum make_scalar_key(const agtype_value *scalar_val, bool is_key);
+
+/*
+ * agtype_ops_gin
+ */
+
+PG_FUNCTION_INFO_V1(gin_compare_agtype);
+
+Datum gin_compare_agtype(PG_FUNCTION_ARGS)
+{
+    text *arg1 = PG_GETARG_TEXT_PP(0);
+    text *arg2 = PG_GETARG_TEXT_PP(1);
+    int32 result;
+
+    // compare text as bttextcmp does, but always using C collation
+    result = varstr_cmp(VARDATA_ANY(arg1), VARSIZE_ANY_EXHDR(arg1),
+                        VARDATA_ANY(arg2), VARSIZE_ANY_EXHDR(arg2),
+                        C_COLLATION_OID);
+
+    PG_FREE_IF_COPY(arg1, 0);
+    PG_FREE_IF_COPY(arg2, 1);
+
+    PG_RETURN_INT32(result);
+}
+
+PG_FUNCTION_INFO_V1(gin_extract_agtype);
+
+Datum gin_extract_agtype(PG_FUNCTION_ARGS)
+{
+    agtype *agt = AG_GET_ARG_AGTYPE_P(0);
+    int32 *nentries = (int32 *)PG_GETARG_POINTER(1);
+    int total = 2 * AGT_ROOT_COUNT(agt);
+    agtype_iterator *it;
+    agtype_value v;
+    agtype_iterator_token tok;
+    int i = 0;
+    Datum *entries;
+
+    // if the root level is empty, there are no keys
+    if (total == 0)
+    {
+        *nentries = 0;
+        PG_RETURN_POINTER(NULL);
+    }
+
+    // otherwise, use 2 * root count as the initial estimate of result size
+    entries = (Datum *)palloc(sizeof(Datum) * total);
+
+    it = agtype_iterator_init(&agt->root);
+
+    while ((tok = agtype_iterator_next(&it, &v, false)) != WAGT_DONE)
+    {
+        // we recurse into nested containers, so we might need more space
+        if (i >= total)
+        {
+            total *= 2;
+            entries = (Datum *)repalloc(entries, sizeof(Datum) * total);
+        }
+
+        switch (tok)
+        {
+        case WAGT_KEY:
+            entries[i++] = make_scalar_key(&v, true);
+            break;
+        case WAGT_ELEM:
+            // string array elements are indexed as keys, see agtype.h
+            entries[i++] = make_scalar_key(&v, (v.type == AGTV_STRING));
+            break;
+        case WAGT_VALUE:
+            entries[i++] = make_scalar_key(&v, false);
+            break;
+        default:
+            // structural tokens are not indexed
+            break;
+        }
+    }
+
+    *nentries = i;
+
+    PG_RETURN_POINTER(entries);
+}
+
+PG_FUNCTION_INFO_V1(gin_extract_agtype_query);
+
+Datum gin_extract_agtype_query(PG_FUNCTION_ARGS)
+{
+    int32 *nentries = (int32 *)PG_GETARG_POINTER(1);
+    StrategyNumber strategy = PG_GETARG_UINT16(2);
+    int32 *search_mode = (int32 *)PG_GETARG_POINTER(6);
+    Datum *entries;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    // the query is an agtype, so extract its entries like the indexed values
+    entries = (Datum *)DatumGetPointer(DirectFunctionCall2(
+        gin_extract_agtype, PG_GETARG_DATUM(0), PointerGetDatum(nentries)));
+
+    // "contains {}" requires a full index scan
+    if (*nentries == 0)
+        *search_mode = GIN_SEARCH_MODE_ALL;
+
+    PG_RETURN_POINTER(entries);
+}
+
+PG_FUNCTION_INFO_V1(gin_consistent_agtype);
+
+Datum gin_consistent_agtype(PG_FUNCTION_ARGS)
+{
+    bool *check = (bool *)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    bool *recheck = (bool *)PG_GETARG_POINTER(5);
+    int32 i;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    /*
+     * Every key of the query must be present. The index doesn't know where
+     * the keys and values were found in the structure, so the match must
+     * always be rechecked.
+     */
+    *recheck = true;
+
+    for (i = 0; i < nkeys; i++)
+    {
+        if (!check[i])
+            PG_RETURN_BOOL(false);
+    }
+
+    PG_RETURN_BOOL(true);
+}
+
+PG_FUNCTION_INFO_V1(gin_triconsistent_agtype);
+
+Datum gin_triconsistent_agtype(PG_FUNCTION_ARGS)
+{
+    GinTernaryValue *check = (GinTernaryValue *)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    int32 i;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    // see gin_consistent_agtype(), the result is never better than maybe
+    for (i = 0; i < nkeys; i++)
+    {
+        if (check[i] == GIN_FALSE)
+            PG_RETURN_GIN_TERNARY_VALUE(GIN_FALSE);
+    }
+
+    PG_RETURN_GIN_TERNARY_VALUE(GIN_MAYBE);
+}
+
+/*
+ * agtype_path_ops_gin
+ */
+
+PG_FUNCTION_INFO_V1(gin_extract_agtype_path);
+
+Datum gin_extract_agtype_path(PG_FUNCTION_ARGS)
+{
+    agtype *agt = AG_GET_ARG_AGTYPE_P(0);
+    int32 *nentries = (int32 *)PG_GETARG_POINTER(1);
+    int total = 2 * AGT_ROOT_COUNT(agt);
+    agtype_iterator *it;
+    agtype_value v;
+    agtype_iterator_token tok;
+    path_hash_stack tail;
+    path_hash_stack *stack;
+    int i = 0;
+    Datum *entries;
+
+    // if the root level is empty, there are no values
+    if (total == 0)
+    {
+        *nentries = 0;
+        PG_RETURN_POINTER(NULL);
+    }
+
+    // otherwise, use 2 * root count as the initial estimate of result size
+    entries = (Datum *)palloc(sizeof(Datum) * total);
+
+    // keep a stack of partial hashes corresponding to parent key levels
+    tail.parent = NULL;
+    tail.hash = 0;
+    stack = &tail;
+
+    it = agtype_iterator_init(&agt->root);
+
+    while ((tok = agtype_iterator_next(&it, &v, false)) != WAGT_DONE)
+    {
+        path_hash_stack *parent;
+
+        // we recurse into nested containers, so we might need more space
+        if (i >= total)
+        {
+            total *= 2;
+            entries = (Datum *)repalloc(entries, sizeof(Datum) * total);
+        }
+
+        switch (tok)
+        {
+        case WAGT_BEGIN_ARRAY:
+        case WAGT_BEGIN_OBJECT:
+            /*
+             * Push a stack level for this container. The hash of the outer
+             * keys is passed forward, so the hashes of nested values include
+             * every key leading to them.
+             */
+            parent = stack;
+            stack = (path_hash_stack *)palloc(sizeof(path_hash_stack));
+            stack->hash = parent->hash;
+            stack->parent = parent;
+            break;
+        case WAGT_KEY:
+            // mix the key into the hash, it is now ready for the value
+            agtype_hash_scalar_value(&v, &stack->hash);
+            break;
+        case WAGT_ELEM:
+        case WAGT_VALUE:
+            // mix the element or value into the hash and emit an entry
+            agtype_hash_scalar_value(&v, &stack->hash);
+            entries[i++] = UInt32GetDatum(stack->hash);
+            // reset the hash for the next key, value, or nested container
+            stack->hash = stack->parent->hash;
+            break;
+        case WAGT_END_ARRAY:
+        case WAGT_END_OBJECT:
+            // pop the stack
+            parent = stack->parent;
+            pfree(stack);
+            stack = parent;
+            // reset the hash for the next key, value, or nested container
+            if (stack->parent)
+                stack->hash = stack->parent->hash;
+            else
+                stack->hash = 0;
+            break;
+        default:
+            elog(ERROR, "invalid agtype_iterator_next token: %d", (int)tok);
+        }
+    }
+
+    *nentries = i;
+
+    PG_RETURN_POINTER(entries);
+}
+
+PG_FUNCTION_INFO_V1(gin_extract_agtype_query_path);
+
+Datum gin_extract_agtype_query_path(PG_FUNCTION_ARGS)
+{
+    int32 *nentries = (int32 *)PG_GETARG_POINTER(1);
+    StrategyNumber strategy = PG_GETARG_UINT16(2);
+    int32 *search_mode = (int32 *)PG_GETARG_POINTER(6);
+    Datum *entries;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    // the query is an agtype, so extract its entries like the indexed values
+    entries = (Datum *)DatumGetPointer(DirectFunctionCall2(
+        gin_extract_agtype_path, PG_GETARG_DATUM(0),
+        PointerGetDatum(nentries)));
+
+    // "contains {}" requires a full index scan
+    if (*nentries == 0)
+        *search_mode = GIN_SEARCH_MODE_ALL;
+
+    PG_RETURN_POINTER(entries);
+}
+
+PG_FUNCTION_INFO_V1(gin_consistent_agtype_path);
+
+Datum gin_consistent_agtype_path(PG_FUNCTION_ARGS)
+{
+    bool *check = (bool *)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    bool *recheck = (bool *)PG_GETARG_POINTER(5);
+    int32 i;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    // the hashes can collide, so the match must always be rechecked
+    *recheck = true;
+
+    for (i = 0; i < nkeys; i++)
+    {
+        if (!check[i])
+            PG_RETURN_BOOL(false);
+    }
+
+    PG_RETURN_BOOL(true);
+}
+
+PG_FUNCTION_INFO_V1(gin_triconsistent_agtype_path);
+
+Datum gin_triconsistent_agtype_path(PG_FUNCTION_ARGS)
+{
+    GinTernaryValue *check = (GinTernaryValue *)PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    int32 i;
+
+    if (strategy != AGTYPE_CONTAINS_STRATEGY_NUMBER)
+        elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+    // see gin_consistent_agtype_path(), the result is never better than maybe
+    for (i = 0; i < nkeys; i++)
+    {
+        if (check[i] == GIN_FALSE)
+            PG_RETURN_GIN_TERNARY_VALUE(GIN_FALSE);
+    }
+
+    PG_RETURN_GIN_TERNARY_VALUE(GIN_MAYBE);
+}
+
+/*
+ * Construct an agtype_ops_gin key from a flag byte and a textual
+ * representation, which need not be null-terminated. Long representations
+ * are hashed, see agtype.h.
+ */
+static Datum make_text_key(char flag, const char *str, int len)
+{
+    text *item;
+    char hashbuf[10];
+
+    if (len > AGT_GIN_MAX_LENGTH)
+    {
+        uint32 hashval;
+
+        hashval = DatumGetUInt32(hash_any((const unsigned char *)str, len));
+        snprintf(hashbuf, sizeof(hashbuf), "%08x", hashval);
+        str = hashbuf;
+        len = 8;
+        flag |= AGT_GIN_FLAG_HASHED;
+    }
+
+    /*
+     * Now build the text Datum. For simplicity we build a 4-byte-header
+     * varlena text Datum here, but we expect it will get converted to short
+     * header format when stored in the index.
+     */
+    item = (text *)palloc(VARHDRSZ + len + 1);
+    SET_VARSIZE(item, VARHDRSZ + len + 1);
+
+    *VARDATA(item) = flag;
+
+    memcpy(VARDATA(item) + 1, str, len);
+
+    return PointerGetDatum(item);
+}
+
+/*
+ * Create a textual representation of a scalar agtype_value that will serve
+ * as a GIN key in an agtype_ops_gin index. is_key is true if the value is
+ * a key, or a string array element that is indexed as a key.
+ */
+static Datum make_scalar_key(const agtype_value *scalar_val, bool is_key)
+{
+    Datum item;
+    char *cstr;
+
+    switch (scalar_val->type)
+    {
+    case AGTV_NULL:
+        Assert(!is_key);
+        item = make_text_key(AGT_GIN_FLAG_NULL, "", 0);
+        break;
+    case AGTV_BOOL:
+        Assert(!is_key);
+        item = make_text_key(AGT_GIN_FLAG_BOOL,
+                             scalar_val->val.boolean ? "t" : "f", 1);
+        break;
+    case AGTV_INTEGER:
+        Assert(!is_key);
+        cstr = psprintf(INT64_FORMAT, scalar_val->val.int_value);
+        item = make_text_key(AGT_GIN_FLAG_NUM, cstr, strlen(cstr));
+        pfree(cstr);
+        break;
+    case AGTV_FLOAT:
+    {
+        float8 f = scalar_val->val.float_value;
+
+        Assert(!is_key);
+        /*
+         * Numerically equal integers, floats, and numerics produce equal keys.
+         * An integral float is keyed like the integer, and -0 like 0. The
+         * others go through float8_numeric(), which rounds them to DBL_DIG
+         * digits like the hash opclass does, so the key does not depend on
+         * extra_float_digits. Collisions are removed by the recheck.
+         */
+        if (f == 0)
+            f = 0;
+
+        if (isinf(f))
+        {
+            cstr = pstrdup(f > 0 ? "Infinity" : "-Infinity");
+        }
+        else if (f == floor(f) && f >= -9223372036854775808.0 &&
+                 f < 9223372036854775808.0)
+        {
+            cstr = psprintf(INT64_FORMAT, (int64)f);
+        }
+        else
+        {
+            Datum num = DirectFunctionCall1(float8_numeric,
+                                            Float8GetDatum(f));
+
+            cstr = numeric_normalize(DatumGetNumeric(num));
+        }
+        item = make_text_key(AGT_GIN_FLAG_NUM, cstr, strlen(cstr));
+        pfree(cstr);
+        break;
+    }
+    case AGTV_NUMERIC:
+        Assert(!is_key);
+        /*
+         * A normalized textual representation, free of trailing zeroes, is
+         * required so that numerically equal values will produce equal
+         * strings.
+         */
+        cstr = numeric_normalize(scalar_val->val.numeric);
+        item = make_text_key(AGT_GIN_FLAG_NUM, cstr, strlen(cstr));
+        pfree(cstr);
+        break;
+    case AGTV_STRING:
+        item = make_text_key(is_key ? AGT_GIN_FLAG_KEY : AGT_GIN_FLAG_STR,
+                             scalar_val->val.string.val,
+                             scalar_val->val.string.len);
+        break;
+    case AGTV_VERTEX:
+    case AGTV_EDGE:
+    case AGTV_PATH:
+    {
+        uint32 hash = 0;
+        char hashbuf[10];
+
+        // graph entities are compared by their ids, use their hash
+        Assert(!is_key);
+        agtype_hash_scalar_value(scalar_val, &hash);
+        snprintf(hashbuf, sizeof(hashbuf), "%08x", hash);
+        item = make_text_key(AGT_GIN_FLAG_STR | AGT_GIN_FLAG_HASHED, hashbuf,
+                             8);
+        break;
+    }
+    default:
+        elog(ERROR, "unrecognized agtype scalar type: %d", scalar_val->type);
+        item = 0; // keep compiler quiet
+        break;
+    }
+
+    return item;
+}
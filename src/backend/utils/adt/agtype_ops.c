@@ -1162,3 +1162,45 @@ static void ereport_op_str(const char *op, agtype *lhs, agtype *rhs)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                     errmsg(msgfmt, lstr, op, rstr)));
 }
+
+PG_FUNCTION_INFO_V1(agtype_contains);
+
+/*
+ * agtype @> agtype, returns true if the right hand side is contained in the
+ * left hand side.
+ */
+Datum agtype_contains(PG_FUNCTION_ARGS)
+{
+    agtype *agtype_lhs = AG_GET_ARG_AGTYPE_P(0);
+    agtype *agtype_rhs = AG_GET_ARG_AGTYPE_P(1);
+    agtype_iterator *lhs_it, *rhs_it;
+
+    if (AGT_ROOT_IS_OBJECT(agtype_lhs) != AGT_ROOT_IS_OBJECT(agtype_rhs))
+        PG_RETURN_BOOL(false);
+
+    lhs_it = agtype_iterator_init(&agtype_lhs->root);
+    rhs_it = agtype_iterator_init(&agtype_rhs->root);
+
+    PG_RETURN_BOOL(agtype_deep_contains(&lhs_it, &rhs_it));
+}
+
+PG_FUNCTION_INFO_V1(agtype_contained_by);
+
+/*
+ * agtype <@ agtype, returns true if the left hand side is contained in the
+ * right hand side.
+ */
+Datum agtype_contained_by(PG_FUNCTION_ARGS)
+{
+    agtype *agtype_lhs = AG_GET_ARG_AGTYPE_P(0);
+    agtype *agtype_rhs = AG_GET_ARG_AGTYPE_P(1);
+    agtype_iterator *lhs_it, *rhs_it;
+
+    if (AGT_ROOT_IS_OBJECT(agtype_lhs) != AGT_ROOT_IS_OBJECT(agtype_rhs))
+        PG_RETURN_BOOL(false);
+
+    lhs_it = agtype_iterator_init(&agtype_lhs->root);
+    rhs_it = agtype_iterator_init(&agtype_rhs->root);
+
+    PG_RETURN_BOOL(agtype_deep_contains(&rhs_it, &lhs_it));
+}
@@ -25,6 +25,7 @@
 
 #include "postgres.h"
 
+#include <float.h>
 #include <math.h>
 
 #include "access/hash.h"
@@ -67,6 +68,11 @@ static void convert_agtype_scalar(StringInfo buffer, agtentry *entry,
 static void append_to_buffer(StringInfo buffer, const char *data, int len);
 static void copy_to_buffer(StringInfo buffer, int offset, const char *data,
                            int len);
+static void append_object_agtentry(StringInfo buffer, int *agtentry_offset,
+                                   agtentry meta, int index, int *totallen);
+static void copy_agtype_entry_data(StringInfo buffer, agtentry *meta,
+                                   agtype_container *container, int index,
+                                   char *base_addr, uint32 offset);
 
 static agtype_iterator *iterator_from_container(agtype_container *container,
                                                 agtype_iterator *parent);
@@ -83,6 +89,10 @@ static agtype_value *push_agtype_value_scalar(agtype_parse_state **pstate,
                                               agtype_iterator_token seq,
                                               agtype_value *scalar_val);
 static int compare_two_floats_orderability(float8 lhs, float8 rhs);
+static float8 float8_for_hash(float8 f);
+static bool float8_is_int64(float8 f);
+static uint64 hash_float8_value(float8 f, uint64 seed);
+static uint64 hash_numeric_value(Numeric n, uint64 seed);
 static int get_type_sort_priority(enum agtype_value_type type);
 
 /*
@@ -521,6 +531,240 @@ agtype_value *get_ith_agtype_value_from_container(agtype_container *container,
     return result;
 }
 
+/*
+ * Return a copy of an agtype object with the value of one key set, or with
+ * the key removed if new_value is NULL.
+ *
+ * This works on the binary representation: the other keys and values are
+ * copied as they are, only their agtentrys are recomputed (keeping every
+ * AGT_OFFSET_STRIDE'th one an offset) and the int-aligned values re-padded
+ * for their new position. The object is never expanded into an agtype_value,
+ * which is what makes updating one property of a large properties map cheap.
+ *
+ * new_value is either a scalar, taken from its raw scalar array, or a
+ * container. The result is palloc'd.
+ */
+agtype *agtype_set_object_key(agtype_container *object, char *key,
+                              int key_len, agtype *new_value)
+{
+    StringInfoData buffer;
+    agtentry *children = object->children;
+    int count = AGTYPE_CONTAINER_SIZE(object);
+    char *base_addr = (char *)(children + count * 2);
+    agtype_value key_value;
+    uint32 stop_low = 0;
+    uint32 stop_high = count;
+    bool found = false;
+    int key_index;
+    int new_count;
+    uint32 header;
+    int agtentry_offset;
+    int totallen;
+    uint32 offset;
+    int index;
+    int i;
+    agtype *res;
+
+    Assert(AGTYPE_CONTAINER_IS_OBJECT(object));
+
+    key_value.type = AGTV_STRING;
+    key_value.val.string.val = key;
+    key_value.val.string.len = key_len;
+
+    /* find the key, or the position it sorts at if it is not there */
+    while (stop_low < stop_high)
+    {
+        uint32 stop_middle;
+        int difference;
+        agtype_value candidate;
+
+        stop_middle = stop_low + (stop_high - stop_low) / 2;
+
+        candidate.type = AGTV_STRING;
+        candidate.val.string.val = base_addr +
+                                   get_agtype_offset(object, stop_middle);
+        candidate.val.string.len = get_agtype_length(object, stop_middle);
+
+        difference = length_compare_agtype_string_value(&candidate,
+                                                        &key_value);
+        if (difference == 0)
+        {
+            stop_low = stop_middle;
+            found = true;
+            break;
+        }
+        else if (difference < 0)
+        {
+            stop_low = stop_middle + 1;
+        }
+        else
+        {
+            stop_high = stop_middle;
+        }
+    }
+    key_index = stop_low;
+
+    new_count = count;
+    if (found && new_value == NULL)
+        new_count--;
+    else if (!found && new_value != NULL)
+        new_count++;
+
+    initStringInfo(&buffer);
+
+    /* Make room for the varlena header */
+    reserve_from_buffer(&buffer, VARHDRSZ);
+
+    header = new_count | AGT_FOBJECT;
+    append_to_buffer(&buffer, (char *)&header, sizeof(uint32));
+
+    agtentry_offset = reserve_from_buffer(&buffer,
+                                          sizeof(agtentry) * new_count * 2);
+
+    /* the keys, then the values, in the same order as convert_agtype_object */
+    totallen = 0;
+    offset = 0;
+    index = 0;
+    for (i = 0; i <= count; i++)
+    {
+        agtentry meta;
+
+        if (i == key_index && new_value != NULL)
+        {
+            append_to_buffer(&buffer, key, key_len);
+            meta = key_len;
+            append_object_agtentry(&buffer, &agtentry_offset, meta, index++,
+                                   &totallen);
+        }
+
+        if (i == count)
+            break;
+
+        if (!found || i != key_index)
+        {
+            copy_agtype_entry_data(&buffer, &meta, object, i, base_addr,
+                                   offset);
+            append_object_agtentry(&buffer, &agtentry_offset, meta, index++,
+                                   &totallen);
+        }
+
+        AGTE_ADVANCE_OFFSET(offset, children[i]);
+    }
+    for (i = 0; i <= count; i++)
+    {
+        agtentry meta;
+
+        if (i == key_index && new_value != NULL)
+        {
+            /* the data of a raw scalar starts right after its agtentry */
+            if (AGT_ROOT_IS_SCALAR(new_value))
+            {
+                copy_agtype_entry_data(&buffer, &meta, &new_value->root, 0,
+                                       (char *)&new_value->root.children[1],
+                                       0);
+            }
+            else
+            {
+                int len = VARSIZE(new_value) - VARHDRSZ;
+                short padlen = pad_buffer_to_int(&buffer);
+
+                append_to_buffer(&buffer, (char *)&new_value->root, len);
+                meta = AGTENTRY_IS_CONTAINER | (padlen + len);
+            }
+            append_object_agtentry(&buffer, &agtentry_offset, meta, index++,
+                                   &totallen);
+        }
+
+        if (i == count)
+            break;
+
+        if (!found || i != key_index)
+        {
+            copy_agtype_entry_data(&buffer, &meta, object, count + i,
+                                   base_addr, offset);
+            append_object_agtentry(&buffer, &agtentry_offset, meta, index++,
+                                   &totallen);
+        }
+
+        AGTE_ADVANCE_OFFSET(offset, children[count + i]);
+    }
+
+    Assert(index == new_count * 2);
+
+    res = (agtype *)buffer.data;
+
+    SET_VARSIZE(res, buffer.len);
+
+    return res;
+}
+
+/*
+ * Store the agtentry of the index'th child of the object being built by
+ * agtype_set_object_key(), whose data was just appended to buffer.
+ */
+static void append_object_agtentry(StringInfo buffer, int *agtentry_offset,
+                                   agtentry meta, int index, int *totallen)
+{
+    *totallen += AGTE_OFFLENFLD(meta);
+
+    if (*totallen > AGTENTRY_OFFLENMASK)
+    {
+        ereport(
+            ERROR,
+            (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+             errmsg(
+                 "total size of agtype object elements exceeds the maximum of %u bytes",
+                 AGTENTRY_OFFLENMASK)));
+    }
+
+    /*
+     * Convert each AGT_OFFSET_STRIDE'th length to an offset.
+     */
+    if ((index % AGT_OFFSET_STRIDE) == 0)
+        meta = (meta & AGTENTRY_TYPEMASK) | *totallen | AGTENTRY_HAS_OFF;
+
+    copy_to_buffer(buffer, *agtentry_offset, (char *)&meta, sizeof(agtentry));
+    *agtentry_offset += sizeof(agtentry);
+}
+
+/*
+ * Append the variable-length data of the index'th child of container, which
+ * starts at base_addr + offset, to buffer. Its new agtentry, holding the
+ * length of the data, is returned in *meta.
+ *
+ * Numerics, containers and our extended types are int-aligned, and the
+ * padding in front of them is counted in their length. The old padding is
+ * dropped and the data re-padded for its position in buffer.
+ */
+static void copy_agtype_entry_data(StringInfo buffer, agtentry *meta,
+                                   agtype_container *container, int index,
+                                   char *base_addr, uint32 offset)
+{
+    agtentry entry = container->children[index];
+    uint32 len;
+
+    if (AGTE_HAS_OFF(entry))
+        len = AGTE_OFFLENFLD(entry) - offset;
+    else
+        len = AGTE_OFFLENFLD(entry);
+
+    if (AGTE_IS_NUMERIC(entry) || AGTE_IS_CONTAINER(entry) ||
+        AGTE_IS_AGTYPE(entry))
+    {
+        uint32 old_padlen = INTALIGN(offset) - offset;
+        short padlen = pad_buffer_to_int(buffer);
+
+        append_to_buffer(buffer, base_addr + offset + old_padlen,
+                         len - old_padlen);
+        *meta = (entry & AGTENTRY_TYPEMASK) | (padlen + len - old_padlen);
+    }
+    else
+    {
+        append_to_buffer(buffer, base_addr + offset, len);
+        *meta = (entry & AGTENTRY_TYPEMASK) | len;
+    }
+}
+
 /*
  * A helper function to fill in an agtype_value to represent an element of an
  * array, or a key or value of an object.
@@ -1364,6 +1608,24 @@ void agtype_hash_scalar_value(const agtype_value *scalar_val, uint32 *hash)
         tmp = DatumGetUInt32(DirectFunctionCall1(
             hashfloat8, Float8GetDatum(scalar_val->val.float_value)));
         break;
+    case AGTV_VERTEX:
+    case AGTV_EDGE:
+    {
+        agtype_value *id_agt = get_agtype_value_object_value(scalar_val, "id");
+
+        tmp = DatumGetUInt32(DirectFunctionCall1(
+            hashint8, Int64GetDatum(id_agt->val.int_value)));
+        break;
+    }
+    case AGTV_PATH:
+    {
+        int i;
+
+        tmp = 0;
+        for (i = 0; i < scalar_val->val.array.num_elems; i++)
+            agtype_hash_scalar_value(&scalar_val->val.array.elems[i], &tmp);
+        break;
+    }
     default:
         ereport(ERROR, (errmsg("invalid agtype scalar type %d to compute hash",
                                scalar_val->type)));
@@ -1399,10 +1661,13 @@ void agtype_hash_scalar_value_extended(const agtype_value *scalar_val,
             (const unsigned char *)scalar_val->val.string.val,
             scalar_val->val.string.len, seed));
         break;
+    /*
+     * Equal integers, floats, and numerics must hash to the same value.
+     * Integers are hashed exactly, and so are the floats and numerics with an
+     * integral value, see hash_float8_value().
+     */
     case AGTV_NUMERIC:
-        tmp = DatumGetUInt64(DirectFunctionCall2(
-            hash_numeric_extended, NumericGetDatum(scalar_val->val.numeric),
-            UInt64GetDatum(seed)));
+        tmp = hash_numeric_value(scalar_val->val.numeric, seed);
         break;
     case AGTV_BOOL:
         if (seed)
@@ -1422,9 +1687,7 @@ void agtype_hash_scalar_value_extended(const agtype_value *scalar_val,
             UInt64GetDatum(seed)));
         break;
     case AGTV_FLOAT:
-        tmp = DatumGetUInt64(DirectFunctionCall2(
-            hashfloat8extended, Float8GetDatum(scalar_val->val.float_value),
-            UInt64GetDatum(seed)));
+        tmp = hash_float8_value(scalar_val->val.float_value, seed);
         break;
     case AGTV_VERTEX:
     {
@@ -1467,6 +1730,76 @@ void agtype_hash_scalar_value_extended(const agtype_value *scalar_val,
     *hash ^= tmp;
 }
 
+/*
+ * A float and a numeric are compared as numerics, and float8_numeric() keeps
+ * only DBL_DIG significant digits of the float. Round the floats that are
+ * hashed the same way, so that every value equal to a numeric gets its hash.
+ */
+static float8 float8_for_hash(float8 f)
+{
+    char buf[DBL_DIG + 100];
+
+    if (isnan(f) || isinf(f))
+        return f;
+
+    snprintf(buf, sizeof(buf), "%.*g", DBL_DIG, f);
+
+    return strtod(buf, NULL);
+}
+
+// whether the float has an integral value that fits in an int64
+static bool float8_is_int64(float8 f)
+{
+    return !isnan(f) && !isinf(f) && f == floor(f) &&
+           f >= -9223372036854775808.0 && f < 9223372036854775808.0;
+}
+
+/*
+ * A float with an integral value is hashed like the equal integer. The
+ * others are rounded by float8_for_hash() first, so that they get the hash of
+ * the numerics they are equal to. An integral float beyond DBL_DIG digits can
+ * be equal to an integer and to a different numeric, it gets the hash of the
+ * integer.
+ */
+static uint64 hash_float8_value(float8 f, uint64 seed)
+{
+    if (!float8_is_int64(f))
+        f = float8_for_hash(f);
+
+    if (float8_is_int64(f))
+    {
+        return DatumGetUInt64(DirectFunctionCall2(hashint8extended,
+                                                  Int64GetDatum((int64)f),
+                                                  UInt64GetDatum(seed)));
+    }
+
+    return DatumGetUInt64(DirectFunctionCall2(hashfloat8extended,
+                                              Float8GetDatum(f),
+                                              UInt64GetDatum(seed)));
+}
+
+// a numeric with an integral value is hashed like the equal integer
+static uint64 hash_numeric_value(Numeric n, uint64 seed)
+{
+    Datum num = NumericGetDatum(n);
+    float8 f;
+
+    f = DatumGetFloat8(DirectFunctionCall1(numeric_float8_no_overflow, num));
+
+    if (float8_is_int64(f) &&
+        DatumGetBool(DirectFunctionCall2(
+            numeric_eq, num,
+            DirectFunctionCall2(numeric_trunc, num, Int32GetDatum(0)))))
+    {
+        Datum i = DirectFunctionCall1(numeric_int8, num);
+
+        return DatumGetUInt64(DirectFunctionCall2(hashint8extended, i,
+                                                  UInt64GetDatum(seed)));
+    }
+
+    return hash_float8_value(f, seed);
+}
+
 /*
  * Function to compare two floats, obviously. However, there are a few
  * special cases that we need to cover with regards to NaN and +/-Infinity.
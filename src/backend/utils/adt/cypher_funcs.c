@@ -55,3 +55,20 @@ Datum _cypher_delete_clause(PG_FUNCTION_ARGS)
 {
     PG_RETURN_NULL();
 }
+
+PG_FUNCTION_INFO_V1(_cypher_merge_clause);
+
+Datum _cypher_merge_clause(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_NULL();
+}
+
+PG_FUNCTION_INFO_V1(_cypher_vle);
+
+// the paths are found by the Cypher VLE node that replaces the function
+Datum _cypher_vle(PG_FUNCTION_ARGS)
+{
+    ereport(ERROR, (errmsg_internal("unhandled _cypher_vle() function call")));
+
+    PG_RETURN_NULL();
+}
@@ -26,6 +26,7 @@
 #include "utils/graphid.h"
 
 static int graphid_btree_fast_cmp(Datum x, Datum y, SortSupport ssup);
+static uint64 graphid_hash_uint64(uint64 key, uint64 seed);
 
 PG_FUNCTION_INFO_V1(graphid_in);
 
@@ -161,6 +162,44 @@ static int graphid_btree_fast_cmp(Datum x, Datum y, SortSupport ssup)
         return -1;
 }
 
+PG_FUNCTION_INFO_V1(graphid_hash);
+
+Datum graphid_hash(PG_FUNCTION_ARGS)
+{
+    graphid gid = AG_GETARG_GRAPHID(0);
+
+    PG_RETURN_INT32((int32)graphid_hash_uint64((uint64)gid, 0));
+}
+
+PG_FUNCTION_INFO_V1(graphid_hash_extended);
+
+Datum graphid_hash_extended(PG_FUNCTION_ARGS)
+{
+    graphid gid = AG_GETARG_GRAPHID(0);
+    uint64 seed = (uint64)PG_GETARG_INT64(1);
+
+    PG_RETURN_INT64((int64)graphid_hash_uint64((uint64)gid, seed));
+}
+
+/*
+ * The label id is stored in the high bits of a graphid and the entry id in
+ * the low bits, so all the bits of the key are mixed together (this is the
+ * finalizer of MurmurHash3). The low 32 bits of the result with seed 0 are
+ * used as the standard hash value, as hash opclasses require.
+ */
+static uint64 graphid_hash_uint64(uint64 key, uint64 seed)
+{
+    uint64 h = key ^ (seed * UINT64CONST(0x9e3779b97f4a7c15));
+
+    h ^= h >> 33;
+    h *= UINT64CONST(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64CONST(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return h;
+}
+
 graphid make_graphid(const int32 label_id, const int64 entry_id)
 {
     uint64 tmp;
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "utils/guc.h"
+
+#include "utils/ag_guc.h"
+
+/*
+ * If true, every new edge label table gets a btree index on its start_id and
+ * end_id columns so that traversals and DETACH DELETE can look up the edges
+ * that are attached to a vertex without scanning the whole table.
+ */
+bool age_create_edge_indexes = true;
+
+/*
+ * Number of entry ids that a backend reserves at once from the sequence of a
+ * label. This is the CACHE value of the sequences of new labels.
+ */
+int age_entry_id_cache_size = 64;
+
+/*
+ * If true, the planner may join a relation to an edge label table with a
+ * Cypher Expand node, which looks up the edges of each vertex through the
+ * start_id and end_id indexes of the label.
+ */
+bool age_enable_expand = true;
+
+/*
+ * Registers the configuration parameters of AGE. All of them are prefixed with
+ * "age." and can be changed with SET.
+ */
+void define_config_params(void)
+{
+    DefineCustomBoolVariable("age.create_edge_indexes",
+                             "Creates start_id and end_id indexes on new edge labels.",
+                             NULL, &age_create_edge_indexes, true, PGC_USERSET,
+                             0, NULL, NULL, NULL);
+
+    DefineCustomIntVariable("age.entry_id_cache_size",
+                            "Sets the number of entry ids a session reserves at once for a new label.",
+                            NULL, &age_entry_id_cache_size, 64, 1, INT_MAX,
+                            PGC_USERSET, 0, NULL, NULL, NULL);
+
+    DefineCustomBoolVariable("age.enable_expand",
+                             "Enables the planner's use of Cypher Expand plans for MATCH patterns.",
+                             NULL, &age_enable_expand, true, PGC_USERSET,
+                             0, NULL, NULL, NULL);
+
+    EmitWarningsOnPlaceholders("age");
+}
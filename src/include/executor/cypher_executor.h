@@ -27,6 +27,9 @@
 #define DELETE_SCAN_STATE_NAME "Cypher Delete"
 #define SET_SCAN_STATE_NAME "Cypher Set"
 #define CREATE_SCAN_STATE_NAME "Cypher Create"
+#define MERGE_SCAN_STATE_NAME "Cypher Merge"
+#define EXPAND_SCAN_STATE_NAME "Cypher Expand"
+#define VLE_SCAN_STATE_NAME "Cypher VLE"
 
 Node *create_cypher_create_plan_state(CustomScan *cscan);
 extern const CustomExecMethods cypher_create_exec_methods;
@@ -37,4 +40,13 @@ extern const CustomExecMethods cypher_set_exec_methods;
 Node *create_cypher_delete_plan_state(CustomScan *cscan);
 extern const CustomExecMethods cypher_delete_exec_methods;
 
+Node *create_cypher_merge_plan_state(CustomScan *cscan);
+extern const CustomExecMethods cypher_merge_exec_methods;
+
+Node *create_cypher_expand_plan_state(CustomScan *cscan);
+extern const CustomExecMethods cypher_expand_exec_methods;
+
+Node *create_cypher_vle_plan_state(CustomScan *cscan);
+extern const CustomExecMethods cypher_vle_exec_methods;
+
 #endif
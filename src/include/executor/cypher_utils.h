@@ -20,13 +20,18 @@
 #ifndef AG_CYPHER_UTILS_H
 #define AG_CYPHER_UTILS_H
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "nodes/execnodes.h"
 #include "nodes/extensible.h"
 #include "nodes/nodes.h"
 #include "nodes/plannodes.h"
+#include "utils/hsearch.h"
+#include "utils/snapshot.h"
 
 #include "nodes/cypher_nodes.h"
 #include "utils/agtype.h"
+#include "utils/graphid.h"
 
 // declaration of a useful postgres macro that isn't in a header file
 #define DatumGetItemPointer(X)	 ((ItemPointer) DatumGetPointer(X))
@@ -57,6 +62,27 @@ typedef struct clause_tuple_information {
     HeapTuple tuple;
 } clause_tuple_information;
 
+/*
+ * The plan states that can hold the heap tuple of a variable, in the order
+ * they are checked, see resolve_entity_source().
+ */
+typedef struct entity_source
+{
+    char *var_name;
+    List *plan_states;
+} entity_source;
+
+/*
+ * A label table opened by a SET or DELETE clause, see
+ * get_entity_result_rel_info().
+ */
+typedef struct entity_result_rel_info_entry
+{
+    NameData label_name; // hash key
+    ResultRelInfo *resultRelInfo;
+    TupleTableSlot *slot;
+} entity_result_rel_info_entry;
+
 typedef struct cypher_create_custom_scan_state
 {
     CustomScanState css;
@@ -67,6 +93,13 @@ typedef struct cypher_create_custom_scan_state
     uint32 flags;
     TupleTableSlot *slot;
     Oid graph_oid;
+    // buffers of the tuples inserted in batches, see cypher_create.c
+    List *insert_buffers;
+    MemoryContext insert_buffer_mcxt;
+    int num_buffered_tuples;
+    Size buffered_bytes;
+    // entity_source of the bound vertices a previous clause can delete
+    List *vertex_sources;
 } cypher_create_custom_scan_state;
 
 typedef struct cypher_set_custom_scan_state
@@ -75,7 +108,12 @@ typedef struct cypher_set_custom_scan_state
     CustomScan *cs;
     cypher_update_information *set_list;
     List *tuple_info;
+    // holds the tuples in tuple_info, reset for every row
+    MemoryContext tuple_info_mcxt;
     int flags;
+    HTAB *result_rel_infos;
+    // entity_source of each item of set_list, resolved at startup
+    entity_source **item_sources;
 } cypher_set_custom_scan_state;
 
 typedef struct cypher_delete_custom_scan_state
@@ -85,18 +123,217 @@ typedef struct cypher_delete_custom_scan_state
     cypher_delete_information *delete_data;
     int flags;
     List *tuple_info;
+    // holds the entries of tuple_info, reset for every row
+    MemoryContext tuple_info_mcxt;
     List *edge_labels;
+    HTAB *deleted_vertices;
+    HTAB *result_rel_infos;
+    // the start_id and end_id indexes of the edge labels, by label name
+    HTAB *edge_label_indexes;
+    // entity_source of each item of delete_data, resolved at startup
+    entity_source **item_sources;
 } cypher_delete_custom_scan_state;
 
-PlanState *find_plan_state(CustomScanState *node, char *var_name, bool *is_deleted);
+/*
+ * An entity of the path of a MERGE clause, with the tables it is looked up
+ * in, see cypher_merge.c.
+ */
+typedef struct cypher_merge_element
+{
+    cypher_target_node *node;
+    // the vertex is bound by the previous clauses
+    bool bound;
+    // the first vertex of the path with the same variable, -1 if none
+    int alias;
+    // the tables of the label and of the labels inheriting it
+    int num_labels;
+    Relation *label_rels;
+    char **label_names;
+    /*
+     * The indexes the entities are looked up with, NULL for the tables
+     * without one: the primary keys for the vertices, the start_id and
+     * end_id indexes for the edges.
+     */
+    Relation *id_index_rels;
+    Relation *start_index_rels;
+    Relation *end_index_rels;
+    // the property indexes the first vertex can be looked up with
+    List *property_indexes;
+    // where a bound vertex comes from, if a previous clause can delete it
+    entity_source *source;
+} cypher_merge_element;
+
+typedef struct cypher_merge_custom_scan_state
+{
+    CustomScanState css;
+    CustomScan *cs;
+    uint32 flags;
+    Oid graph_oid;
+    AttrNumber merge_function_attr;
+    cypher_create_path *path;
+    int num_elements;
+    cypher_merge_element *elements;
+    // the elements in the order they are matched
+    int *order;
+    // the entities of the path being matched, by element
+    graphid *ids;
+    Datum *values;
+    HeapTuple *tuples;
+    bool *assigned;
+    // sees the entities other transactions are inserting or deleting
+    SnapshotData dirty_snapshot;
+    // the transaction to wait for before the path is matched again
+    TransactionId wait_xid;
+    // the paths of the current row, and the next one to return
+    List *matches;
+    ListCell *next_match;
+    // whether the path of the current row was created
+    bool created;
+    List *tuple_info;
+    // the matches of a row are kept in this context until the next row
+    MemoryContext row_mcxt;
+} cypher_merge_custom_scan_state;
+
+typedef struct cypher_expand_custom_scan_state
+{
+    CustomScanState css;
+    CustomScan *cs;
+    // the variable of the edge, see resolve_entity_source()
+    char *var_name;
+    // start_id to follow the outgoing edges, end_id for the incoming ones
+    AttrNumber key_attnum;
+    // the other end of the edge when it is bound, InvalidAttrNumber otherwise
+    AttrNumber into_attnum;
+    ExprState *key_expr;
+    ExprState *into_expr;
+    // the tables of the edge label and their key_attnum indexes
+    int num_labels;
+    Relation *label_rels;
+    Relation *index_rels;
+    IndexScanDesc *scan_descs;
+    // label being scanned for the outer tuple, -1 when one must be fetched
+    int current_label;
+    TupleTableSlot *outer_slot;
+    int outer_natts;
+    // the id of the outer tuple the edges are looked up with
+    ScanKeyData scan_key;
+    graphid into_id;
+    // the edge in the scan tuple, it is read by SET and DELETE
+    HeapTuple edge_tuple;
+} cypher_expand_custom_scan_state;
+
+// the edges of a label table are looked up with one of these by cypher_vle.c
+typedef struct cypher_vle_scan
+{
+    // index of the table in label_rels and label_names
+    int label;
+    // start_id for the outgoing edges, end_id for the incoming ones
+    AttrNumber attnum;
+    // the index on attnum, the table is scanned when there is none
+    Relation index_rel;
+    IndexScanDesc index_scan;
+    HeapScanDesc heap_scan;
+} cypher_vle_scan;
+
+/*
+ * An edge found by the traversal, with the vertex at its other end. For the
+ * bidirectional search, the other end is the vertex the edge was reached
+ * from.
+ */
+typedef struct cypher_vle_edge
+{
+    graphid id;
+    graphid next_vertex;
+    agtype *edge;
+} cypher_vle_edge;
+
+/*
+ * The edges of the vertex at the end of the current path. They live in the
+ * memory context of the level, which is reset when the level is loaded with
+ * the edges of another vertex.
+ */
+typedef struct cypher_vle_level
+{
+    MemoryContext mcxt;
+    cypher_vle_edge *edges;
+    int num_edges;
+    int max_edges;
+    // the edge after the one the current path goes through
+    int next;
+} cypher_vle_level;
+
+/*
+ * One side of the bidirectional search of shortestPath() and
+ * allShortestPaths(). The forward side starts at the start vertex and
+ * follows the direction of the relationship, the other one starts at the end
+ * vertex and goes against it.
+ */
+typedef struct cypher_vle_frontier
+{
+    bool forward;
+    // the vertices the side reached, with the edges they were reached by
+    HTAB *visited;
+    // the vertices reached by the last expansion of the side
+    graphid *vertices;
+    int num_vertices;
+    int depth;
+} cypher_vle_frontier;
+
+typedef struct cypher_vle_custom_scan_state
+{
+    CustomScanState css;
+    CustomScan *cs;
+    ExprState *start_expr;
+    ExprState *end_expr;
+    ExprState *props_expr;
+    cypher_path_kind path_kind;
+    cypher_rel_dir dir;
+    int min_hops;
+    // -1 when the paths are not bounded
+    int max_hops;
+    // the tables of the edge label
+    int num_labels;
+    Relation *label_rels;
+    char **label_names;
+    int num_scans;
+    cypher_vle_scan *scans;
+    // the traversal from the current start vertex, see cypher_vle.c
+    bool started;
+    graphid start_id;
+    // the vertex the shortest paths end at
+    graphid end_id;
+    // the property constraints of the edges, kept in start_mcxt
+    agtype *props;
+    MemoryContext start_mcxt;
+    int depth;
+    int num_levels;
+    cypher_vle_level *levels;
+    // the ids of the edges in the current path
+    HTAB *path_edges;
+    // the paths found by the bidirectional search, kept in start_mcxt
+    List *shortest_paths;
+    ListCell *next_shortest_path;
+} cypher_vle_custom_scan_state;
+
 
-TupleTableSlot *populate_vertex_tts(TupleTableSlot *elemTupleSlot, agtype_value *id, agtype_value *properties);
+TupleTableSlot *populate_vertex_tts(TupleTableSlot *elemTupleSlot, agtype_value *id, agtype *properties);
 TupleTableSlot *populate_edge_tts(
     TupleTableSlot *elemTupleSlot, agtype_value *id, agtype_value *startid,
-    agtype_value *endid, agtype_value *properties);
+    agtype_value *endid, agtype *properties);
 
 ResultRelInfo *create_entity_result_rel_info(EState *estate, char *graph_name, char *label_name);
+entity_result_rel_info_entry *get_entity_result_rel_info(HTAB **result_rel_infos,
+                                                         EState *estate,
+                                                         char *graph_name,
+                                                         char *label_name);
+void close_entity_result_rel_infos(HTAB *result_rel_infos);
 List *add_tuple_info(List *list, HeapTuple heap_tuple, char *var_name);
+Oid find_index_on_column(Relation rel, AttrNumber attnum);
+bool entity_has_properties(agtype *properties, agtype *constraints);
+bool entity_exists(EState *estate, Oid graph_oid, graphid id);
+HeapTuple insert_entity_tuple(ResultRelInfo *resultRelInfo,
+                              TupleTableSlot *elemTupleSlot, EState *estate);
 ItemPointer get_self_item_pointer(TupleTableSlot *tts);
-HeapTuple get_heap_tuple(CustomScanState *node, char *var_name, bool *is_deleted);
+entity_source *resolve_entity_source(CustomScanState *node, char *var_name);
+HeapTuple get_entity_heap_tuple(entity_source *source, bool *is_deleted);
 #endif
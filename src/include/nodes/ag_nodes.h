@@ -35,11 +35,15 @@ typedef enum ag_node_tag
     cypher_with_t,
     // reading clause
     cypher_match_t,
+    cypher_unwind_t,
     // updating clause
     cypher_create_t,
     cypher_set_t,
     cypher_set_item_t,
     cypher_delete_t,
+    cypher_merge_t,
+    // index clause
+    cypher_create_index_t,
     // pattern
     cypher_path_t,
     cypher_node_t,
@@ -66,7 +70,9 @@ typedef enum ag_node_tag
     cypher_update_item_t,
     // delete data structures
     cypher_delete_information_t,
-    cypher_delete_item_t
+    cypher_delete_item_t,
+    // merge data structures
+    cypher_merge_information_t
 } ag_node_tag;
 
 void register_ag_nodes(void);
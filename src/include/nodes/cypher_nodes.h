@@ -75,17 +75,31 @@ typedef struct cypher_match
     Node *where; // optional WHERE subclause (expression)
 } cypher_match;
 
+typedef struct cypher_unwind
+{
+    ExtensibleNode extensible;
+    ResTarget *target; // the list and the variable of its elements
+} cypher_unwind;
+
 typedef struct cypher_create
 {
     ExtensibleNode extensible;
     List *pattern; // a list of cypher_paths
 } cypher_create;
 
+typedef enum cypher_merge_action
+{
+    CYPHER_MERGE_ACTION_NONE,
+    CYPHER_MERGE_ACTION_ON_CREATE, // ON CREATE SET
+    CYPHER_MERGE_ACTION_ON_MATCH // ON MATCH SET
+} cypher_merge_action;
+
 typedef struct cypher_set
 {
     ExtensibleNode extensible;
     List *items; // a list of cypher_set_items
     bool is_remove; // true if this is REMOVE clause
+    cypher_merge_action merge_action; // set if this is an action of MERGE
     int location;
 } cypher_set;
 
@@ -98,6 +112,14 @@ typedef struct cypher_set_item
     int location;
 } cypher_set_item;
 
+typedef struct cypher_merge
+{
+    ExtensibleNode extensible;
+    Node *path; // a cypher_path
+    List *actions; // the ON CREATE SET and ON MATCH SET cypher_sets
+    int location;
+} cypher_merge;
+
 typedef struct cypher_delete
 {
     ExtensibleNode extensible;
@@ -106,15 +128,32 @@ typedef struct cypher_delete
     int location;
 } cypher_delete;
 
+typedef struct cypher_create_index
+{
+    ExtensibleNode extensible;
+    char *name; // optional name of the index
+    char *label; // label whose table is indexed
+    char *property; // property key that is indexed
+    int location;
+} cypher_create_index;
+
 /*
  * pattern
  */
 
+typedef enum cypher_path_kind
+{
+    CYPHER_PATH_DEFAULT,
+    CYPHER_PATH_SHORTEST, // shortestPath()
+    CYPHER_PATH_ALL_SHORTEST // allShortestPaths()
+} cypher_path_kind;
+
 typedef struct cypher_path
 {
     ExtensibleNode extensible;
     List *path; // [ node ( , relationship , node , ... ) ]
     char *var_name;
+    cypher_path_kind kind;
     int location;
 } cypher_path;
 
@@ -217,9 +256,25 @@ typedef struct cypher_create_path
     AttrNumber path_attr_num;
 } cypher_create_path;
 
+/*
+ * The path of a MERGE clause, transformed like the one of a CREATE clause.
+ * The clause sets its function column to whether it created the path of the
+ * row, for its ON CREATE SET and ON MATCH SET actions.
+ */
+typedef struct cypher_merge_information
+{
+    ExtensibleNode extensible;
+    uint32 flags;
+    Oid graph_oid;
+    AttrNumber merge_function_attr;
+    cypher_create_path *path;
+} cypher_merge_information;
+
 #define CYPHER_CLAUSE_FLAG_NONE 0x0000
 #define CYPHER_CLAUSE_FLAG_TERMINAL 0x0001
 #define CYPHER_CLAUSE_FLAG_PREVIOUS_CLAUSE 0x0002
+// one of the previous clauses is a DELETE clause
+#define CYPHER_CLAUSE_FLAG_PREVIOUS_DELETE 0x0004
 
 #define CYPHER_CLAUSE_IS_TERMINAL(flags) \
     (flags & CYPHER_CLAUSE_FLAG_TERMINAL)
@@ -227,6 +282,9 @@ typedef struct cypher_create_path
 #define CYPHER_CLAUSE_HAS_PREVIOUS_CLAUSE(flags) \
     (flags & CYPHER_CLAUSE_FLAG_PREVIOUS_CLAUSE)
 
+#define CYPHER_CLAUSE_HAS_PREVIOUS_DELETE(flags) \
+    (flags & CYPHER_CLAUSE_FLAG_PREVIOUS_DELETE)
+
 /*
  * Structure that contains all information to create
  * a new entity in the create clause, or where to access
@@ -325,6 +383,15 @@ typedef struct cypher_update_information
     AttrNumber tuple_position;
     char *graph_name;
     char *clause_name;
+    List *path_positions; // the columns that can hold paths
+    /*
+     * The function column of the MERGE clause, when this is one of its
+     * actions, InvalidAttrNumber otherwise. The rows are updated when the
+     * column tells MERGE created their path and on_create is true, or it
+     * tells MERGE matched the path and on_create is false.
+     */
+    AttrNumber merge_position;
+    bool on_create;
 } cypher_update_information;
 
 typedef struct cypher_update_item
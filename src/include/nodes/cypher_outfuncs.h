@@ -35,10 +35,13 @@
 void out_cypher_return(StringInfo str, const ExtensibleNode *node);
 void out_cypher_with(StringInfo str, const ExtensibleNode *node);
 void out_cypher_match(StringInfo str, const ExtensibleNode *node);
+void out_cypher_unwind(StringInfo str, const ExtensibleNode *node);
 void out_cypher_create(StringInfo str, const ExtensibleNode *node);
 void out_cypher_set(StringInfo str, const ExtensibleNode *node);
 void out_cypher_set_item(StringInfo str, const ExtensibleNode *node);
 void out_cypher_delete(StringInfo str, const ExtensibleNode *node);
+void out_cypher_merge(StringInfo str, const ExtensibleNode *node);
+void out_cypher_create_index(StringInfo str, const ExtensibleNode *node);
 
 // pattern
 void out_cypher_path(StringInfo str, const ExtensibleNode *node);
@@ -76,4 +79,7 @@ void out_cypher_update_item(StringInfo str, const ExtensibleNode *node);
 void out_cypher_delete_information(StringInfo str, const ExtensibleNode *node);
 void out_cypher_delete_item(StringInfo str, const ExtensibleNode *node);
 
+// merge private data structures
+void out_cypher_merge_information(StringInfo str, const ExtensibleNode *node);
+
 #endif
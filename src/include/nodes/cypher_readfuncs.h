@@ -52,4 +52,7 @@ void read_cypher_update_item(struct ExtensibleNode *node);
 void read_cypher_delete_information(struct ExtensibleNode *node);
 void read_cypher_delete_item(struct ExtensibleNode *node);
 
+// merge data structures
+void read_cypher_merge_information(struct ExtensibleNode *node);
+
 #endif
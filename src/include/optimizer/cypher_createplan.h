@@ -36,4 +36,16 @@ Plan *plan_cypher_delete_path(PlannerInfo *root, RelOptInfo *rel,
                            CustomPath *best_path, List *tlist,
                            List *clauses, List *custom_plans);
 
+Plan *plan_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
+                             CustomPath *best_path, List *tlist,
+                             List *clauses, List *custom_plans);
+
+Plan *plan_cypher_expand_path(PlannerInfo *root, RelOptInfo *rel,
+                              CustomPath *best_path, List *tlist,
+                              List *clauses, List *custom_plans);
+
+Plan *plan_cypher_vle_path(PlannerInfo *root, RelOptInfo *rel,
+                           CustomPath *best_path, List *tlist,
+                           List *clauses, List *custom_plans);
+
 #endif
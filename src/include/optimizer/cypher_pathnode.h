@@ -26,6 +26,9 @@
 #define CREATE_PATH_NAME "Cypher Create"
 #define SET_PATH_NAME "Cypher Set"
 #define DELETE_PATH_NAME "Cypher Delete"
+#define MERGE_PATH_NAME "Cypher Merge"
+#define EXPAND_PATH_NAME "Cypher Expand"
+#define VLE_PATH_NAME "Cypher VLE"
 
 CustomPath *create_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
                                       List *custom_private);
@@ -33,5 +36,14 @@ CustomPath *create_cypher_set_path(PlannerInfo *root, RelOptInfo *rel,
                                    List *custom_private);
 CustomPath *create_cypher_delete_path(PlannerInfo *root, RelOptInfo *rel,
                                    List *custom_private);
+CustomPath *create_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
+                                     List *custom_private);
+CustomPath *create_cypher_expand_path(PlannerInfo *root, RelOptInfo *joinrel,
+                                      Path *outer_path, List *pathkeys,
+                                      Cost startup_cost, Cost total_cost,
+                                      List *custom_private);
+CustomPath *create_cypher_vle_path(PlannerInfo *root, RelOptInfo *rel,
+                                   Relids required_outer,
+                                   List *custom_private);
 
 #endif
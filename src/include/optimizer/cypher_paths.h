@@ -23,4 +23,7 @@
 void set_rel_pathlist_init(void);
 void set_rel_pathlist_fini(void);
 
+void set_join_pathlist_init(void);
+void set_join_pathlist_fini(void);
+
 #endif
@@ -25,6 +25,21 @@
 #define CREATE_CLAUSE_FUNCTION_NAME "_cypher_create_clause"
 #define SET_CLAUSE_FUNCTION_NAME "_cypher_set_clause"
 #define DELETE_CLAUSE_FUNCTION_NAME "_cypher_delete_clause"
+#define MERGE_CLAUSE_FUNCTION_NAME "_cypher_merge_clause"
+#define CREATE_INDEX_CLAUSE_FUNCTION_NAME "_create_property_index"
+#define VLE_FUNCTION_NAME "_cypher_vle"
+
+// the arguments of the VLE function, see transform_cypher_vle_edge()
+#define VLE_ARG_VERTEX_ID 0
+#define VLE_ARG_END_VERTEX_ID 1
+#define VLE_ARG_GRAPH_OID 2
+#define VLE_ARG_LABEL_NAME 3
+#define VLE_ARG_DIRECTION 4
+#define VLE_ARG_MIN_HOPS 5
+#define VLE_ARG_MAX_HOPS 6
+#define VLE_ARG_PROPERTIES 7
+#define VLE_ARG_PATH_KIND 8
+#define VLE_NUM_ARGS 9
 
 bool is_oid_ag_func(Oid func_oid, const char *func_name);
 Oid get_ag_func_oid(const char *func_name, const int nargs, ...);
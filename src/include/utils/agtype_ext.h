@@ -23,6 +23,7 @@
 #include "postgres.h"
 
 #include "utils/agtype.h"
+#include "utils/graphid.h"
 
 /*
  * Function serializes the data into the buffer provided.
@@ -39,4 +40,17 @@ bool ag_serialize_extended_type(StringInfo buffer, agtentry *agtentry,
 void ag_deserialize_extended_type(char *base_addr, uint32 offset,
                                   agtype_value *result);
 
+/*
+ * Returns the object container of the vertex or edge held by a scalar agtype,
+ * or NULL if the agtype is not a vertex or an edge.
+ */
+agtype_container *ag_get_entity_container(agtype *agt,
+                                          enum agtype_value_type *type);
+
+/*
+ * Returns whether the path held by a scalar agtype contains the vertex or edge
+ * with the given id.
+ */
+bool ag_path_contains_entity(agtype *agt, graphid id);
+
 #endif